@@ -0,0 +1,254 @@
+import argparse
+import csv
+import hashlib
+import json
+import math
+import os
+import platform
+import shutil
+import subprocess
+import sys
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BENCHMARK_DIR = os.path.join(REPO_DIR, "benchmark")
+
+# Exit codes, ctest fails on anything but zero
+EXIT_PASSED = 0
+EXIT_REGRESSION = 1
+EXIT_NO_BASELINE = 2
+
+
+# === Corpus ===
+def prepare_case(case, work_dir, gen_exe):
+    """Creates dataset directory of case, returns its path and digest of its graph files."""
+    case_dir = os.path.join(work_dir, case["name"])
+    shutil.rmtree(case_dir, ignore_errors=True)
+    os.makedirs(case_dir)
+
+    if "dataset" in case:
+        # Pinned files of prepared dataset, copied since process.exe reads only regular files.
+        # Directory without subdirectories is processed as isomorphic dataset.
+        source = os.path.join(REPO_DIR, case["dataset"])
+        for n in case["files"]:
+            shutil.copy(os.path.join(source, f"{n}.g6"), case_dir)
+    else:
+        # Generated family, the same seed gives the same graphs
+        params = case["generate"]
+        command = [gen_exe, "--type", params["type"], "--start", str(params["start"]), "--end", str(params["end"]),
+                   "--step", str(params["step"]), "--set_size", str(params["set_size"]),
+                   "--seed", str(params["seed"]), "--output_dir", case_dir]
+        for key in ("density", "degree"):
+            if key in params:
+                command += [f"--{key}", str(params[key])]
+        if params.get("only_isomorphic", False):
+            command.append("--oi")
+        subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+
+    return case_dir, digest_directory(case_dir)
+
+
+def digest_directory(path):
+    # Baseline is comparable only if graphs are the same, so generator changes are detected too
+    digest = hashlib.sha256()
+    for root, dirs, files in sorted(os.walk(path)):
+        dirs.sort()
+        for name in sorted(files):
+            file_path = os.path.join(root, name)
+            digest.update(os.path.relpath(file_path, path).encode())
+            with open(file_path, "rb") as f:
+                digest.update(f.read())
+    return digest.hexdigest()
+
+
+# === Measurement ===
+def run_case(case, case_dir, process_exe, work_dir):
+    """Runs process.exe on dataset of case, returns measurements of each set keyed by '<nodes>/<iso|noniso>'."""
+    result_file = os.path.join(work_dir, f"{case['name']}.csv")
+    # process.exe appends file names to dataset path as they are
+    command = [process_exe, os.path.join(case_dir, ""), result_file, "--warmup", str(case["warmup"]), "--reps", str(case["reps"])]
+    command += case.get("options", [])
+    subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+
+    sets = {}
+    with open(result_file, newline="") as f:
+        for row in csv.DictReader(f):
+            key = f"{row['node_count']}/{'iso' if row['is_isomorphic'] == 'true' else 'noniso'}"
+            sets[key] = {
+                "median": float(row["median_time"]),
+                "stddev": float(row["stddev_time"]),
+                "repetitions": int(row["repetitions"]),
+                "censored": int(row.get("censored", 0)) > 0,
+            }
+    return sets
+
+
+# === Comparison ===
+def welch_t(base, current):
+    # Difference of medians in units of its standard error, as in Welch's t-test
+    error = math.sqrt(base["stddev"] ** 2 / max(base["repetitions"], 1) +
+                      current["stddev"] ** 2 / max(current["repetitions"], 1))
+    difference = current["median"] - base["median"]
+    if error == 0:
+        return math.copysign(math.inf, difference) if difference != 0 else 0.0
+    return difference / error
+
+
+def compare_set(base, current, tolerance, threshold, noise_floor):
+    """Returns report entry of one set. Slowdown must exceed tolerance and be statistically significant."""
+    entry = {"current": current}
+    if base is None:
+        entry["status"] = "new"
+        return entry
+    entry["baseline"] = base
+    if base["censored"] or current["censored"]:
+        # Censored times are only lower bounds
+        entry["status"] = "censored"
+        return entry
+
+    ratio = current["median"] / base["median"] if base["median"] > 0 else math.inf
+    t = welch_t(base, current)
+    # JSON has no infinity, unbounded values are stored as null
+    entry["ratio"] = ratio if math.isfinite(ratio) else None
+    entry["t"] = t if math.isfinite(t) else None
+
+    # Differences below the timer noise are never significant
+    if abs(current["median"] - base["median"]) < noise_floor:
+        entry["status"] = "ok"
+    elif ratio > 1 + tolerance and t > threshold:
+        entry["status"] = "slower"
+    elif ratio < 1 / (1 + tolerance) and t < -threshold:
+        entry["status"] = "faster"
+    else:
+        entry["status"] = "ok"
+    return entry
+
+
+def compare_case(case, digest, sets, baseline, threshold, noise_floor):
+    report = {"name": case["name"], "digest": digest, "tolerance": case["tolerance"]}
+    base_case = baseline.get("cases", {}).get(case["name"]) if baseline else None
+    if base_case is None:
+        report["status"] = "new"
+        report["sets"] = {key: {"current": value, "status": "new"} for key, value in sets.items()}
+        return report
+    if base_case["digest"] != digest or base_case.get("options", []) != case.get("options", []):
+        # Other graphs or options, measurements are not comparable
+        report["status"] = "corpus_changed"
+        report["sets"] = {key: {"current": value, "status": "new"} for key, value in sets.items()}
+        return report
+
+    report["sets"] = {key: compare_set(base_case["sets"].get(key), value, case["tolerance"], threshold, noise_floor)
+                      for key, value in sets.items()}
+    ratios = [entry["ratio"] for entry in report["sets"].values() if entry.get("ratio") is not None]
+    if ratios:
+        report["geomean_ratio"] = math.exp(sum(math.log(max(r, 1e-12)) for r in ratios) / len(ratios))
+    statuses = [entry["status"] for entry in report["sets"].values()]
+    report["status"] = "slower" if "slower" in statuses else "ok"
+    return report
+
+
+# === Output ===
+def environment():
+    try:
+        commit = subprocess.run(["git", "-C", REPO_DIR, "rev-parse", "HEAD"], capture_output=True, text=True,
+                                check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        commit = None
+    return {"commit": commit, "machine": platform.machine(), "processor": platform.processor(),
+            "node": platform.node(), "cpu_count": os.cpu_count(), "system": platform.platform()}
+
+
+def print_case(report):
+    ratio = report.get("geomean_ratio")
+    print(f"{report['name']:<10} {report['status']:<15} "
+          f"{'' if ratio is None else f'geomean ratio {ratio:.3f}'}")
+    for key, entry in sorted(report["sets"].items(), key=lambda item: (int(item[0].split('/')[0]), item[0])):
+        if entry["status"] in ("slower", "faster"):
+            ratio = "inf" if entry["ratio"] is None else f"{entry['ratio']:.2f}"
+            t = "inf" if entry["t"] is None else f"{entry['t']:.1f}"
+            print(f"    {key:<14} {entry['status']:<7} {entry['baseline']['median']:.3g} s -> "
+                  f"{entry['current']['median']:.3g} s (x{ratio}, t = {t})")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs pinned benchmark corpus and compares it with stored baseline")
+    parser.add_argument("--process", required=True, help="Path to process.exe")
+    parser.add_argument("--gen", required=True, help="Path to gen.exe, used for generated families")
+    parser.add_argument("--corpus", default=os.path.join(BENCHMARK_DIR, "corpus.json"), help="Corpus definition")
+    parser.add_argument("--baseline", default=os.path.join(BENCHMARK_DIR, "baseline.json"), help="Baseline JSON")
+    parser.add_argument("--report", default="benchmark_report.json", help="Output JSON report")
+    parser.add_argument("--work_dir", default="benchmark_work", help="Directory for datasets and results")
+    parser.add_argument("--cases", help="Comma-separated names of cases to run (default: all)")
+    parser.add_argument("--update_baseline", action="store_true", help="Store measurements as new baseline")
+    parser.add_argument("--require_baseline", action="store_true", help="Fail if there is no baseline")
+    args = parser.parse_args()
+
+    with open(args.corpus) as f:
+        corpus = json.load(f)
+    threshold = corpus.get("threshold", 3.0)
+    noise_floor = corpus.get("noise_floor", 0.0)
+    cases = corpus["cases"]
+    if args.cases:
+        names = args.cases.split(",")
+        unknown = set(names) - {case["name"] for case in cases}
+        if unknown:
+            sys.exit(f"Error: Unknown cases: {', '.join(sorted(unknown))}")
+        cases = [case for case in cases if case["name"] in names]
+
+    baseline = None
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    elif not args.update_baseline:
+        print(f"No baseline in {args.baseline}, measurements are only reported "
+              f"(record one on reference machine with --update_baseline)")
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    reports = []
+    measured = {}
+    for case in cases:
+        case_dir, digest = prepare_case(case, args.work_dir, args.gen)
+        sets = run_case(case, case_dir, args.process, args.work_dir)
+        measured[case["name"]] = {"digest": digest, "options": case.get("options", []), "sets": sets}
+        report = compare_case(case, digest, sets, baseline, threshold, noise_floor)
+        print_case(report)
+        reports.append(report)
+
+    counts = {}
+    for report in reports:
+        for entry in report["sets"].values():
+            counts[entry["status"]] = counts.get(entry["status"], 0) + 1
+    regressions = [r["name"] for r in reports if r["status"] == "slower"]
+    changed = [r["name"] for r in reports if r["status"] == "corpus_changed"]
+    passed = not regressions and not changed and (baseline is not None or not args.require_baseline)
+    summary = {"passed": passed, "regressed_cases": regressions, "changed_cases": changed, "sets": counts,
+               "baseline": args.baseline if baseline else None,
+               "baseline_environment": baseline.get("environment") if baseline else None}
+
+    with open(args.report, "w") as f:
+        json.dump({"environment": environment(), "threshold": threshold, "noise_floor": noise_floor,
+                   "summary": summary, "cases": reports}, f, indent=2)
+    print(f"Report written to {args.report}")
+
+    if args.update_baseline:
+        # Cases which were not run keep their previous baseline
+        stored = baseline if baseline else {"cases": {}}
+        stored["environment"] = environment()
+        stored["cases"].update(measured)
+        with open(args.baseline, "w") as f:
+            json.dump(stored, f, indent=2)
+        print(f"Baseline written to {args.baseline}")
+        return EXIT_PASSED
+
+    if changed:
+        print(f"Corpus or options changed since baseline, record new baseline for: {', '.join(changed)}")
+    if regressions:
+        print(f"Performance regression in: {', '.join(regressions)}")
+    if regressions or changed:
+        return EXIT_REGRESSION
+    if baseline is None and args.require_baseline:
+        return EXIT_NO_BASELINE
+    return EXIT_PASSED
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,283 @@
+package boltzmannplanargraphs;
+
+import dataWithEvaluations.ReaderOfEvaluations;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.concurrent.atomic.AtomicLong;
+import maps.ConnectedMap;
+import maps.PlanarMap;
+import maps.SamplerState;
+
+/**
+ * Batch mode of the sampler: draws planar graphs in parallel threads and writes each accepted graph,
+ * together with random relabellings of it, to <output>/<n>.g6 (the layout of prepared_dataset/planar).
+ * Sample i uses its own Random seeded from (seed, i), so a graph depends only on the seed and its sample number.
+ * Draws larger than the size window are abandoned as soon as their blocks exceed it (see SamplerState),
+ * smaller ones and sizes which are already written are rejected before their edges are listed.
+ */
+public class BatchSampler {
+    int count=-1;               // number of files to write
+    int minSize=-1;
+    int maxSize=-1;
+    long seed=System.nanoTime();
+    int threads=Runtime.getRuntime().availableProcessors();
+    String expectedSize="1000"; // expected size of the Boltzmann sampler, 1000, 10000 or 100000
+    String outputDir=null;
+    int setSize=3;              // graph and its relabellings in one file, as in graph6_iso_dup.py
+    boolean sparse6=false;
+
+    boolean[] written;          // sizes of the window which are already in the output directory
+    int nrWritten=0;
+    final AtomicLong nextSample=new AtomicLong(0);
+    final AtomicLong nrTooLarge=new AtomicLong(0);
+    final AtomicLong nrTooSmall=new AtomicLong(0);
+    final AtomicLong nrDuplicate=new AtomicLong(0);
+
+    /** Creates a new instance of BatchSampler */
+    public BatchSampler() {
+    }
+
+    public static void main(String[] args) {
+        BatchSampler sampler=new BatchSampler();
+        sampler.parseArguments(args);
+        sampler.run();
+    }
+
+    static void usage(String error){
+        System.err.println("Error: "+error);
+        System.err.println("Usage: java boltzmannplanargraphs.Main --batch --count N --min N --max N --output DIR");
+        System.err.println("       [--seed N] [--threads N] [--size 1000|10000|100000] [--set_size N] [--sparse6] [--data FILE]");
+        System.exit(1);
+    }
+
+    void parseArguments(String[] args){
+        for (int i=0;i<args.length;++i){
+            String arg=args[i];
+            boolean hasValue=i+1<args.length;
+            try{
+                if (arg.equals("--batch")) continue;
+                else if (arg.equals("--count")&&hasValue) count=Integer.parseInt(args[++i]);
+                else if (arg.equals("--min")&&hasValue) minSize=Integer.parseInt(args[++i]);
+                else if (arg.equals("--max")&&hasValue) maxSize=Integer.parseInt(args[++i]);
+                else if (arg.equals("--seed")&&hasValue) seed=Long.parseLong(args[++i]);
+                else if (arg.equals("--threads")&&hasValue) threads=Integer.parseInt(args[++i]);
+                else if (arg.equals("--size")&&hasValue) expectedSize=args[++i];
+                else if (arg.equals("--output")&&hasValue) outputDir=args[++i];
+                else if (arg.equals("--set_size")&&hasValue) setSize=Integer.parseInt(args[++i]);
+                else if (arg.equals("--sparse6")) sparse6=true;
+                else if (arg.equals("--data")&&hasValue) ReaderOfEvaluations.FILE_PLANAR_GRAPHS=args[++i];
+                else usage("Unknown option: "+arg);
+            } catch (NumberFormatException e){
+                usage("Invalid value of "+arg+": "+args[i]);
+            }
+        }
+
+        if (count<1||minSize<2||maxSize<minSize||outputDir==null) usage("--count, --min, --max and --output are required, 2 <= min <= max");
+        if (threads<1) usage("--threads must be at least 1");
+        if (setSize<1) usage("--set_size must be at least 1");
+    }
+
+    void run(){
+        File dir=new File(outputDir);
+        if (!dir.isDirectory()&&!dir.mkdirs()) usage("Cannot create directory "+outputDir);
+
+        // sizes which are already present are not written again, so an interrupted batch can be continued
+        written=new boolean[maxSize-minSize+1];
+        int free=0;
+        for (int n=minSize;n<=maxSize;++n){
+            written[n-minSize]=new File(dir, n+".g6").exists();
+            if (!written[n-minSize]) free++;
+        }
+        if (free<count) usage("Only "+free+" sizes of the window are not in "+outputDir+" yet, --count is "+count);
+
+        // branching probabilities are read once, they are not modified by the samplers
+        ReaderOfEvaluations.loadAllGeneratingFunctionsValues(expectedSize);
+        System.out.println("Seed: "+seed);
+
+        long start=System.currentTimeMillis();
+        Thread[] workers=new Thread[threads];
+        for (int t=0;t<threads;++t){
+            workers[t]=new Thread(new Runnable(){
+                public void run(){ work(); }
+            });
+            workers[t].start();
+        }
+        for (int t=0;t<threads;++t){
+            try{ workers[t].join(); } catch (InterruptedException e){ Thread.currentThread().interrupt(); }
+        }
+
+        double seconds=(System.currentTimeMillis()-start)/1000.0;
+        System.out.println(nrWritten+" graphs written to "+outputDir+" in "+seconds+" s from "+nextSample.get()+" samples ("
+                +nrTooLarge.get()+" too large, "+nrTooSmall.get()+" too small, "+nrDuplicate.get()+" of written size)");
+    }
+
+    void work(){
+        while (!done()){
+            long sample=nextSample.getAndIncrement();
+            Random r=new Random(mix(seed+sample*0x9E3779B97F4A7C15L));
+
+            ConnectedMap connected;
+            try{
+                PlanarMap.initStaticParameters();
+                SamplerState.get().startDraw(maxSize);
+                connected=ConnectedMap.draw_dddC(r);
+            } catch (SamplerState.SizeExceededException e){
+                nrTooLarge.incrementAndGet();
+                continue;
+            }
+
+            int n=connected.vertexList.size();
+            if (n>maxSize){ nrTooLarge.incrementAndGet(); continue; }
+            if (n<minSize){ nrTooSmall.incrementAndGet(); continue; }
+            if (!claim(n)){ nrDuplicate.incrementAndGet(); continue; }
+
+            try{
+                writeSet(n, connected.listEdges(), r, sample);
+            } catch (IOException e){
+                System.err.println("Error: Cannot write "+n+".g6: "+e.getMessage());
+                System.exit(1);
+            }
+        }
+    }
+
+    synchronized boolean done(){
+        return nrWritten>=count;
+    }
+
+    // the first sample of each size wins, no more sizes are taken once count is reached
+    synchronized boolean claim(int n){
+        if (nrWritten>=count||written[n-minSize]) return false;
+        written[n-minSize]=true;
+        nrWritten++;
+        return true;
+    }
+
+    void writeSet(int n, int[] edges, Random r, long sample) throws IOException{
+        StringBuilder lines=new StringBuilder();
+        int[] permutation=new int[n];
+        for (int i=0;i<n;++i) permutation[i]=i;
+        for (int k=0;k<setSize;++k){
+            // first graph keeps the labelling of the sampler, the others are random relabellings
+            if (k>0){
+                for (int i=n-1;i>0;--i){
+                    int j=r.nextInt(i+1);
+                    int tmp=permutation[i]; permutation[i]=permutation[j]; permutation[j]=tmp;
+                }
+            }
+            lines.append(sparse6 ? toSparse6(n, edges, permutation) : toGraph6(n, edges, permutation)).append('\n');
+        }
+
+        // written under temporary name and renamed, so that the directory never has a partial file
+        File file=new File(outputDir, n+".g6");
+        File tmp=new File(outputDir, n+".g6.tmp");
+        OutputStream out=new FileOutputStream(tmp);
+        try{
+            out.write(lines.toString().getBytes("US-ASCII"));
+        } finally {
+            out.close();
+        }
+        if (!tmp.renameTo(file)) throw new IOException("cannot rename "+tmp);
+        System.out.println("[OK] "+file.getName()+" (sample "+sample+")");
+    }
+
+    // splitmix64 finaliser, seeds of consecutive samples give unrelated streams
+    static long mix(long z){
+        z=(z^(z>>>30))*0xBF58476D1CE4E5B9L;
+        z=(z^(z>>>27))*0x94D049BB133111EBL;
+        return z^(z>>>31);
+    }
+
+    // N(n) of graph6 and sparse6 formats
+    static void appendSize(StringBuilder s, int n){
+        if (n<63) s.append((char)(63+n));
+        else {
+            s.append((char)126);
+            for (int shift=12;shift>=0;shift-=6) s.append((char)(63+((n>>shift)&63)));
+        }
+    }
+
+    static String toGraph6(int n, int[] edges, int[] permutation){
+        // bit of pair i<j is at j*(j-1)/2+i, upper triangle column by column
+        long bits=(long)n*(n-1)/2;
+        byte[] matrix=new byte[(int)((bits+5)/6)];
+        for (int e=0;e<edges.length;e+=2){
+            int u=permutation[edges[e]], v=permutation[edges[e+1]];
+            if (u==v) continue;
+            if (u>v){ int tmp=u; u=v; v=tmp; }
+            long position=(long)v*(v-1)/2+u;
+            matrix[(int)(position/6)]|=(byte)(1<<(5-(int)(position%6)));
+        }
+        StringBuilder s=new StringBuilder(matrix.length+4);
+        appendSize(s, n);
+        for (int i=0;i<matrix.length;++i) s.append((char)(63+matrix[i]));
+        return s.toString();
+    }
+
+    static String toSparse6(int n, int[] edges, int[] permutation){
+        // edges sorted by larger end, then by smaller end, duplicate edges and loops are dropped as graph6 does
+        long[] sorted=new long[edges.length/2];
+        int m=0;
+        for (int e=0;e<edges.length;e+=2){
+            int u=permutation[edges[e]], v=permutation[edges[e+1]];
+            if (u==v) continue;
+            if (u>v){ int tmp=u; u=v; v=tmp; }
+            sorted[m++]=(long)v*n+u;
+        }
+        sorted=Arrays.copyOf(sorted, m);
+        Arrays.sort(sorted);
+
+        int k=0;
+        while ((1L<<k)<n) k++;      // bits of n-1
+        Sparse6Writer out=new Sparse6Writer(k);
+        out.s.append(':');
+        appendSize(out.s, n);
+        int current=0;
+        for (int e=0;e<m;++e){
+            if (e>0&&sorted[e]==sorted[e-1]) continue;
+            int v=(int)(sorted[e]/n), u=(int)(sorted[e]%n);
+            if (v==current) out.put(0, u);
+            else if (v==current+1){ out.put(1, u); current=v; }
+            else { out.put(1, v); out.put(0, u); current=v; }
+        }
+        out.finish(n, current);
+        return out.s.toString();
+    }
+
+    /** Packs the bits of sparse6 into printable characters */
+    static class Sparse6Writer {
+        final StringBuilder s=new StringBuilder();
+        final int k;
+        int value=0;
+        int nrBits=0;
+
+        Sparse6Writer(int k){
+            this.k=k;
+        }
+
+        void bit(int b){
+            value=(value<<1)|b;
+            if (++nrBits==6){ s.append((char)(63+value)); value=0; nrBits=0; }
+        }
+
+        void put(int b, int x){
+            bit(b);
+            for (int i=k-1;i>=0;--i) bit((x>>i)&1);
+        }
+
+        // padding with 1s, except the case where it would be read as edge to vertex n-1
+        void finish(int n, int current){
+            if (nrBits==0) return;
+            int padding=6-nrBits;
+            if (k<6&&n==(1<<k)&&current==n-2&&padding>=k+1){
+                bit(0);
+                padding--;
+            }
+            for (int i=0;i<padding;++i) bit(1);
+        }
+    }
+
+}
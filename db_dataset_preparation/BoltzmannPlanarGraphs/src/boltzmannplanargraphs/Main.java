@@ -25,6 +25,12 @@ public class Main {
      */
     public static void main(String[] args) {
         
+        // with arguments, many graphs are drawn in parallel and written as graph6 files, see BatchSampler
+        if (args.length>0){
+            BatchSampler.main(args);
+            return;
+        }
+        
         // TODO code application logic here
         //testIO();
         //testRandomBinaryTree();
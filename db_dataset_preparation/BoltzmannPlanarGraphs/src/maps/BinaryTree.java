@@ -21,9 +21,6 @@ public class BinaryTree {
     public BinaryTree leftSon=null;
     public BinaryTree rightSon=null;
     boolean leftSonExplored=false; // useful for the construction from a Dyck word
-    public static boolean rootNodeOfLastGeneratedTreeBlack=true;
-    
-    public static int countnodes=0; public static int countblacknodes=0; public static int countwhitenodes=0;
     
     /**
      * Creates a new instance of BinaryTree 
@@ -47,9 +44,9 @@ public class BinaryTree {
     }
     
     public static void init_static_parameters(){
-        countnodes=0;
-        countblacknodes=0;
-        countwhitenodes=0;
+        SamplerState.get().countnodes=0;
+        SamplerState.get().countblacknodes=0;
+        SamplerState.get().countwhitenodes=0;
     }
 
     public static void toScreen(BinaryTree binaryTree){
@@ -58,10 +55,10 @@ public class BinaryTree {
     }
     
     public static void printParameters(BinaryTree binaryTree){
-        System.out.println("nr_nodes: "+binaryTree.countnodes);
-        System.out.println("nr_black_nodes: "+binaryTree.countblacknodes);
-        System.out.println("nr_white_nodes: "+binaryTree.countwhitenodes);
-        float ratio=(float)binaryTree.countblacknodes/(float)binaryTree.countnodes;
+        System.out.println("nr_nodes: "+SamplerState.get().countnodes);
+        System.out.println("nr_black_nodes: "+SamplerState.get().countblacknodes);
+        System.out.println("nr_white_nodes: "+SamplerState.get().countwhitenodes);
+        float ratio=(float)SamplerState.get().countblacknodes/(float)SamplerState.get().countnodes;
         System.out.println("ratio_blackNodes_nodes: "+ratio);
     }
     
@@ -71,10 +68,10 @@ public class BinaryTree {
         int c=ch_dxu_or_dxv.choose(r);
         if (c==0){
             //System.out.println("black"); 
-            BinaryTree tree=draw_dxu(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=true; return tree; }
+            BinaryTree tree=draw_dxu(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=true; return tree; }
         else{
             //System.out.println("white"); 
-            BinaryTree tree=draw_dxv(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=false; return tree;}
+            BinaryTree tree=draw_dxv(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=false; return tree;}
     }
     
     public static BinaryTree draw_dxu(Random r){
@@ -86,7 +83,7 @@ public class BinaryTree {
         else
         {
             //we add the black root
-            countnodes++;countblacknodes++;
+            SamplerState.get().countnodes++;SamplerState.get().countblacknodes++;
             BinaryTree leftSon=new BinaryTree();
             BinaryTree rightSon=new BinaryTree();
       
@@ -110,7 +107,7 @@ public class BinaryTree {
 
         
         //we add the black root
-        countnodes++;countwhitenodes++;
+        SamplerState.get().countnodes++;SamplerState.get().countwhitenodes++;
         BinaryTree leftSon=new BinaryTree();
         BinaryTree rightSon=new BinaryTree();
       
@@ -133,10 +130,10 @@ public class BinaryTree {
         int c=ch_dyu_or_dyv.choose(r);
         if (c==0){
             // System.out.println("black"); 
-            BinaryTree tree=draw_dyu(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=true; return tree; }
+            BinaryTree tree=draw_dyu(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=true; return tree; }
         else{
             // System.out.println("white"); 
-            BinaryTree tree=draw_dyv(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=false; return tree;}
+            BinaryTree tree=draw_dyv(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=false; return tree;}
     }
     
     public static BinaryTree draw_dyv(Random r){
@@ -148,7 +145,7 @@ public class BinaryTree {
         else
         {
             //we add the black root
-            countnodes++;countwhitenodes++;
+            SamplerState.get().countnodes++;SamplerState.get().countwhitenodes++;
             BinaryTree leftSon=new BinaryTree();
             BinaryTree rightSon=new BinaryTree();
       
@@ -175,7 +172,7 @@ public class BinaryTree {
         else
         {
             //we add the black root
-            countnodes++;countblacknodes++;
+            SamplerState.get().countnodes++;SamplerState.get().countblacknodes++;
             BinaryTree leftSon=new BinaryTree();
             BinaryTree rightSon=new BinaryTree();
       
@@ -200,17 +197,17 @@ public class BinaryTree {
         int c=ch_u_or_v.choose(r);
         if (c==0){
             // System.out.println("black"); 
-            BinaryTree tree=draw_u(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=true; return tree; }
+            BinaryTree tree=draw_u(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=true; return tree; }
         else{
             // System.out.println("white"); 
-            BinaryTree tree=draw_v(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=false; return tree;}
+            BinaryTree tree=draw_v(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=false; return tree;}
     }
     
     public static BinaryTree draw_u(Random r){
         r.nextDouble();
         
         //we add the black root
-        countnodes++;countblacknodes++;
+        SamplerState.get().countnodes++;SamplerState.get().countblacknodes++;
         BinaryTree leftSon=new BinaryTree();
         BinaryTree rightSon=new BinaryTree();
       
@@ -223,7 +220,7 @@ public class BinaryTree {
         r.nextDouble();
         
         //we add the black root
-        countnodes++;countwhitenodes++;
+        SamplerState.get().countnodes++;SamplerState.get().countwhitenodes++;
         BinaryTree leftSon=new BinaryTree();
         BinaryTree rightSon=new BinaryTree();
       
@@ -254,20 +251,20 @@ public class BinaryTree {
         BinaryTree tree=new BinaryTree();
         if (c==0){
             // System.out.println("black"); 
-            tree=draw_u(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=true;  }
+            tree=draw_u(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=true;  }
         else{
             // System.out.println("white"); 
-            tree=draw_v(r); BinaryTree.rootNodeOfLastGeneratedTreeBlack=false; }
-        if(countnodes>maxSize) return null;
+            tree=draw_v(r); SamplerState.get().rootNodeOfLastGeneratedTreeBlack=false; }
+        if(SamplerState.get().countnodes>maxSize) return null;
         else return tree;
     }
     
     public static BinaryTree draw_u(int maxSize, Random r){
-        if(countnodes>maxSize) return null;
+        if(SamplerState.get().countnodes>maxSize) return null;
         r.nextDouble();
         
         //we add the black root
-        countnodes++;countblacknodes++;
+        SamplerState.get().countnodes++;SamplerState.get().countblacknodes++;
         BinaryTree leftSon=new BinaryTree();
         BinaryTree rightSon=new BinaryTree();
       
@@ -277,11 +274,11 @@ public class BinaryTree {
     }
     
     public static BinaryTree draw_v(int maxSize, Random r){
-        if(countnodes>maxSize) return null;
+        if(SamplerState.get().countnodes>maxSize) return null;
         r.nextDouble();
         
         //we add the black root
-        countnodes++;countwhitenodes++;
+        SamplerState.get().countnodes++;SamplerState.get().countwhitenodes++;
         BinaryTree leftSon=new BinaryTree();
         BinaryTree rightSon=new BinaryTree();
       
@@ -291,14 +288,14 @@ public class BinaryTree {
     }
     
     public static BinaryTree draw_1_or_u(int maxSize, Random r){
-        if(countnodes>maxSize) return null;
+        if(SamplerState.get().countnodes>maxSize) return null;
         r.nextDouble();
         if (ch_1_or_u.choose(r)==0) return null;
         else return draw_u(r);
     }
     
     public static BinaryTree draw_1_or_v(int maxSize, Random r){
-        if(countnodes>maxSize) return null;
+        if(SamplerState.get().countnodes>maxSize) return null;
         r.nextDouble();
         if (ch_1_or_v.choose(r)==0) return null;
         else return draw_v(r);
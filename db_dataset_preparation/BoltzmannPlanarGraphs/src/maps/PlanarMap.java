@@ -2,6 +2,7 @@ package maps;
 
 import java.io.FileWriter;
 import java.io.IOException;
+import java.util.Arrays;
 import randomChoose.ChooseVector;
 
 /**
@@ -9,9 +10,6 @@ import randomChoose.ChooseVector;
  * @author fusy
  */
 public class PlanarMap {
-    public static int NR_BLOCKS=0;
-    public static int NR_BRICKS=0;
-    
     public static ChooseVector poisson_C=new ChooseVector(17);
     public static ChooseVector choose_vector_ddG=new ChooseVector(2);
     public static ChooseVector choose_vector_dddG=new ChooseVector(3);
@@ -36,13 +34,13 @@ public class PlanarMap {
     }
     
     public static void initStaticParameters(){
-        NR_BLOCKS=0;
-        NR_BRICKS=0;
+        SamplerState.get().nr_blocks=0;
+        SamplerState.get().nr_bricks=0;
     }
     
     public static void printStatisticParameters(){
-        System.out.println("nr blocks: "+NR_BLOCKS);
-        System.out.println("nr bricks: "+NR_BRICKS);
+        System.out.println("nr blocks: "+SamplerState.get().nr_blocks);
+        System.out.println("nr bricks: "+SamplerState.get().nr_bricks);
     }
     
     public int[] degreeVertices(){
@@ -140,6 +138,29 @@ public class PlanarMap {
         graphForPigale.write("0 0\n");
         graphForPigale.close();
     }
+
+    // returns the edges as pairs of vertices numbered from 0, visited in the same order as in printForPigale
+    public int[] listEdges(){
+        int[] edges=new int[2*this.nr_edges+2];
+        int count=0;
+        int current_index=0;
+        for (int i=0;i<vertexList.size();++i){
+            DemiArete demiArete=vertexList.getDemiArete(i);
+            do {
+                demiArete.indexOfVertex=i;
+                if(demiArete.opp.index==-1) demiArete.index=++current_index;
+                else {
+                    demiArete.index=-demiArete.opp.index;
+                    if(count+2>edges.length) edges=Arrays.copyOf(edges,2*edges.length);
+                    edges[count++]=demiArete.indexOfVertex;
+                    edges[count++]=demiArete.opp.indexOfVertex;
+                }
+                demiArete=demiArete.next;
+            }
+            while(demiArete!=vertexList.getDemiArete(i));
+        }
+        return Arrays.copyOf(edges,count);
+    }
     
     
     
@@ -0,0 +1,54 @@
+package maps;
+
+/**
+ * Counters updated by the random generators while one object is drawn. They used to be static
+ * attributes of BinaryTree, PlanarMap and Dart; each thread has its own copy, so that the batch
+ * mode can draw several planar graphs in parallel.
+ */
+public class SamplerState {
+    public boolean rootNodeOfLastGeneratedTreeBlack=true;
+    public int countnodes=0; public int countblacknodes=0; public int countwhitenodes=0;
+    public int nr_blocks=0;
+    public int nr_bricks=0;
+    public int currentIndex=1;
+
+    // vertices of the accepted 2-connected blocks, the graph being drawn has at least this many vertices
+    public int nr_vertices=0;
+    public int maxVertices=Integer.MAX_VALUE;
+
+    private static final ThreadLocal<SamplerState> current=new ThreadLocal<SamplerState>(){
+        protected SamplerState initialValue(){
+            return new SamplerState();
+        }
+    };
+
+    /** Creates a new instance of SamplerState */
+    public SamplerState() {
+    }
+
+    public static SamplerState get(){
+        return current.get();
+    }
+
+    // starts a new draw, which is abandoned as soon as it has more than maxVertices vertices
+    public void startDraw(int maxVertices){
+        this.nr_blocks=0;
+        this.nr_bricks=0;
+        this.nr_vertices=0;
+        this.maxVertices=maxVertices;
+    }
+
+    // a block is glued to the rest of the graph by one of its vertices, the others are new
+    public void addBlock(int blockVertices){
+        this.nr_vertices+=blockVertices-1;
+        if(this.nr_vertices>this.maxVertices) throw new SizeExceededException();
+    }
+
+    /** Thrown when the graph being drawn is already larger than the wanted size */
+    public static class SizeExceededException extends RuntimeException {
+        public SizeExceededException() {
+            super(null, null, false, false); // no stack trace, this is the common way a draw ends
+        }
+    }
+
+}
@@ -131,7 +131,7 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_K(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         while(true){
             double u=r.nextDouble();
             int maxSize=(int)(4/u); 
@@ -145,11 +145,11 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_dxK(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         while(true){
             double u=r.nextDouble(); 
             BinaryTree binaryTree=BinaryTree.draw_b(r);
-            int i=BinaryTree.countblacknodes;int j=BinaryTree.countwhitenodes;
+            int i=SamplerState.get().countblacknodes;int j=SamplerState.get().countwhitenodes;
             double reject=(double)(3.0*(i+1)/(2.0*(i+j+2))); //System.out.println("taux de rejet= "+reject);
             if(u<=reject){
                 Dart dart=Dart.closure(binaryTree);
@@ -159,7 +159,7 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_dyK(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         int c=ch_K_in_dyK.choose(r);
         if (c==0) return draw_K(r);
         else {
@@ -172,7 +172,7 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_dxyK(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         int c=ch_dxK_in_dxyK.choose(r);
         if (c==0) return draw_dxK(r);
         else {
@@ -188,11 +188,11 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_dxxK(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         while(true){
             double u=r.nextDouble(); 
             BinaryTree binaryTree=BinaryTree.draw_dxb(r);
-            int i=BinaryTree.countblacknodes;int j=BinaryTree.countwhitenodes;
+            int i=SamplerState.get().countblacknodes;int j=SamplerState.get().countwhitenodes;
             double reject=(double)(3.0*(i+1)/(2.0*(i+j+2))); //System.out.println("taux de rejet= "+reject);
             if(u<=reject){
                 Dart dart=Dart.closure(binaryTree);
@@ -202,7 +202,7 @@ public class ThreeConnectedNetwork extends Network{
     }
     
     public static ThreeConnectedNetwork draw_dyyK(Random r){
-        PlanarMap.NR_BRICKS++;
+        SamplerState.get().nr_bricks++;
         BinaryTree binaryTree=new BinaryTree();
         while(true){
             int c=ch_3b_or_dyb.choose(r);
@@ -57,20 +57,26 @@ public class TwoConnectedMap extends ConnectedMap{
         }
     }
     
+    // the block is accepted, the draw stops here if the graph already has too many vertices
+    public static TwoConnectedMap countBlock(TwoConnectedMap block){
+        SamplerState.get().addBlock(block.vertexList.size());
+        return block;
+    }
+    
     public static TwoConnectedMap draw_dB(Random r){
         
         int c=ch_xy_in_dB.choose(r);
-        if (c==0) return edgeMap();
+        if (c==0) return countBlock(edgeMap());
         
         else{
-            PlanarMap.NR_BLOCKS++;
+            SamplerState.get().nr_blocks++;
             while(true){
                 Network network=Network.draw_non_trivial_D(r);
                 network.toTwoConnectedMap();
                 int i=network.vertexList.size();
                 int j=network.nr_edges;
                 double rejet=(double)(i)/(double)(j);//System.out.println(i+" "+j+" "+"reject 2connected: "+rejet);
-                if(r.nextDouble()<=rejet) return network; //else System.out.println("2-connected is rejected");
+                if(r.nextDouble()<=rejet) return countBlock(network); //else System.out.println("2-connected is rejected");
             }
         }
     }
@@ -78,9 +84,9 @@ public class TwoConnectedMap extends ConnectedMap{
     public static TwoConnectedMap draw_ddB(Random r){
         
         int c=ch_y_in_ddB.choose(r);
-        if (c==0) return edgeMap();
+        if (c==0) return countBlock(edgeMap());
         else{
-            PlanarMap.NR_BLOCKS++;
+            SamplerState.get().nr_blocks++;
             Network network=new Network();
             while(true){
                 int d=ch_nontrivialD_or_dD.choose(r);
@@ -90,13 +96,13 @@ public class TwoConnectedMap extends ConnectedMap{
                 int i=network.vertexList.size();
                 int j=network.nr_edges;
                 double rejet=(double)(i)/(double)(j); //System.out.println(i+" "+j+" "+"reject 2connected: "+rejet);
-                if(r.nextDouble()<=rejet) return network;//else System.out.println("2-connected is rejected");
+                if(r.nextDouble()<=rejet) return countBlock(network);//else System.out.println("2-connected is rejected");
             }
         }
     }
     
     public static TwoConnectedMap draw_dddB(Random r){
-        PlanarMap.NR_BLOCKS++;
+        SamplerState.get().nr_blocks++;
         Network network=new Network();
         while(true){
             int d=ch_dD_or_ddD.choose(r);
@@ -106,7 +112,7 @@ public class TwoConnectedMap extends ConnectedMap{
             int i=network.vertexList.size();
             int j=network.nr_edges;
             double rejet=(double)(i)/(double)(j); //System.out.println(i+" "+j+" "+"reject 2connected: "+rejet);
-            if(r.nextDouble()<=rejet) return network;//else System.out.println("2-connected is rejected");
+            if(r.nextDouble()<=rejet) return countBlock(network);//else System.out.println("2-connected is rejected");
         }
         
     }
@@ -4,6 +4,7 @@ import java.util.Stack;
 import java.util.Random;
 import maps.BinaryTree;
 import maps.DemiArete;
+import maps.SamplerState;
 
 // An instance of this class corresponds to an half-edge of a 
 // planar map. The planar map can be a 3-connected map as well as an irreducible dissection
@@ -34,7 +35,7 @@ public class Dart {
        
 	
 	public int index=0;
-	public static int currentIndex=1;        // this attribute is only useful in the method makeindexes attributing a different index to 
+	// SamplerState.currentIndex is only useful in the method makeindexes attributing a different index to 
                                                  // each dart of a planar map. Then using these indexes, the map can be printed in the form 
                                                  // of its two permutations, see the class mapPermutations
 	
@@ -401,7 +402,7 @@ public class Dart {
 	// returns the two permutations of half-edges (one for cycles of vertices, the other for opposite
 	// half-edges
 	public static mapPermutations calculateMapPermutations(Dart startDart){
-            currentIndex=1;
+            SamplerState.get().currentIndex=1;
             StringBuffer alphaCycles=new StringBuffer("");
             StringBuffer sigmaCycles=new StringBuffer("");
             makeIndexes(startDart,alphaCycles, sigmaCycles);
@@ -415,10 +416,10 @@ public class Dart {
             while(dart!=startDart||(!startDartTreated)){
                 if(dart==startDart) {
                     startDartTreated=true;
-                    dart.index=currentIndex++;
+                    dart.index=SamplerState.get().currentIndex++;
                     sigmaCycles.append("("+String.valueOf(dart.index));
                 } else{
-                    dart.index=currentIndex++;
+                    dart.index=SamplerState.get().currentIndex++;
                     sigmaCycles.append(" "+String.valueOf(dart.index));
                 }
                 dart=dart.next;
@@ -443,7 +444,7 @@ public class Dart {
         // otherwise returns null
         public static Dart closure(BinaryTree tree){
             Dart dart=Dart.constrMap(tree);
-            dart=Dart.bicoloredCompleteClosure(dart, BinaryTree.rootNodeOfLastGeneratedTreeBlack);
+            dart=Dart.bicoloredCompleteClosure(dart, SamplerState.get().rootNodeOfLastGeneratedTreeBlack);
             if (Dart.reject(dart)) return null;
             dart=Dart.toQuadrangulation(dart);
             dart=Dart.calculateMapFromQuadrangulation(dart);
@@ -1,11 +1,19 @@
 #!/usr/bin/env bash
 
-for i in {1..500}; do
-  # Use Boltzmann planar graph generator
-  cd BoltzmannPlanarGraphs/build/classes
-  echo 1000 | java boltzmannplanargraphs.Main
+# Draws planar graphs by Boltzmann sampler in parallel threads and writes each of them with 2 relabellings
+# (as graph6_iso_dup.py does) directly to prepared_dataset/planar/<n>.g6. Sizes which already have a file are skipped.
+# Usage: ./planar_generator.sh [COUNT] [MIN_SIZE] [MAX_SIZE] [SEED] [THREADS]
+COUNT=${1:-250}
+MIN_SIZE=${2:-3}
+MAX_SIZE=${3:-2000}
+SEED=${4:-1}
+THREADS=${5:-$(nproc)}
 
-  # Convert Boltzmann graph from edges to graph6 format
-  cd ../../..
-  sage -python edges_to_graph6.py BoltzmannPlanarGraphs/ListEdges.txt graph6_single/planar/
-done
+# Compile sources, classes in build/classes may be older than them
+cd BoltzmannPlanarGraphs
+javac -d build/classes $(find src -name "*.java") || exit 1
+
+# Use Boltzmann planar graph generator in batch mode
+cd build/classes
+java boltzmannplanargraphs.Main --batch --count "$COUNT" --min "$MIN_SIZE" --max "$MAX_SIZE" --seed "$SEED" \
+  --threads "$THREADS" --size 1000 --set_size 3 --output ../../../../prepared_dataset/planar
@@ -53,10 +53,50 @@ def visualize(data_file, output_dir):
     plt.savefig(output_file_scaled_xy, dpi=300, bbox_inches='tight')
     print(f"Scaled-xy plot saved as '{output_file_scaled_xy}'")
 
+def visualize_search(instrumentation_file, output_dir):
+    os.makedirs(output_dir, exist_ok=True)
+    output_file = os.path.join(output_dir, "search_tree.png")
+
+    # Instrumentation is written either as CSV or as JSON lines
+    if instrumentation_file.endswith('.jsonl'):
+        df = pd.read_json(instrumentation_file, lines=True)
+    else:
+        df = pd.read_csv(instrumentation_file, delimiter=',')
+    df = df.sort_values(by='node_count')
+    iso_data = df[df['is_isomorphic'] == True]
+    non_iso_data = df[df['is_isomorphic'] == False]
+
+    # Search tree size on the left axis, time on the right one
+    fig, ax_nodes = plt.subplots(figsize=(13, 12))
+    ax_time = ax_nodes.twinx()
+    ax_nodes.scatter(iso_data['node_count'], iso_data['mean_nodes'], color='blue', marker='o', label='Search nodes (isomorphic)')
+    ax_time.plot(iso_data['node_count'], iso_data['average_time'], color='blue', linestyle='--', label='Time (isomorphic)')
+    if not non_iso_data.empty:
+        ax_nodes.scatter(non_iso_data['node_count'], non_iso_data['mean_nodes'], color='red', marker='x', label='Search nodes (non-isomorphic)')
+        ax_time.plot(non_iso_data['node_count'], non_iso_data['average_time'], color='red', linestyle='--', label='Time (non-isomorphic)')
+
+    ax_nodes.set_xlabel('Node Count', fontsize=20)
+    ax_nodes.set_ylabel('Mean Search Tree Nodes', fontsize=20)
+    ax_time.set_ylabel('Average Time (seconds)', fontsize=20)
+    ax_nodes.set_yscale('log')
+    ax_time.set_yscale('log')
+    ax_nodes.tick_params(axis='both', which='both', labelsize=20)
+    ax_time.tick_params(axis='y', which='both', labelsize=20)
+    handles_nodes, labels_nodes = ax_nodes.get_legend_handles_labels()
+    handles_time, labels_time = ax_time.get_legend_handles_labels()
+    ax_nodes.legend(handles_nodes + handles_time, labels_nodes + labels_time, fontsize=20)
+    ax_nodes.grid(True)
+
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"Search tree plot saved as '{output_file}'")
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Visualize isomorphism algorithm performance.")
     parser.add_argument("--data_file", type=str, required=True, help="File with data to visualize.")
     parser.add_argument("--output_dir", type=str, required=True, help="Relative path of output directory.")
+    parser.add_argument("--instrumentation_file", type=str, default=None, help="Instrumentation file written by process.exe --instrument.")
 
     args = parser.parse_args()
-    visualize(args.data_file, args.output_dir)
\ No newline at end of file
+    visualize(args.data_file, args.output_dir)
+    if args.instrumentation_file:
+        visualize_search(args.instrumentation_file, args.output_dir)
\ No newline at end of file
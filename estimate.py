@@ -3,7 +3,7 @@ import numpy as np
 import argparse
 import os
 import matplotlib.pyplot as plt
-from scipy.optimize import curve_fit
+from scipy.optimize import curve_fit, least_squares
 from sklearn.metrics import r2_score
 
 def compute_metrics(y_true, y_pred):
@@ -30,33 +30,82 @@ def polynomial2(x, a):
 def polynomial(x, a, b):
     return a * x ** b
 
-def estimate(data_file, output_dir):
+def select_engine(data, engine):
+    # Older processed files have no engine column
+    if 'engine' not in data.columns:
+        return data
+
+    # Fit only points measured by one engine, otherwise the curves are not comparable
+    if engine is None:
+        engine = data['engine'].value_counts().idxmax()
+        if data['engine'].nunique() > 1:
+            print(f"Data contains several engines, fitting only '{engine}' (use --engine to choose)")
+    return data[data['engine'] == engine]
+
+def fit(func, x, y, censored, sigma=None, p0=None, bounds=(-np.inf, np.inf)):
+    # Without censored points this is an ordinary least squares fit
+    if not np.any(censored):
+        return curve_fit(func, x, y, p0=p0, sigma=sigma, bounds=bounds)[0]
+
+    # Censored points are lower bounds, they only penalise predictions below them
+    if p0 is None:
+        p0 = np.ones(func.__code__.co_argcount - 1)
+        lower = np.broadcast_to(bounds[0], p0.shape)
+        p0 = np.where(p0 < lower, lower + 1, p0)
+    scale = sigma if sigma is not None else np.ones_like(y)
+
+    def residuals(params):
+        r = (func(x, *params) - y) / scale
+        return np.where(censored, np.minimum(r, 0.0), r)
+
+    return least_squares(residuals, p0, bounds=bounds).x
+
+def estimate(data_file, output_dir, engine=None):
     os.makedirs(output_dir, exist_ok=True)
     output_picture = os.path.join(output_dir, "estimation.png")
     output_metrics = os.path.join(output_dir, "metrics.csv")
     data = pd.read_csv(data_file, delimiter=',').sort_values(by='node_count')
+    data = select_engine(data, engine)
     x = np.array(data['node_count'])
-    y = np.array(data['average_time'])
+
+    # Sets where some check exceeded the budget give only a lower bound of time
+    if 'censored' in data.columns:
+        censored = np.array(data['censored'] > 0)
+    else:
+        censored = np.zeros(len(x), dtype=bool)
+    if np.any(censored):
+        print(f"{np.sum(censored)} censored points are used as lower bounds")
+
+    # Benchmark files have robust statistics, fit medians weighted by their spread
+    if 'median_time' in data.columns:
+        y = np.array(data['median_time'])
+        sigma = np.array(data['stddev_time'])
+        if not np.all(sigma > 0):
+            sigma = None
+    else:
+        y = np.array(data['average_time'])
+        sigma = None
 
     log_x = np.log(x)
     log_y = np.log(y)
+    log_sigma = sigma / y if sigma is not None else None
 
     # Fit the data
-    popt_exp = curve_fit(exponential, x, y,
-                         p0=(1, 1, 1))
-    popt_quasi = curve_fit(quasi_polynomial,
-                           log_x, log_y,
-                           bounds=([-np.inf, 0, 1.5], [np.inf, np.inf, np.inf]))
-    popt_poly = curve_fit(polynomial, x, y)
-    popt_poly2 = curve_fit(polynomial2, x, y)
-    popt_poly3 = curve_fit(polynomial3, x, y)
+    popt_exp = fit(exponential, x, y, censored,
+                   p0=(1, 1, 1), sigma=sigma)
+    popt_quasi = fit(quasi_polynomial,
+                     log_x, log_y, censored,
+                     bounds=([-np.inf, 0, 1.5], [np.inf, np.inf, np.inf]), sigma=log_sigma)
+    popt_poly = fit(polynomial, x, y, censored, sigma=sigma)
+    popt_poly2 = fit(polynomial2, x, y, censored, sigma=sigma)
+    popt_poly3 = fit(polynomial3, x, y, censored, sigma=sigma)
 
     # Generate predictions
-    y_exp = exponential(x, *(popt_exp[0]))
-    y_quasi = np.exp(quasi_polynomial(log_x, *(popt_quasi[0])))
-    y_poly = polynomial(x, *(popt_poly[0]))
-    y_poly2 = polynomial2(x, *(popt_poly2[0]))
-    y_poly3 = polynomial3(x, *(popt_poly3[0]))
+    y_exp = exponential(x, *popt_exp)
+    y_quasi = np.exp(quasi_polynomial(log_x, *popt_quasi))
+    y_poly = polynomial(x, *popt_poly)
+    y_poly2 = polynomial2(x, *popt_poly2)
+    y_poly3 = polynomial3(x, *popt_poly3)
 
     # Count and save metrics as CSV
     metrics = []
@@ -65,8 +114,9 @@ def estimate(data_file, output_dir):
             [y_exp, y_quasi, y_poly, y_poly2, y_poly3],
             [popt_exp, popt_quasi, popt_poly, popt_poly2, popt_poly3]
     ):
-        rss, r2 = compute_metrics(y, y_pred)
-        params = list(popt[0]) + [None] * (3 - len(popt[0]))
+        # Censored points have no exact value, so metrics are computed over the others
+        rss, r2 = compute_metrics(y[~censored], y_pred[~censored])
+        params = list(popt) + [None] * (3 - len(popt))
         metrics.append([func_name, rss, r2, *params])
 
     metrics_df = pd.DataFrame(metrics, columns=["functionName", "RSS", "r2", "parameter1", "parameter2", "parameter3"])
@@ -75,7 +125,13 @@ def estimate(data_file, output_dir):
 
     # Plot the data and fits
     plt.figure(figsize=(16, 12))
-    plt.scatter(x, y, label="Data", color="black", marker=".")
+    exact = ~censored
+    if sigma is not None:
+        plt.errorbar(x[exact], y[exact], yerr=sigma[exact], label="Data", color="black", fmt=".", capsize=2)
+    else:
+        plt.scatter(x[exact], y[exact], label="Data", color="black", marker=".")
+    if np.any(censored):
+        plt.scatter(x[censored], y[censored], label="Censored (lower bound)", color="black", marker="^")
     plt.plot(x, y_exp, label="Exponential fit", color="blue")
     plt.plot(x, y_quasi, label="Quasi-Polynomial fit", color="red")
     plt.plot(x, y_poly, label="Polynomial fit", color="green")
@@ -91,6 +147,7 @@ if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Estimate best fitting function and visualize results.")
     parser.add_argument("--data_file", type=str, required=True, help="Relative path to CSV file with data for estimation.")
     parser.add_argument("--output_dir", type=str, required=True, help="Relative path of output directory for picture and CSV metric result.")
+    parser.add_argument("--engine", type=str, default=None, help="Fit only data measured by this engine. Default is the most frequent one.")
 
     args = parser.parse_args()
-    estimate(args.data_file, args.output_dir)
\ No newline at end of file
+    estimate(args.data_file, args.output_dir, args.engine)
\ No newline at end of file
@@ -1,6 +1,7 @@
 from sage.all import Graph, graphs, load, Integer
 import random
 import os
+import sys
 import argparse
 
 NON_ISO_MAX_ATTEMPTS = 30
@@ -212,9 +213,14 @@ def generate_graph(graph_type, n, density, degree):
 
 # === Graph set generation ===
 
-def generate_graphs(is_isomorphic, start, end, step, set_size, output_dir, graph_type, density, degree):
-    output_dir = os.path.join(output_dir, "isomorphic" if is_isomorphic else "non_isomorphic")
-    os.makedirs(output_dir, exist_ok=True)
+def generate_graphs(is_isomorphic, start, end, step, set_size, output_dir, graph_type, density, degree, stream=None):
+    kind = "isomorphic" if is_isomorphic else "non_isomorphic"
+    if stream is None:
+        output_dir = os.path.join(output_dir, kind)
+        os.makedirs(output_dir, exist_ok=True)
+
+    # Progress goes to stderr when graphs are streamed to stdout
+    log = sys.stderr if stream is sys.stdout else sys.stdout
 
     for n in range(start, end + 1, step):
         # If exception is thrown during generation, skip current n generation
@@ -225,16 +231,27 @@ def generate_graphs(is_isomorphic, start, end, step, set_size, output_dir, graph
             else:
                 graph_set = generate_non_isomorphic_set(n, set_size, graph_type, density, degree)
 
-            # Save graph set to file in subdirectory
-            file_path = os.path.join(output_dir, f"{n}.g6")
-            with open(file_path, "w") as file:
+            if stream is not None:
+                # Send whole set tagged with its size and kind, processing starts on #end
+                stream.write(f"#set {n} {kind}\n")
                 for g in graph_set:
-                    file.write(g.graph6_string() + "\n")
+                    stream.write(g.graph6_string() + "\n")
+                stream.write("#end\n")
+                stream.flush()
+            else:
+                # Save graph set to file in subdirectory
+                file_path = os.path.join(output_dir, f"{n}.g6")
+                with open(file_path, "w") as file:
+                    for g in graph_set:
+                        file.write(g.graph6_string() + "\n")
 
         except Exception as e:
-            print(f"Exception during {"isomorphic" if is_isomorphic else "non-isomorphic"} graph generation: {e}")
+            print(f"Exception during {"isomorphic" if is_isomorphic else "non-isomorphic"} graph generation: {e}", file=log)
 
-    print(f"{"Isomorphic" if is_isomorphic else "Non-isomorphic"} dataset generated and saved in '{output_dir}'.")
+    if stream is not None:
+        print(f"{"Isomorphic" if is_isomorphic else "Non-isomorphic"} dataset generated and streamed.", file=log)
+    else:
+        print(f"{"Isomorphic" if is_isomorphic else "Non-isomorphic"} dataset generated and saved in '{output_dir}'.")
 
 def generate_isomorphic_set(n, set_size, graph_type, density, degree):
     # Generate first graph, then just shuffle its labeling
@@ -289,11 +306,22 @@ if __name__ == "__main__":
     parser.add_argument("--end", type=int, required=True, help="Ending number of nodes in the graphs.")
     parser.add_argument("--step", type=int, required=True, help="Step size for the number of nodes.")
     parser.add_argument("--set_size", type=int, required=True, help="Number of graphs to generate for each size.")
-    parser.add_argument("--output_dir", type=str, required=True, help="Output directory for saving the graphs.")
+    parser.add_argument("--output_dir", type=str, help="Output directory for saving the graphs.")
     parser.add_argument("--oi", action="store_true", help="Only generate isomorphic graphs if set.")
+    parser.add_argument("--stream", type=str, help="Write tagged graph sets to this FIFO or file ('-' for stdout) "
+                                                   "for process.exe --stream instead of saving them to output directory.")
 
     args = parser.parse_args()
+    if args.stream is None and args.output_dir is None:
+        parser.error("--output_dir is required unless --stream is used")
 
-    generate_graphs(True, args.start, args.end, args.step, args.set_size, args.output_dir, args.type, args.density, args.degree)
+    stream = None
+    if args.stream is not None:
+        stream = sys.stdout if args.stream == "-" else open(args.stream, "w")
+
+    generate_graphs(True, args.start, args.end, args.step, args.set_size, args.output_dir, args.type, args.density, args.degree, stream)
     if not args.oi:
-        generate_graphs(False, args.start, args.end, args.step, args.set_size, args.output_dir, args.type, args.density, args.degree)
+        generate_graphs(False, args.start, args.end, args.step, args.set_size, args.output_dir, args.type, args.density, args.degree, stream)
+
+    if stream is not None and stream is not sys.stdout:
+        stream.close()
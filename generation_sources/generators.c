@@ -0,0 +1,378 @@
+#include "generators.h"
+
+// Switchings tried per multiple edge or loop of pairing before regular graph generation gives up
+#define SWITCH_ATTEMPTS 1000
+
+static const char *type_names[TYPE_COUNT] = {
+    "path", "regular_bipartite", "complete_bipartite", "bipartite", "tree", "random", "random_connected",
+    "regular", "cactus", "cycle", "complete"
+};
+
+/* Edges of pairing which are not yet in graph, (edges[2k], edges[2k + 1]) */
+typedef struct {
+    int *edges;
+    size_t count;
+} PairList;
+
+void random_prufer_tree(Random*, const int, graph*, const int, int*);
+void add_random_pairs(Random*, const int, graph*, const int, size_t);
+void remove_random_pairs(Random*, const int, graph*, const int, size_t, const int*);
+void complement_graph(const int, graph*, const int, const int);
+const char* random_regular(Random*, const int, const int, graph*, const int);
+const char* random_regular_bipartite(Random*, const int, const int, graph*, const int);
+bool repair_pairing(Random*, graph*, const int, PairList*, PairList*, const int);
+void generate_cactus(Random*, const int, graph*, const int);
+void generate_bipartite(Random*, const int, const double, graph*, const int);
+
+GraphType parse_graph_type(const char *name) {
+    for (int type = 0; type < TYPE_COUNT; type++) {
+        if (strcmp(name, type_names[type]) == 0) return type;
+    }
+    fprintf(stderr, "Error: Unknown type of graphs: %s\n", name);
+    exit(EXIT_FAILURE);
+}
+
+const char* graph_type_name(GraphType type) {
+    return type_names[type];
+}
+
+/* Fills empty graph g with random graph of given type, O(n + m) apart from clearing of adjacency matrix.
+   Returns NULL on success, otherwise reason why graph cannot be generated. */
+const char* generate_graph(Random *random, const GenerationParams *params, const int n, graph *g, const int m) {
+    if (n < 1) return "Number of nodes must be at least 1";
+    const size_t max_edges = (size_t)n * (n - 1) / 2;
+
+    switch (params->type) {
+        case TYPE_PATH:
+            for (int v = 0; v + 1 < n; v++)
+                ADDONEEDGE(g, v, v + 1, m);
+            return NULL;
+        case TYPE_CYCLE:
+            for (int v = 0; v + 1 < n; v++)
+                ADDONEEDGE(g, v, v + 1, m);
+            if (n > 2) ADDONEEDGE(g, n - 1, 0, m);
+            return NULL;
+        case TYPE_COMPLETE:
+            complement_graph(n, g, m, 0);
+            return NULL;
+        case TYPE_COMPLETE_BIPARTITE: {
+            if (n < 2) return "At least 2 vertices are needed";
+            const int p = 1 + (int)random_below(random, n - 1);
+            for (int u = 0; u < p; u++) {
+                for (int v = p; v < n; v++)
+                    ADDONEEDGE(g, u, v, m);
+            }
+            return NULL;
+        }
+        case TYPE_TREE:
+            random_prufer_tree(random, n, g, m, NULL);
+            return NULL;
+        case TYPE_RANDOM: {
+            if (params->density < 0 || params->density > 1) return "Density must be between 0 and 1";
+            const size_t edge_count = (size_t)nearbyint(params->density * max_edges);
+            // Sampling rejects pairs which are already edges, so dense graphs are sampled from complete one
+            if (edge_count <= max_edges / 2) {
+                add_random_pairs(random, n, g, m, edge_count);
+            } else {
+                complement_graph(n, g, m, 0);
+                remove_random_pairs(random, n, g, m, max_edges - edge_count, NULL);
+            }
+            return NULL;
+        }
+        case TYPE_RANDOM_CONNECTED: {
+            if (params->density < 0 || params->density > 1) return "Density must be between 0 and 1";
+            // Random tree guarantees connectivity, additional edges are sampled among the remaining pairs
+            const size_t available = max_edges - (n - 1);
+            const size_t additional = (size_t)nearbyint(params->density * available);
+            int *parent = malloc(n * sizeof(int));
+            if (!parent) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            if (additional <= available / 2) {
+                random_prufer_tree(random, n, g, m, parent);
+                add_random_pairs(random, n, g, m, additional);
+            } else {
+                complement_graph(n, g, m, 0);
+                random_prufer_tree(random, n, g, m, parent);
+                remove_random_pairs(random, n, g, m, available - additional, parent);
+            }
+            free(parent);
+            return NULL;
+        }
+        case TYPE_BIPARTITE:
+            if (params->density < 0 || params->density > 1) return "Density must be between 0 and 1";
+            if (n < 2) return "At least 2 vertices are needed";
+            generate_bipartite(random, n, params->density, g, m);
+            return NULL;
+        case TYPE_REGULAR:
+            return random_regular(random, n, params->degree, g, m);
+        case TYPE_REGULAR_BIPARTITE:
+            return random_regular_bipartite(random, n, params->degree, g, m);
+        case TYPE_CACTUS:
+            generate_cactus(random, n, g, m);
+            return NULL;
+        default:
+            return "Unknown type of graphs";
+    }
+}
+
+/* Uniform random labelled tree decoded from random Prüfer sequence in linear time.
+   If parent is not NULL, parent[v] is set to the neighbour v was attached to, tree edges are exactly (v, parent[v]). */
+void random_prufer_tree(Random *random, const int n, graph *g, const int m, int *parent) {
+    if (parent)
+        for (int v = 0; v < n; v++)
+            parent[v] = -1;
+    if (n < 2) return;
+
+    int *code = malloc(n * sizeof(int));
+    int *degree = malloc(n * sizeof(int));
+    if (!code || !degree) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int v = 0; v < n; v++)
+        degree[v] = 1;
+    for (int k = 0; k < n - 2; k++) {
+        code[k] = (int)random_below(random, n);
+        degree[code[k]]++;
+    }
+
+    // Leaf with the smallest label is attached to next vertex of sequence
+    int pointer = 0;
+    while (degree[pointer] != 1)
+        pointer++;
+    int leaf = pointer;
+    for (int k = 0; k < n - 2; k++) {
+        const int v = code[k];
+        ADDONEEDGE(g, leaf, v, m);
+        if (parent) parent[leaf] = v;
+        if (--degree[v] == 1 && v < pointer) {
+            leaf = v;
+        } else {
+            pointer++;
+            while (degree[pointer] != 1)
+                pointer++;
+            leaf = pointer;
+        }
+    }
+    ADDONEEDGE(g, leaf, n - 1, m);
+    if (parent) parent[leaf] = n - 1;
+
+    free(code);
+    free(degree);
+}
+
+/* Adds count random edges between non-adjacent pairs. Expected O(count) steps while at most half of pairs are edges. */
+void add_random_pairs(Random *random, const int n, graph *g, const int m, size_t count) {
+    while (count > 0) {
+        const int u = (int)random_below(random, n);
+        const int v = (int)random_below(random, n);
+        if (u == v || ISELEMENT(GRAPHROW(g, u, m), v)) continue;
+        ADDONEEDGE(g, u, v, m);
+        count--;
+    }
+}
+
+/* Removes count random edges, edges (v, parent[v]) of spanning tree are kept if parent is not NULL */
+void remove_random_pairs(Random *random, const int n, graph *g, const int m, size_t count, const int *parent) {
+    while (count > 0) {
+        const int u = (int)random_below(random, n);
+        const int v = (int)random_below(random, n);
+        if (u == v || !ISELEMENT(GRAPHROW(g, u, m), v)) continue;
+        if (parent && (parent[u] == v || parent[v] == u)) continue;
+        DELELEMENT(GRAPHROW(g, u, m), v);
+        DELELEMENT(GRAPHROW(g, v, m), u);
+        count--;
+    }
+}
+
+/* Complements graph on pairs of vertices which lie in different parts, vertices below split form one part
+   and the others form the second one. Split 0 means no parts, i.e. ordinary complement. */
+void complement_graph(const int n, graph *g, const int m, const int split) {
+    for (int u = 0; u < n; u++) {
+        set *row = GRAPHROW(g, u, m);
+        const int from = split == 0 ? 0 : u < split ? split : 0;
+        const int to = split == 0 ? n : u < split ? n : split;
+        for (int v = from; v < to; v++) {
+            if (v == u) continue;
+            if (ISELEMENT(row, v)) DELELEMENT(row, v);
+            else ADDELEMENT(row, v);
+        }
+    }
+}
+
+/* Edges between random split of shuffled vertices are chosen with probability density by geometric skipping
+   over the pairs, so only O(m) random numbers are drawn */
+void generate_bipartite(Random *random, const int n, const double density, graph *g, const int m) {
+    int *vertices = malloc(n * sizeof(int));
+    if (!vertices) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int v = 0; v < n; v++)
+        vertices[v] = v;
+    random_shuffle(random, vertices, n);
+    const int split = 1 + (int)random_below(random, n - 1);
+    const uint64_t width = n - split;
+    const uint64_t pair_count = (uint64_t)split * width;
+
+    if (density > 0) {
+        const double log_miss = log1p(-density);
+        uint64_t pair = 0;
+        while (true) {
+            // Number of skipped pairs before next edge is geometrically distributed
+            if (density < 1) {
+                const double skip = floor(log1p(-random_double(random)) / log_miss);
+                if (skip >= (double)(pair_count - pair)) break;
+                pair += (uint64_t)skip;
+            }
+            if (pair >= pair_count) break;
+            ADDONEEDGE(g, vertices[pair / width], vertices[split + pair % width], m);
+            pair++;
+        }
+    }
+
+    free(vertices);
+}
+
+/* Sage RandomRegular semantics: d-regular graph on n vertices. Pairing model gives multigraph, whose loops and
+   multiple edges are removed by random switchings. Graphs with degree above (n - 1) / 2 are complements of
+   sparser regular graphs, so that switchings always have room. */
+const char* random_regular(Random *random, const int n, const int d, graph *g, const int m) {
+    if (d < 0 || d >= n) return "Degree must be between 0 and n - 1";
+    if (((long)d * n) % 2 != 0) return "degree * n must be even!";
+    const bool complement = 2 * d > n - 1;
+    const int degree = complement ? n - 1 - d : d;
+    const size_t edge_count = (size_t)degree * n / 2;
+
+    int *points = malloc((2 * edge_count + 1) * sizeof(int));
+    PairList pending = {malloc((2 * edge_count + 1) * sizeof(int)), 0};
+    PairList edges = {malloc((2 * edge_count + 1) * sizeof(int)), 0};
+    if (!points || !pending.edges || !edges.edges) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < 2 * edge_count; k++)
+        points[k] = (int)(k / degree);
+    random_shuffle(random, points, (int)(2 * edge_count));
+    for (size_t e = 0; e < edge_count; e++) {
+        const int u = points[2 * e];
+        const int v = points[2 * e + 1];
+        PairList *list = u != v && !ISELEMENT(GRAPHROW(g, u, m), v) ? &edges : &pending;
+        if (list == &edges) ADDONEEDGE(g, u, v, m);
+        (list->edges)[2 * list->count] = u;
+        (list->edges)[2 * list->count + 1] = v;
+        list->count++;
+    }
+
+    const bool repaired = repair_pairing(random, g, m, &pending, &edges, 0);
+    free(points);
+    free(pending.edges);
+    free(edges.edges);
+    if (!repaired) return "Failed to generate regular graph";
+    if (complement) complement_graph(n, g, m, 0);
+    return NULL;
+}
+
+/* Both parts have n / 2 vertices, each vertex of the first part is paired with d random points of the second one */
+const char* random_regular_bipartite(Random *random, const int n, const int d, graph *g, const int m) {
+    if (n < 2) return "At least 2 vertices are required";
+    if (d < 1) return "Degree must be at least 1";
+    if (n % 2 != 0) return "n must be even for perfect bipartite regularity";
+    if (d > n / 2) return "Degree too high for bipartite regular graph";
+    const int half = n / 2;
+    const bool complement = 2 * d > half;
+    const int degree = complement ? half - d : d;
+    const size_t edge_count = (size_t)degree * half;
+
+    int *points = malloc((edge_count + 1) * sizeof(int));
+    PairList pending = {malloc((2 * edge_count + 1) * sizeof(int)), 0};
+    PairList edges = {malloc((2 * edge_count + 1) * sizeof(int)), 0};
+    if (!points || !pending.edges || !edges.edges) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < edge_count; k++)
+        points[k] = half + (int)(k / degree);
+    random_shuffle(random, points, (int)edge_count);
+    for (size_t e = 0; e < edge_count; e++) {
+        const int u = (int)(e / degree);
+        const int v = points[e];
+        PairList *list = ISELEMENT(GRAPHROW(g, u, m), v) ? &pending : &edges;
+        if (list == &edges) ADDONEEDGE(g, u, v, m);
+        (list->edges)[2 * list->count] = u;
+        (list->edges)[2 * list->count + 1] = v;
+        list->count++;
+    }
+
+    const bool repaired = repair_pairing(random, g, m, &pending, &edges, half);
+    free(points);
+    free(pending.edges);
+    free(edges.edges);
+    if (!repaired) return "Failed to generate regular bipartite graph";
+    if (complement) complement_graph(n, g, m, half);
+    return NULL;
+}
+
+/* Replaces each loop or repeated pair (u, v) of pairing and a random edge (x, y) of graph by edges (u, x) and
+   (v, y), which keeps all degrees. In bipartite pairing (split > 0) edges are stored as (first part, second part)
+   and are switched to (u, y) and (x, v) instead. Returns false if some pair cannot be switched. */
+bool repair_pairing(Random *random, graph *g, const int m, PairList *pending, PairList *edges, const int split) {
+    while (pending->count > 0) {
+        const size_t last = --pending->count;
+        const int u = (pending->edges)[2 * last];
+        const int v = (pending->edges)[2 * last + 1];
+
+        bool switched = false;
+        for (int attempt = 0; attempt < SWITCH_ATTEMPTS && edges->count > 0 && !switched; attempt++) {
+            const size_t e = random_below(random, edges->count);
+            int x = (edges->edges)[2 * e];
+            int y = (edges->edges)[2 * e + 1];
+            if (split == 0 && random_below(random, 2)) {
+                const int t = x;
+                x = y;
+                y = t;
+            }
+            // New edges a-b and c-d
+            const int a = u, b = split == 0 ? x : y;
+            const int c = v, d = split == 0 ? y : x;
+            if (a == b || c == d || (a == c && b == d) || (a == d && b == c)) continue;
+            if (ISELEMENT(GRAPHROW(g, a, m), b) || ISELEMENT(GRAPHROW(g, c, m), d)) continue;
+
+            DELELEMENT(GRAPHROW(g, x, m), y);
+            DELELEMENT(GRAPHROW(g, y, m), x);
+            ADDONEEDGE(g, a, b, m);
+            ADDONEEDGE(g, c, d, m);
+            (edges->edges)[2 * e] = split == 0 || a < split ? a : b;
+            (edges->edges)[2 * e + 1] = split == 0 || a < split ? b : a;
+            (edges->edges)[2 * edges->count] = split == 0 || d < split ? d : c;
+            (edges->edges)[2 * edges->count + 1] = split == 0 || d < split ? c : d;
+            edges->count++;
+            switched = true;
+        }
+        if (!switched) return false;
+    }
+    return true;
+}
+
+/* Same process as generation.py: edges and cycles are attached to random existing vertices */
+void generate_cactus(Random *random, const int n, graph *g, const int m) {
+    int count = 1;
+    while (count < n) {
+        const int base = (int)random_below(random, count);
+        const int remaining = n - count;
+        if (remaining < 2 || random_below(random, 2) == 0) {
+            ADDONEEDGE(g, base, count, m);
+            count++;
+        } else {
+            // Cycle through base and cycle_length new vertices
+            const int cycle_length = 2 + (int)random_below(random, remaining - 1);
+            ADDONEEDGE(g, base, count, m);
+            for (int k = 0; k + 1 < cycle_length; k++)
+                ADDONEEDGE(g, count + k, count + k + 1, m);
+            ADDONEEDGE(g, count + cycle_length - 1, base, m);
+            count += cycle_length;
+        }
+    }
+}
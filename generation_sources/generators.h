@@ -0,0 +1,39 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nauty.h"
+#include "random.h"
+
+/* Types of --type, the same as in generation.py */
+typedef enum {
+    TYPE_PATH,
+    TYPE_REGULAR_BIPARTITE,
+    TYPE_COMPLETE_BIPARTITE,
+    TYPE_BIPARTITE,
+    TYPE_TREE,
+    TYPE_RANDOM,
+    TYPE_RANDOM_CONNECTED,
+    TYPE_REGULAR,
+    TYPE_CACTUS,
+    TYPE_CYCLE,
+    TYPE_COMPLETE,
+    TYPE_COUNT
+} GraphType;
+
+typedef struct {
+    GraphType type;
+    double density;     // --density of random, random_connected and bipartite graphs
+    int degree;         // --degree of regular and regular_bipartite graphs
+} GenerationParams;
+
+GraphType parse_graph_type(const char*);
+const char* graph_type_name(GraphType);
+const char* generate_graph(Random*, const GenerationParams*, const int, graph*, const int);
+
+#endif
@@ -0,0 +1,113 @@
+#include "graph_sets.h"
+
+graph* allocate_graph(const int, const int);
+FILE* open_set_file(const char*);
+
+/* Writes random graph of size n followed by set_size - 1 randomly relabelled copies of it.
+   Returns NULL on success, otherwise reason why set was not generated. */
+const char* write_isomorphic_set(Random *random, const GenerationParams *params, const int n, const int set_size, const char *filename) {
+    const int m = SETWORDSNEEDED(n);
+    graph *g = allocate_graph(n, m);
+    const char *error = generate_graph(random, params, n, g, m);
+    if (error) {
+        free(g);
+        return error;
+    }
+
+    graph *relabelled = allocate_graph(n, m);
+    int *permutation = malloc(n * sizeof(int));
+    if (!permutation) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *file = open_set_file(filename);
+    fputs(ntog6(g, m, n), file);
+    for (int i = 1; i < set_size; i++) {
+        random_permutation(random, permutation, n);
+        permute_graph(g, relabelled, permutation, m, n);
+        fputs(ntog6(relabelled, m, n), file);
+    }
+    fclose(file);
+
+    free(g);
+    free(relabelled);
+    free(permutation);
+    return NULL;
+}
+
+/* Generates up to NON_ISO_MAX_ATTEMPTS graphs and keeps those whose canonical form was not seen yet.
+   Canonical forms are compared by hash first, as in process.exe. At least two graphs are required. */
+const char* write_non_isomorphic_set(Random *random, const GenerationParams *params, const int n, const int set_size, const char *filename) {
+    const int m = SETWORDSNEEDED(n);
+    graph *g = allocate_graph(n, m);
+    CanonicalEntry *seen = calloc(set_size > 0 ? set_size : 1, sizeof(CanonicalEntry));
+    char **lines = calloc(set_size > 0 ? set_size : 1, sizeof(char*));
+    if (!seen || !lines) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    const LabellingSettings settings = {NULL, INVARIANT_NONE, 0, 0};
+
+    const char *error = NULL;
+    int count = 0;
+    for (int attempt = 0; attempt < NON_ISO_MAX_ATTEMPTS && count < set_size; attempt++) {
+        EMPTYGRAPH(g, m, n);
+        error = generate_graph(random, params, n, g, m);
+        if (error) break;
+
+        CanonicalEntry *entry = &seen[count];
+        memset(entry, 0, sizeof(CanonicalEntry));
+        compute_certificate(g, n, ENGINE_AUTO, &settings, entry, NULL);
+        bool duplicate = false;
+        for (int i = 0; i < count && !duplicate; i++)
+            duplicate = compare_canonical_entries(&seen[i], entry);
+        if (duplicate) {
+            free(entry->certificate);
+            continue;
+        }
+
+        lines[count] = strdup(ntog6(g, m, n));
+        if (!lines[count]) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        count++;
+    }
+
+    if (!error && count < 2)
+        error = "Cannot generate at least two non-isomorphic graphs";
+    if (!error) {
+        FILE *file = open_set_file(filename);
+        for (int i = 0; i < count; i++)
+            fputs(lines[i], file);
+        fclose(file);
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(seen[i].certificate);
+        free(lines[i]);
+    }
+    free(seen);
+    free(lines);
+    free(g);
+    return error;
+}
+
+graph* allocate_graph(const int n, const int m) {
+    graph *g = calloc((size_t)n * m, sizeof(graph));
+    if (!g) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return g;
+}
+
+FILE* open_set_file(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Unable to open file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
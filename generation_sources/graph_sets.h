@@ -0,0 +1,19 @@
+#ifndef GRAPH_SETS_H
+#define GRAPH_SETS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gtools.h"
+#include "canonical_cache.h"
+#include "generators.h"
+#include "relabel.h"
+
+// Candidates generated for one non-isomorphic set, the same limit as in generation.py
+#define NON_ISO_MAX_ATTEMPTS 30
+
+const char* write_isomorphic_set(Random*, const GenerationParams*, const int, const int, const char*);
+const char* write_non_isomorphic_set(Random*, const GenerationParams*, const int, const int, const char*);
+
+#endif
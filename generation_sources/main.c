@@ -0,0 +1,108 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "generators.h"
+#include "graph_sets.h"
+#include "file_processor.h"
+
+/* Arguments of gen.exe, the same as those of generation.py */
+typedef struct {
+    GenerationParams params;
+    int start;
+    int end;
+    int step;
+    int set_size;
+    const char *output_dir;
+    bool only_isomorphic;   // --oi
+    uint64_t seed;          // --seed, random if not given
+} GenerationSettings;
+
+void process_arguments(const int, char**, GenerationSettings*);
+void generate_graphs(bool, const GenerationSettings*, Random*);
+
+int main(const int argc, char *argv[]) {
+    GenerationSettings settings = {
+        .params = {.type = TYPE_COUNT, .density = 0.5, .degree = 3},
+        .start = -1,
+        .end = -1,
+        .step = -1,
+        .set_size = -1,
+        .output_dir = NULL,
+        .only_isomorphic = false,
+        .seed = (uint64_t)time(NULL) ^ (uint64_t)getpid() << 32
+    };
+    process_arguments(argc, argv, &settings);
+    printf("Seed: %llu\n", (unsigned long long)settings.seed);
+
+    Random random;
+    seed_random(&random, settings.seed);
+    generate_graphs(true, &settings, &random);
+    if (!settings.only_isomorphic)
+        generate_graphs(false, &settings, &random);
+
+    return EXIT_SUCCESS;
+}
+
+void process_arguments(const int argc, char **argv, GenerationSettings *settings) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            settings->params.type = parse_graph_type(argv[++i]);
+        } else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            settings->params.density = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--degree") == 0 && i + 1 < argc) {
+            settings->params.degree = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            settings->start = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--end") == 0 && i + 1 < argc) {
+            settings->end = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            settings->step = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--set_size") == 0 && i + 1 < argc) {
+            settings->set_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--output_dir") == 0 && i + 1 < argc) {
+            settings->output_dir = argv[++i];
+        } else if (strcmp(argv[i], "--oi") == 0) {
+            settings->only_isomorphic = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            settings->seed = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Required flags
+    if (settings->params.type == TYPE_COUNT || settings->start < 0 || settings->end < 0 || settings->step <= 0 ||
+        settings->set_size < 0 || !settings->output_dir) {
+        fprintf(stderr, "Usage: %s --type TYPE --start N --end N --step N --set_size N --output_dir DIR\n"
+                        "       [--density D] [--degree D] [--oi] [--seed N]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Writes <output_dir>/isomorphic/<n>.g6 or <output_dir>/non_isomorphic/<n>.g6 for each size,
+   sizes whose set cannot be generated are skipped */
+void generate_graphs(bool is_isomorphic, const GenerationSettings *settings, Random *random) {
+    char dir[1024];
+    const size_t length = strlen(settings->output_dir);
+    const bool slash = length > 0 && settings->output_dir[length - 1] == '/';
+    snprintf(dir, sizeof(dir), "%s%s%s", settings->output_dir, slash ? "" : "/", is_isomorphic ? "isomorphic" : "non_isomorphic");
+    if (create_directories(dir) != 0) {
+        fprintf(stderr, "Error: Unable to create directory %s\n", dir);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int n = settings->start; n <= settings->end; n += settings->step) {
+        char filename[1100];
+        snprintf(filename, sizeof(filename), "%s/%d.g6", dir, n);
+        const char *error = is_isomorphic
+                ? write_isomorphic_set(random, &(settings->params), n, settings->set_size, filename)
+                : write_non_isomorphic_set(random, &(settings->params), n, settings->set_size, filename);
+        if (error)
+            printf("Exception during %s graph generation of %s graphs with %d vertices: %s\n",
+                   is_isomorphic ? "isomorphic" : "non-isomorphic", graph_type_name(settings->params.type), n, error);
+    }
+
+    printf("%s dataset generated and saved in '%s'.\n", is_isomorphic ? "Isomorphic" : "Non-isomorphic", dir);
+}
@@ -42,6 +42,9 @@ GENERATION OPTIONS (used if generation is not dropped):
   --step <int>                  Step size between graph sizes (default: 10).
   --set_num <int>               Number of graphs to generate per size (default: 3).
   --oi                          Only generate isomorphic graphs.
+  --native_gen                  Generate with native gen.exe instead of Sage generation.py, much faster for large sizes.
+  --stream                      Run generation and processing concurrently, generation.py streams graph sets through
+                                a pipe into process.exe, which processes each set as it arrives. Dataset is not saved.
 
 TYPE-SPECIFIC GENERATION OPTIONS:
   For 'random' and 'bipartite':
@@ -52,6 +55,49 @@ TYPE-SPECIFIC GENERATION OPTIONS:
 
 PROCESSING OPTIONS:
     --opt_tree                  Run processing stage with optimization for trees.
+    --opt_planar                Run processing stage with optimization for planar graphs.
+    --solvers <list>            Comma separated special solvers which decide isomorphism without canonical labelling:
+                                path, cycle, complete, complete_bipartite, union, tree, cactus, planar or all.
+                                Solved checks of every solver are reported in 'solved_*' columns.
+    --engine <engine>           Canonical labelling engine: dense, sparse, traces or auto (default: dense).
+                                Auto chooses sparse engines for graphs with low edge density.
+                                vf2pp matches each pair directly by VF2++ search instead of canonical labelling,
+                                it cannot be combined with --store or --invariant.
+    --threads <int>             Number of worker threads, 0 means one per CPU (default: 1).
+                                More than one thread requires process.exe built with -DNAUTY_TLS=ON.
+    --prefetch <int>            Files read ahead by a reader thread while current file is processed, only with
+                                one thread (default: 0, disabled). Reader and compute stalls are reported.
+    --self_relabel <int>        Benchmark isomorphic sets as first graph of each file and this many random relabellings
+                                generated in memory, so one graph per size is enough (default: 0, disabled).
+    --relabel_seed <int>        Seed of relabellings of --self_relabel (default: 1).
+    --small                     Process with process_small.exe, which canonicalises graphs with up to 256 vertices
+                                by nauty builds with fixed MAXN. Requires nauty sources and nautyL.a (nautyTL.a).
+    --warmup <int>              Unmeasured runs of each graph set (default: 0).
+    --reps <int>                Measured runs of each graph set, statistics are computed over them (default: 1).
+    --pin                       Pin processing threads to CPUs.
+    --prefilter                 Reject non-isomorphic pairs by cheap invariants before canonical labelling.
+    --invariant <invariant>     Vertex invariant of dense engine: none, cellquads, cellfano, distances, adjtriang
+                                or auto (default: none). Auto tries invariants on a sample of every regular set.
+    --invarlev <int>            Deepest search tree level where invariant is applied (default: 1).
+    --invararg <int>            Argument of invariant (default: 0).
+    --budget_time <float>       Abort canonical labelling of a graph after this many seconds (default: no limit).
+    --budget_nodes <int>        Abort canonical labelling of a graph after this many search tree nodes (default: no limit).
+                                Budgets cannot be used with --engine traces, auto engine then uses sparse instead of Traces.
+                                Aborted checks are reported in 'censored' column, their set time is a lower bound.
+    --instrument                Save nauty search statistics, hardware counters and peak RSS of every set
+                                next to processed .csv file and plot search tree size.
+    --store <file>              Keep canonical certificates in <file> and reuse them in later runs.
+                                Reused certificates report the time measured when they were computed.
+                                It requires --warmup 0 and --reps 1.
+    --checkpoint <file>         Save result of every finished graph file to <file>. Rerun with the same
+                                checkpoint and options continues interrupted processing, graph files changed
+                                since they were saved are processed again.
+    --pack                      Convert dataset to binary dataset.gpk files before processing, graphs are then used
+                                without decoding. Packed files are kept next to .g6 files and used by later runs.
+    --shard <i/N>               Process only shard i of N of an existing dataset, for sweeps split over several machines.
+                                Files are balanced by estimated cost, every machine computes the same partition.
+                                Shard results are combined by './process.exe --merge <result.csv> <shard.csv>...'.
+    --shard_costs <file>        Processed .csv file of a previous run, its timings are used to estimate costs.
 
 NOTES:
   - For 'srg' and 'planar' types, generation is skipped automatically and pre-prepared datasets are used.
@@ -88,6 +134,8 @@ END=500
 STEP=10
 SET_SIZE=3
 ONLY_ISOMORPHIC="false"
+NATIVE_GEN="false"
+STREAM="false"
 
 # Specific generation variables
 DEGREE=3
@@ -95,6 +143,29 @@ DENSITY=0.5
 
 # Processing variables
 OPT_TREE="false"
+OPT_PLANAR="false"
+SMALL="false"
+SOLVERS=""
+ENGINE="dense"
+THREADS=1
+PREFETCH=0
+SELF_RELABEL=0
+RELABEL_SEED=""
+WARMUP=0
+REPS=1
+PIN="false"
+PREFILTER="false"
+INVARIANT="none"
+INVARLEV=1
+INVARARG=0
+BUDGET_TIME=0
+BUDGET_NODES=0
+INSTRUMENT="false"
+STORE=""
+CHECKPOINT=""
+PACK="false"
+SHARD=""
+SHARD_COSTS=""
 
 # Process arguments
 while [[ "$#" -gt 0 ]]; do
@@ -155,6 +226,12 @@ while [[ "$#" -gt 0 ]]; do
         --oi)
             ONLY_ISOMORPHIC="true"
             ;;
+        --native_gen)
+            NATIVE_GEN="true"
+            ;;
+        --stream)
+            STREAM="true"
+            ;;
         # Specific generation arguments
         --degree)
             DEGREE=$2
@@ -166,6 +243,75 @@ while [[ "$#" -gt 0 ]]; do
         --opt_tree)
             OPT_TREE="true"
             ;;
+        --opt_planar)
+            OPT_PLANAR="true"
+            ;;
+        --small)
+            SMALL="true"
+            ;;
+        --solvers)
+            SOLVERS=$2
+            shift;;
+        --engine)
+            ENGINE=$2
+            shift;;
+        --threads)
+            THREADS=$2
+            shift;;
+        --prefetch)
+            PREFETCH=$2
+            shift;;
+        --self_relabel)
+            SELF_RELABEL=$2
+            shift;;
+        --relabel_seed)
+            RELABEL_SEED=$2
+            shift;;
+        --warmup)
+            WARMUP=$2
+            shift;;
+        --reps)
+            REPS=$2
+            shift;;
+        --pin)
+            PIN="true"
+            ;;
+        --prefilter)
+            PREFILTER="true"
+            ;;
+        --invariant)
+            INVARIANT=$2
+            shift;;
+        --invarlev)
+            INVARLEV=$2
+            shift;;
+        --invararg)
+            INVARARG=$2
+            shift;;
+        --budget_time)
+            BUDGET_TIME=$2
+            shift;;
+        --budget_nodes)
+            BUDGET_NODES=$2
+            shift;;
+        --instrument)
+            INSTRUMENT="true"
+            ;;
+        --store)
+            STORE=$2
+            shift;;
+        --checkpoint)
+            CHECKPOINT=$2
+            shift;;
+        --pack)
+            PACK="true"
+            ;;
+        --shard)
+            SHARD=$2
+            shift;;
+        --shard_costs)
+            SHARD_COSTS=$2
+            shift;;
         *)
             echo "Unknown parameter: $1, type --help for help"
             exit 1;;
@@ -184,13 +330,36 @@ case "$GRAPH_TYPE" in
         ;;
 esac
 
+# Streaming connects generation.py with processing, both stages have to run
+if [ "$STREAM" = "true" ]; then
+    if [ "$RUN_GEN" != "true" ] || [ "$RUN_PROC" != "true" ]; then
+        echo "--stream requires both generation and processing stages"
+        exit 1
+    fi
+    if [ "$NATIVE_GEN" = "true" ] || [ "$PREFETCH" != "0" ] || [ -n "$CHECKPOINT" ] || [ "$PACK" = "true" ] ||
+       [ "$SELF_RELABEL" != "0" ]; then
+        echo "--stream cannot be combined with --native_gen, --prefetch, --checkpoint, --pack or --self_relabel"
+        exit 1
+    fi
+fi
+
+# Every shard has to see the same dataset, it cannot be generated independently on each machine
+if [ -n "$SHARD" ] && [ "$RUN_GEN" = "true" ]; then
+    echo "--shard requires an existing dataset, use it with --only_proc or --drop_gen"
+    exit 1
+fi
+
 # Create files and directories names
 if [ "$RUN_GEN" = "true" ]; then
     DATASET_DIR="generated_dataset/${GRAPH_TYPE}/${TIMESTAMP}/"
 fi
 if [ "$RUN_PROC" = "true" ]; then
     PROCESSED_FILENAME="processed/${GRAPH_TYPE}/${TIMESTAMP}.csv"
+    if [ -n "$SHARD" ]; then
+        PROCESSED_FILENAME="processed/${GRAPH_TYPE}/${TIMESTAMP}_shard${SHARD%/*}of${SHARD#*/}.csv"
+    fi
 fi
+INSTRUMENTATION_FILENAME="${PROCESSED_FILENAME%.csv}_instrumentation.csv"
 PICTURE_DIR="pictures/${GRAPH_TYPE}/${TIMESTAMP}/"
 
 
@@ -216,7 +385,22 @@ if [ "$RUN_GEN" = "true" ]; then
       GEN_ARGS+=(--oi)
     fi
 
-    sage -python generation.py "${GEN_ARGS[@]}"
+    if [ "$STREAM" = "true" ]; then
+        echo "Generation is streamed into processing stage"
+    elif [ "$NATIVE_GEN" = "true" ]; then
+        # Compile generator if running for the first time
+        if [ ! -f "./gen.exe" ]; then
+            mkdir -p build
+            cd build || { echo "Failed to compile gen.exe"; exit 1; }
+            cmake ..
+            make gen.exe
+            cp "./gen.exe" "../gen.exe"
+            cd ..
+        fi
+        ./gen.exe "${GEN_ARGS[@]}" || { echo "Generation stage failed, stop pipeline"; exit 1; }
+    else
+        sage -python generation.py "${GEN_ARGS[@]}"
+    fi
 else
     echo "Drop generation stage"
 fi
@@ -225,26 +409,93 @@ fi
 if [ "$RUN_PROC" = "true" ]; then
     echo "Start processing stage"
 
-    # Compile process.exe if running for the first time
-    if [ ! -f ./process.exe ]; then
+    # Compile processing executable if running for the first time
+    PROCESS_EXE="process.exe"
+    if [ "$SMALL" = "true" ]; then
+        PROCESS_EXE="process_small.exe"
+    fi
+    if [ ! -f "./$PROCESS_EXE" ]; then
         mkdir -p build
-        cd build || { echo "Failed to compile process.exe"; exit 1; }
-        cmake ..
-        make
-        cp ./process.exe ../process.exe
+        cd build || { echo "Failed to compile $PROCESS_EXE"; exit 1; }
+        if [ "$THREADS" != "1" ]; then
+            cmake -DNAUTY_TLS=ON ..
+        else
+            cmake ..
+        fi
+        make "$PROCESS_EXE"
+        cp "./$PROCESS_EXE" "../$PROCESS_EXE"
         cd ..
     fi
 
+    if [ "$PACK" = "true" ]; then
+        "./$PROCESS_EXE" --pack "$DATASET_DIR" || { echo "Packing of dataset failed, stop pipeline"; exit 1; }
+    fi
+
     # Set processing arguments
     PROC_ARGS=(
       "$DATASET_DIR"
       "$PROCESSED_FILENAME"
+      --engine "$ENGINE"
+      --threads "$THREADS"
+      --warmup "$WARMUP"
+      --reps "$REPS"
+      --invariant "$INVARIANT"
+      --invarlev "$INVARLEV"
+      --invararg "$INVARARG"
+      --budget_time "$BUDGET_TIME"
+      --budget_nodes "$BUDGET_NODES"
     )
+    if [ "$PREFETCH" != "0" ]; then
+      PROC_ARGS+=(--prefetch "$PREFETCH")
+    fi
+    if [ "$SELF_RELABEL" != "0" ]; then
+      PROC_ARGS+=(--self_relabel "$SELF_RELABEL")
+      if [ -n "$RELABEL_SEED" ]; then
+        PROC_ARGS+=(--seed "$RELABEL_SEED")
+      fi
+    fi
     if [ "$OPT_TREE" = "true" ]; then
       PROC_ARGS+=(--opt_tree)
     fi
+    if [ "$OPT_PLANAR" = "true" ]; then
+      PROC_ARGS+=(--opt_planar)
+    fi
+    if [ -n "$SOLVERS" ]; then
+      PROC_ARGS+=(--solvers "$SOLVERS")
+    fi
+    if [ "$PIN" = "true" ]; then
+      PROC_ARGS+=(--pin)
+    fi
+    if [ "$PREFILTER" = "true" ]; then
+      PROC_ARGS+=(--prefilter)
+    fi
+    if [ "$INSTRUMENT" = "true" ]; then
+      PROC_ARGS+=(--instrument "$INSTRUMENTATION_FILENAME")
+    fi
+    if [ -n "$STORE" ]; then
+      PROC_ARGS+=(--store "$STORE")
+    fi
+    if [ -n "$CHECKPOINT" ]; then
+      PROC_ARGS+=(--checkpoint "$CHECKPOINT")
+    fi
+    if [ -n "$SHARD" ]; then
+      PROC_ARGS+=(--shard "$SHARD")
+    fi
+    if [ -n "$SHARD_COSTS" ]; then
+      PROC_ARGS+=(--shard_costs "$SHARD_COSTS")
+    fi
 
-    ./process.exe "${PROC_ARGS[@]}" || { echo "Processing stage failed, stop pipeline"; exit 1; }
+    if [ "$STREAM" = "true" ]; then
+        # Generation runs concurrently, process.exe reads tagged sets from stdin instead of dataset directory
+        PROC_ARGS[0]="-"
+        PROC_ARGS+=(--stream)
+        sage -python generation.py "${GEN_ARGS[@]}" --stream - | "./$PROCESS_EXE" "${PROC_ARGS[@]}"
+        STATUS=("${PIPESTATUS[@]}")
+        [ "${STATUS[0]}" = "0" ] || { echo "Generation stage failed, stop pipeline"; exit 1; }
+        [ "${STATUS[1]}" = "0" ] || { echo "Processing stage failed, stop pipeline"; exit 1; }
+    else
+        "./$PROCESS_EXE" "${PROC_ARGS[@]}" || { echo "Processing stage failed, stop pipeline"; exit 1; }
+    fi
 else
     echo "Drop processing stage"
 fi
@@ -258,6 +509,9 @@ if [ "$RUN_VIS" = "true" ]; then
       --data_file "$PROCESSED_FILENAME"
       --output_dir "$PICTURE_DIR"
     )
+    if [ -f "$INSTRUMENTATION_FILENAME" ]; then
+      VIS_ARGS+=(--instrumentation_file "$INSTRUMENTATION_FILENAME")
+    fi
 
     python3 draw.py "${VIS_ARGS[@]}" || { echo "Visualisation stage failed, stop pipeline"; exit 1; }
 else
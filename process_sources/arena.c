@@ -0,0 +1,137 @@
+#include <pthread.h>
+#include <string.h>
+#include "arena.h"
+
+// Allocations are aligned for any scalar type, data of block starts after its header rounded up to alignment
+#define ARENA_ALIGNMENT 16
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+#define ARENA_BLOCK_SIZE ((size_t)256 << 10)
+// Released blocks above this size in total are given back to system when set ends
+#define ARENA_RETAINED ((size_t)64 << 20)
+
+// Blocks of each thread are freed when thread exits
+static pthread_key_t arena_key;
+static pthread_once_t arena_once = PTHREAD_ONCE_INIT;
+static TLS_ATTR Arena arena;
+
+ArenaBlock* take_block(Arena*, const size_t);
+void create_arena_key(void);
+void free_arena(void*);
+void free_blocks_chain(ArenaBlock*);
+
+Arena* thread_arena(void) {
+    return &arena;
+}
+
+void* arena_alloc(Arena *a, const size_t size) {
+    const size_t aligned = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (!(a->current) || a->current->size - a->current->used < aligned)
+        a->current = take_block(a, aligned);
+
+    void *memory = (char*)(a->current) + ARENA_HEADER + a->current->used;
+    a->current->used += aligned;
+    a->held += aligned;
+
+    a->stats.allocations++;
+    a->stats.bytes += size;
+    if (a->held - a->base > a->stats.peak)
+        a->stats.peak = a->held - a->base;
+    return memory;
+}
+
+void* arena_calloc(Arena *a, const size_t count, const size_t size) {
+    void *memory = arena_alloc(a, count * size);
+    memset(memory, 0, count * size);
+    return memory;
+}
+
+/* Spare block large enough is reused, otherwise new one is allocated. Rest of current block stays unused. */
+ArenaBlock* take_block(Arena *a, const size_t size) {
+    ArenaBlock **link = &(a->spare);
+    while (*link && (*link)->size < size)
+        link = &((*link)->previous);
+
+    ArenaBlock *block = *link;
+    if (block) {
+        *link = block->previous;
+    } else {
+        const size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = malloc(ARENA_HEADER + block_size);
+        if (!block) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        block->size = block_size;
+        a->stats.blocks++;
+
+        pthread_once(&arena_once, create_arena_key);
+        pthread_setspecific(arena_key, a);
+    }
+    block->used = 0;
+    block->previous = a->current;
+    return block;
+}
+
+ArenaMark arena_mark(const Arena *a) {
+    ArenaMark mark = {a->current, a->current ? a->current->used : 0, a->held};
+    return mark;
+}
+
+/* Blocks started after mark become spare */
+void arena_release(Arena *a, const ArenaMark mark) {
+    while (a->current != mark.block) {
+        ArenaBlock *block = a->current;
+        a->current = block->previous;
+        block->previous = a->spare;
+        a->spare = block;
+    }
+    if (a->current)
+        a->current->used = mark.used;
+    a->held = mark.held;
+}
+
+/* Statistics are counted from here, scratch memory of set is released by end_arena_set */
+ArenaMark begin_arena_set(Arena *a) {
+    memset(&(a->stats), 0, sizeof(ArenaStats));
+    a->base = a->held;
+    return arena_mark(a);
+}
+
+/* Releases memory of set and writes its statistics. Spare blocks are kept for next sets up to ARENA_RETAINED. */
+void end_arena_set(Arena *a, const ArenaMark mark, ArenaStats *stats) {
+    arena_release(a, mark);
+    *stats = a->stats;
+
+    size_t retained = 0;
+    ArenaBlock **link = &(a->spare);
+    while (*link) {
+        ArenaBlock *block = *link;
+        if (retained + block->size <= ARENA_RETAINED) {
+            retained += block->size;
+            link = &(block->previous);
+        } else {
+            *link = block->previous;
+            free(block);
+        }
+    }
+}
+
+void create_arena_key(void) {
+    pthread_key_create(&arena_key, free_arena);
+}
+
+/* Destructor of thread, frees all its blocks */
+void free_arena(void *data) {
+    Arena *a = data;
+    free_blocks_chain(a->current);
+    free_blocks_chain(a->spare);
+    memset(a, 0, sizeof(Arena));
+}
+
+void free_blocks_chain(ArenaBlock *block) {
+    while (block) {
+        ArenaBlock *previous = block->previous;
+        free(block);
+        block = previous;
+    }
+}
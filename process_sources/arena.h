@@ -0,0 +1,49 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "nauty.h"
+
+/* Block of arena, its memory follows the header */
+typedef struct ArenaBlock {
+    struct ArenaBlock *previous;
+    size_t size;
+    size_t used;
+} ArenaBlock;
+
+/* Allocations made while one graph set was processed */
+typedef struct {
+    long allocations;   // Requests served by arena
+    size_t bytes;       // Bytes requested
+    size_t peak;        // Largest amount of bytes held at once
+    long blocks;        // Blocks which had to be taken from malloc, 0 once blocks of earlier sets are reused
+} ArenaStats;
+
+/* Position in arena, releasing it frees everything allocated after it */
+typedef struct {
+    ArenaBlock *block;
+    size_t used;
+    size_t held;
+} ArenaMark;
+
+/* Scratch memory of one thread. Allocation bumps a pointer, memory is freed only in stack order by releasing a mark
+   and released blocks are kept for next allocations, so after the first sets no memory is requested from system. */
+typedef struct {
+    ArenaBlock *current;    // Blocks in use, newest first
+    ArenaBlock *spare;      // Released blocks
+    size_t held;            // Bytes allocated and not released
+    size_t base;            // Bytes held when set started
+    ArenaStats stats;
+} Arena;
+
+Arena* thread_arena(void);
+void* arena_alloc(Arena*, const size_t);
+void* arena_calloc(Arena*, const size_t, const size_t);
+ArenaMark arena_mark(const Arena*);
+void arena_release(Arena*, const ArenaMark);
+ArenaMark begin_arena_set(Arena*);
+void end_arena_set(Arena*, const ArenaMark, ArenaStats*);
+
+#endif
@@ -0,0 +1,283 @@
+#include "canonical_cache.h"
+
+// Number of graphs on which auto mode tries invariants
+#define AUTO_INVARIANT_SAMPLE 3
+
+// Invariants tried by auto mode, from the cheapest one
+static const Invariant auto_invariants[] = {
+    INVARIANT_NONE, INVARIANT_ADJTRIANG, INVARIANT_DISTANCES, INVARIANT_CELLQUADS, INVARIANT_CELLFANO
+};
+
+uint64_t labelling_variant(const CanonicalCache*);
+bool is_regular(graph*, const int, const int);
+void compute_canonical_entry(CanonicalCache*, const GraphFile*, const int, CanonicalEntry*);
+void run_canonical_labelling(CanonicalCache*, const GraphFile*, const int, CanonicalEntry*, SearchStats*);
+
+void init_canonical_cache(CanonicalCache *cache, const int count, const int n, const Options *options) {
+    cache->count = count;
+    cache->n = n;
+    cache->m = SETWORDSNEEDED(n);
+    cache->engine = options->engine;
+    cache->store = options->store;
+    cache->budget = options->budget;
+    const bool budgeted = options->budget.time > 0 || options->budget.nodes > 0;
+    cache->settings.budget = budgeted ? &(cache->budget) : NULL;
+    cache->settings.invariant = options->invariant == INVARIANT_AUTO ? INVARIANT_NONE : options->invariant;
+    cache->settings.invar_level = options->invar_level;
+    cache->settings.invar_arg = options->invar_arg;
+    cache->instrument = options->instrument;
+    cache->entries = calloc(count, sizeof(CanonicalEntry));
+    if (!cache->entries) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Returns canonical form of graphs[index], computing it only on the first request.
+   With certificate store the form and its recorded time are taken from store, if graph was canonicalised before.
+   Entry is censored if canonicalisation exceeded budget.
+   Different indices may be requested from different threads at the same time. */
+CanonicalEntry* get_canonical_entry(CanonicalCache *cache, const GraphFile *graphs, const int index) {
+    CanonicalEntry *entry = &(cache->entries)[index];
+    if (entry->certificate || entry->censored) return entry;
+
+    if (!cache->store) {
+        compute_canonical_entry(cache, graphs, index, entry);
+        return entry;
+    }
+
+    size_t length;
+    const char *line = get_graph_line(graphs, index, &length);
+    const StoreKey key = store_key(line, length, labelling_variant(cache));
+    const StoreRecord *record = find_certificate(cache->store, &key);
+    if (record) {
+        entry->certificate = (void*)record_certificate(record);
+        entry->size = record->size;
+        entry->engine = record->engine;
+        entry->time = record->time;
+        entry->stored = true;
+        entry->hash = hash_certificate(entry->certificate, entry->size);
+        return entry;
+    }
+
+    compute_canonical_entry(cache, graphs, index, entry);
+    if (!entry->censored) add_certificate(cache->store, &key, entry->certificate, entry->size, entry->engine, entry->time);
+    return entry;
+}
+
+/* Canonicalises graphs[index] with engine selected for it, measuring hardware counters if required */
+void compute_canonical_entry(CanonicalCache *cache, const GraphFile *graphs, const int index, CanonicalEntry *entry) {
+    if (!cache->instrument) {
+        run_canonical_labelling(cache, graphs, index, entry, &(entry->search));
+        return;
+    }
+
+    HardwareCounters start;
+    read_counters(&start);
+    run_canonical_labelling(cache, graphs, index, entry, &(entry->search));
+    counters_since(&start, &(entry->counters));
+}
+
+/* Order is taken from graph itself, so one cache can hold graphs of different orders */
+void run_canonical_labelling(CanonicalCache *cache, const GraphFile *graphs, const int index, CanonicalEntry *entry, SearchStats *search) {
+    const int n = graph_file_order(graphs, index);
+
+    // sparse6 input goes to sparse engines without dense form
+    if (is_sparse6_graph(graphs, index)) {
+        sparsegraph *sg = get_sparse_graph(graphs, index);
+        entry->engine = select_engine_by_degrees(sg->nde, n, cache->engine, cache->settings.budget != NULL);
+        if (entry->engine != ENGINE_DENSE) {
+            int *certificate;
+            entry->time = canonical_form_sparsegraph(sg, entry->engine, &certificate, &(entry->size), &(cache->settings), &(entry->censored), search);
+            entry->certificate = certificate;
+            if (!entry->censored) entry->hash = hash_certificate(entry->certificate, entry->size);
+            return;
+        }
+    }
+
+    compute_certificate(get_graph(graphs, index), n, cache->engine, &(cache->settings), entry, search);
+}
+
+/* Canonical form of dense graph by engine selected for it. Entry is censored and has no certificate if budget was exceeded. */
+void compute_certificate(graph *g, const int n, Engine requested, const LabellingSettings *settings, CanonicalEntry *entry, SearchStats *search) {
+    entry->engine = select_engine(g, n, requested, settings && settings->budget);
+
+    if (entry->engine == ENGINE_DENSE) {
+        entry->size = SETWORDSNEEDED(n) * (size_t)n * sizeof(graph);
+        entry->certificate = malloc(entry->size);
+        if (!entry->certificate) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        entry->time = canonical_form_nauty(g, entry->certificate, n, settings, &(entry->censored), search);
+        if (entry->censored) {
+            free(entry->certificate);
+            entry->certificate = NULL;
+            entry->size = 0;
+        }
+    } else {
+        int *certificate;
+        entry->time = canonical_form_sparse(g, n, entry->engine, &certificate, &(entry->size), settings, &(entry->censored), search);
+        entry->certificate = certificate;
+    }
+
+    if (!entry->censored) entry->hash = hash_certificate(entry->certificate, entry->size);
+}
+
+/* Graphs are isomorphic iff their canonical forms are equal. Hashes reject almost all non-isomorphic pairs.
+   Auto mode selects engine by edge count, so different engines imply non-isomorphic graphs. */
+bool compare_canonical_entries(const CanonicalEntry *entry1, const CanonicalEntry *entry2) {
+    if (entry1->engine != entry2->engine || entry1->size != entry2->size || entry1->hash != entry2->hash) return false;
+    return memcmp(entry1->certificate, entry2->certificate, entry1->size) == 0;
+}
+
+/* Total time of all canonicalisations made by cache */
+double canonical_cache_time(const CanonicalCache *cache) {
+    double total_time = 0.0;
+    for (int i = 0; i < cache->count; i++) {
+        total_time += (cache->entries)[i].time;
+    }
+    return total_time;
+}
+
+/* Bitmask (1 << Engine) of engines which actually ran */
+int canonical_cache_engines(const CanonicalCache *cache) {
+    int engines = 0;
+    for (int i = 0; i < cache->count; i++) {
+        if ((cache->entries)[i].certificate || (cache->entries)[i].censored)
+            engines |= 1 << (cache->entries)[i].engine;
+    }
+    return engines;
+}
+
+/* Chooses invariant for the whole set, graphs must not be canonicalised yet. Refinement already splits graphs
+   which are not regular. For regular ones every candidate canonicalises a sample of the set with the time
+   of the best candidate so far as budget, and the fastest one wins. Returns time spent on probing. */
+double select_invariant(CanonicalCache *cache, const GraphFile *graphs) {
+    const int sample = cache->count < AUTO_INVARIANT_SAMPLE ? cache->count : AUTO_INVARIANT_SAMPLE;
+    const int n = cache->n;
+    const int m = cache->m;
+    cache->settings.invariant = INVARIANT_NONE;
+    double probe_time = 0.0;
+
+    bool regular = true;
+    for (int i = 0; i < sample && regular; i++) {
+        graph *g = get_graph(graphs, i);
+        const double start = thread_cpu_time();
+        regular = is_regular(g, n, m);
+        probe_time += thread_cpu_time() - start;
+    }
+    if (!regular || sample == 0) return probe_time;
+
+    graph *canon = malloc(m * (size_t)n * sizeof(graph));
+    if (!canon) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double best_time = -1.0;
+    for (size_t c = 0; c < sizeof(auto_invariants) / sizeof(auto_invariants[0]); c++) {
+        LabellingSettings settings = cache->settings;
+        Budget budget = cache->budget;
+        settings.invariant = auto_invariants[c];
+        settings.budget = &budget;
+
+        double candidate_time = 0.0;
+        bool aborted = false;
+        for (int i = 0; i < sample && !aborted; i++) {
+            // Candidate loses as soon as it is slower than the best one
+            if (best_time >= 0) {
+                const double remaining = best_time - candidate_time;
+                if (remaining <= 0) {
+                    aborted = true;
+                    break;
+                }
+                if (budget.time <= 0 || remaining < budget.time)
+                    budget.time = remaining;
+            }
+            graph *g = get_graph(graphs, i);
+            candidate_time += canonical_form_nauty(g, canon, n, &settings, &aborted, NULL);
+        }
+        probe_time += candidate_time;
+        if (!aborted && (best_time < 0 || candidate_time < best_time)) {
+            best_time = candidate_time;
+            cache->settings.invariant = auto_invariants[c];
+        }
+    }
+
+    free(canon);
+    return probe_time;
+}
+
+/* Time spent in vertex invariants by labellings of this cache */
+double canonical_cache_invariant_time(const CanonicalCache *cache) {
+    double total_time = 0.0;
+    for (int i = 0; i < cache->count; i++) {
+        const CanonicalEntry *entry = &(cache->entries)[i];
+        if ((entry->certificate || entry->censored) && !entry->stored)
+            total_time += entry->search.invariant_time;
+    }
+    return total_time;
+}
+
+/* Sums statistics of labellings computed by this cache, certificates taken from store have none */
+void canonical_cache_instrumentation(const CanonicalCache *cache, Instrumentation *instrumentation) {
+    for (int i = 0; i < cache->count; i++) {
+        const CanonicalEntry *entry = &(cache->entries)[i];
+        if ((!entry->certificate && !entry->censored) || entry->stored) continue;
+        add_search_stats(instrumentation, &(entry->search));
+        add_counters(&(instrumentation->counters), &(entry->counters));
+    }
+}
+
+void free_canonical_cache(CanonicalCache *cache) {
+    for (int i = 0; i < cache->count; i++) {
+        if (!(cache->entries)[i].stored)
+            free((cache->entries)[i].certificate);
+    }
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->count = 0;
+}
+
+/* FNV-1a style mixing, applied per 64-bit word instead of per byte */
+uint64_t hash_certificate(const void *certificate, const size_t size) {
+    const unsigned char *bytes = certificate;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t k = 0;
+    for (; k + sizeof(uint64_t) <= size; k += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + k, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; k < size; ++k) {
+        hash ^= bytes[k];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* Settings which change certificate, certificates of different variants are never mixed in store */
+uint64_t labelling_variant(const CanonicalCache *cache) {
+    const LabellingSettings *settings = &(cache->settings);
+    // Budget changes engine selected by auto mode
+    const uint64_t engine = cache->engine | (uint64_t)(cache->engine == ENGINE_AUTO && settings->budget) << 7;
+    if (settings->invariant == INVARIANT_NONE) return engine;
+    return engine | (uint64_t)settings->invariant << 8 | (uint64_t)(settings->invar_level & 0xffff) << 16 |
+           (uint64_t)(uint32_t)settings->invar_arg << 32;
+}
+
+bool is_regular(graph *g, const int n, const int m) {
+    int first_degree = -1;
+    for (int v = 0; v < n; v++) {
+        const set *row = GRAPHROW(g, v, m);
+        int degree = 0;
+        for (int k = 0; k < m; k++)
+            degree += POPCOUNT(row[k]);
+        if (first_degree < 0) first_degree = degree;
+        else if (degree != first_degree) return false;
+    }
+    return true;
+}
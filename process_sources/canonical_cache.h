@@ -0,0 +1,49 @@
+#ifndef CANONICAL_CACHE_H
+#define CANONICAL_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nauty.h"
+#include "nauty_isomorphism.h"
+#include "graph_reader.h"
+#include "certificate_store.h"
+#include "instrumentation.h"
+#include "options.h"
+
+typedef struct {
+    void *certificate;  // Canonical form produced by engine, NULL until first requested
+    size_t size;        // Size of certificate in bytes
+    uint64_t hash;      // Hash of certificate
+    Engine engine;      // Engine which produced certificate
+    double time;        // Time spent on canonicalisation
+    bool stored;        // Certificate belongs to certificate store
+    bool censored;      // Canonicalisation exceeded budget, there is no certificate and time is a lower bound
+    SearchStats search;         // Filled only with instrumentation
+    HardwareCounters counters;  // Filled only with instrumentation
+} CanonicalEntry;
+
+typedef struct {
+    CanonicalEntry *entries;
+    int count;
+    int n;
+    int m;
+    Engine engine;      // Requested engine, may be ENGINE_AUTO
+    CertificateStore *store;    // Persistent certificates, NULL if not used
+    Budget budget;
+    LabellingSettings settings; // Budget and invariant shared by all graphs of set
+    bool instrument;            // Collect search statistics and hardware counters
+} CanonicalCache;
+
+void init_canonical_cache(CanonicalCache*, const int, const int, const Options*);
+double select_invariant(CanonicalCache*, const GraphFile*);
+double canonical_cache_invariant_time(const CanonicalCache*);
+void canonical_cache_instrumentation(const CanonicalCache*, Instrumentation*);
+CanonicalEntry* get_canonical_entry(CanonicalCache*, const GraphFile*, const int);
+bool compare_canonical_entries(const CanonicalEntry*, const CanonicalEntry*);
+void compute_certificate(graph*, const int, Engine, const LabellingSettings*, CanonicalEntry*, SearchStats*);
+uint64_t hash_certificate(const void*, const size_t);
+double canonical_cache_time(const CanonicalCache*);
+int canonical_cache_engines(const CanonicalCache*);
+void free_canonical_cache(CanonicalCache*);
+
+#endif
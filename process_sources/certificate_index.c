@@ -0,0 +1,90 @@
+#include "certificate_index.h"
+
+bool same_certificate(const IndexedClass*, const CanonicalEntry*);
+void grow_index(CertificateIndex*);
+
+void init_certificate_index(CertificateIndex *index) {
+    index->count = 0;
+    index->capacity = 64;
+    index->slot_count = 128;
+    index->graphs = 0;
+    index->classes = malloc(index->capacity * sizeof(IndexedClass));
+    index->slots = malloc(index->slot_count * sizeof(int));
+    if (!index->classes || !index->slots) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(index->slots, -1, index->slot_count * sizeof(int));
+}
+
+/* Returns class of graph with given canonical form, adding a new class with a copy of certificate if there is none.
+   seen tells whether class existed before. Entry must not be censored. */
+int index_certificate(CertificateIndex *index, const CanonicalEntry *entry, bool *seen) {
+    index->graphs++;
+    size_t slot = entry->hash & (index->slot_count - 1);
+    while ((index->slots)[slot] >= 0) {
+        IndexedClass *class = &(index->classes)[(index->slots)[slot]];
+        if (same_certificate(class, entry)) {
+            class->graphs++;
+            *seen = true;
+            return (index->slots)[slot];
+        }
+        slot = (slot + 1) & (index->slot_count - 1);
+    }
+
+    *seen = false;
+    IndexedClass class = {malloc(entry->size > 0 ? entry->size : 1), entry->size, entry->hash, entry->engine, 1};
+    if (!class.certificate) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(class.certificate, entry->certificate, entry->size);
+    if (index->count >= index->capacity) {
+        index->capacity *= 2;
+        index->classes = realloc(index->classes, index->capacity * sizeof(IndexedClass));
+        if (!index->classes) {
+            fprintf(stderr, "Error: Memory reallocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (index->classes)[index->count] = class;
+    (index->slots)[slot] = index->count;
+    const int id = index->count++;
+
+    // Load factor is kept at most one half
+    if (2 * (size_t)index->count > index->slot_count) grow_index(index);
+    return id;
+}
+
+/* The same comparison as compare_canonical_entries */
+bool same_certificate(const IndexedClass *class, const CanonicalEntry *entry) {
+    if (class->engine != entry->engine || class->size != entry->size || class->hash != entry->hash) return false;
+    return memcmp(class->certificate, entry->certificate, entry->size) == 0;
+}
+
+void grow_index(CertificateIndex *index) {
+    free(index->slots);
+    index->slot_count *= 2;
+    index->slots = malloc(index->slot_count * sizeof(int));
+    if (!index->slots) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(index->slots, -1, index->slot_count * sizeof(int));
+    for (int id = 0; id < index->count; id++) {
+        size_t slot = (index->classes)[id].hash & (index->slot_count - 1);
+        while ((index->slots)[slot] >= 0)
+            slot = (slot + 1) & (index->slot_count - 1);
+        (index->slots)[slot] = id;
+    }
+}
+
+void free_certificate_index(CertificateIndex *index) {
+    for (int id = 0; id < index->count; id++)
+        free((index->classes)[id].certificate);
+    free(index->classes);
+    free(index->slots);
+    index->classes = NULL;
+    index->slots = NULL;
+    index->count = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef CERTIFICATE_INDEX_H
+#define CERTIFICATE_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "canonical_cache.h"
+
+/* Certificate of the first graph of an isomorphism class */
+typedef struct {
+    void *certificate;
+    size_t size;
+    uint64_t hash;
+    Engine engine;
+    long graphs;        // Number of graphs indexed into class
+} IndexedClass;
+
+/* In-memory index of canonical certificates, classes are numbered in order of insertion */
+typedef struct {
+    IndexedClass *classes;
+    int count;
+    int capacity;
+    int *slots;         // Open addressing over class numbers, -1 if slot is empty
+    size_t slot_count;  // Power of two
+    long graphs;        // Number of graphs indexed
+} CertificateIndex;
+
+void init_certificate_index(CertificateIndex*);
+int index_certificate(CertificateIndex*, const CanonicalEntry*, bool*);
+void free_certificate_index(CertificateIndex*);
+
+#endif
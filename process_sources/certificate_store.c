@@ -0,0 +1,233 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "certificate_store.h"
+
+#define STORE_MAGIC "GISTORE2"
+
+/* Certificates depend on word size of nauty build, so it is a part of header */
+typedef struct {
+    char magic[8];
+    uint32_t wordsize;
+    uint32_t record_size;
+} StoreHeader;
+
+size_t record_length(const uint32_t);
+bool same_graph(const StoreRecord*, const uint64_t, const uint64_t*);
+uint64_t mix_digest(uint64_t);
+void insert_slot(CertificateStore*, const StoreRecord*);
+void write_all(const int, const void*, size_t);
+
+/* Opens or creates store file and indexes its records. Incomplete record at the end,
+   left by an interrupted run, is cut off. */
+void open_certificate_store(const char *filename, CertificateStore *store) {
+    memset(store, 0, sizeof(CertificateStore));
+    pthread_mutex_init(&(store->lock), NULL);
+
+    store->fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (store->fd < 0) {
+        fprintf(stderr, "Error: Unable to open certificate store %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    if (fstat(store->fd, &st) != 0) {
+        fprintf(stderr, "Error: Unable to stat certificate store %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    StoreHeader expected;
+    memcpy(expected.magic, STORE_MAGIC, sizeof(expected.magic));
+    expected.wordsize = WORDSIZE;
+    expected.record_size = sizeof(StoreRecord);
+
+    // New store gets only header
+    if ((size_t)st.st_size < sizeof(StoreHeader)) {
+        if (ftruncate(store->fd, 0) != 0) {
+            fprintf(stderr, "Error: Unable to truncate certificate store %s\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        write_all(store->fd, &expected, sizeof(StoreHeader));
+        return;
+    }
+
+    store->length = st.st_size;
+    store->data = mmap(NULL, store->length, PROT_READ, MAP_SHARED, store->fd, 0);
+    if (store->data == MAP_FAILED) {
+        fprintf(stderr, "Error: Unable to map certificate store %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    if (memcmp(store->data, &expected, sizeof(StoreHeader)) != 0) {
+        fprintf(stderr, "Error: %s is not a certificate store of this build\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Index records
+    size_t pos = sizeof(StoreHeader);
+    while (pos + sizeof(StoreRecord) <= store->length) {
+        const StoreRecord *record = (const StoreRecord*)(store->data + pos);
+        const size_t length = record_length(record->size);
+        if (pos + length > store->length) break;
+        insert_slot(store, record);
+        pos += length;
+    }
+    if (pos != store->length && ftruncate(store->fd, pos) != 0) {
+        fprintf(stderr, "Error: Unable to truncate certificate store %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    lseek(store->fd, pos, SEEK_SET);
+}
+
+/* Key of graph is its input line, so graphs are recognised without decoding them.
+   Variant distinguishes settings which change certificate, like engine and invariant. */
+StoreKey store_key(const char *line, const size_t length, const uint64_t variant) {
+    StoreKey key;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t first = 0x9e3779b97f4a7c15ULL ^ length;
+    uint64_t second = 0xc2b2ae3d27d4eb4fULL ^ variant;
+    for (size_t k = 0; k < length; ++k) {
+        const unsigned char c = line[k];
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+        first = (first ^ c) * 0xff51afd7ed558ccdULL;
+        first ^= first >> 31;
+        second = (second + c) * 0xc4ceb9fe1a85ec53ULL;
+        second = second << 27 | second >> 37;
+    }
+    hash ^= (uint64_t)length << 32 | (variant & 0xffffffffULL);
+    hash *= 0x100000001b3ULL;
+    hash ^= variant >> 32;
+    hash *= 0x100000001b3ULL;
+    hash ^= hash >> 29;
+
+    key.key = hash;
+    key.digest[0] = mix_digest(first ^ variant);
+    key.digest[1] = mix_digest(second ^ length);
+    return key;
+}
+
+/* Record with equal key is taken only if its digest is equal too, otherwise search continues */
+const StoreRecord* find_certificate(CertificateStore *store, const StoreKey *key) {
+    const StoreRecord *result = NULL;
+    pthread_mutex_lock(&(store->lock));
+    if (store->capacity > 0) {
+        for (size_t slot = key->key & (store->capacity - 1); (store->slots)[slot].record; slot = (slot + 1) & (store->capacity - 1)) {
+            if (same_graph((store->slots)[slot].record, key->key, key->digest)) {
+                result = (store->slots)[slot].record;
+                break;
+            }
+        }
+    }
+    if (result) store->hits++;
+    else store->misses++;
+    pthread_mutex_unlock(&(store->lock));
+    return result;
+}
+
+void add_certificate(CertificateStore *store, const StoreKey *key, const void *certificate, const size_t size, Engine engine, const double time) {
+    const size_t length = record_length(size);
+    StoreRecord *record = calloc(1, length);
+    if (!record) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    record->key = key->key;
+    record->digest[0] = key->digest[0];
+    record->digest[1] = key->digest[1];
+    record->size = (uint32_t)size;
+    record->engine = engine;
+    record->time = time;
+    memcpy(record + 1, certificate, size);
+
+    pthread_mutex_lock(&(store->lock));
+    if (store->added_count >= store->added_capacity) {
+        store->added_capacity = store->added_capacity ? 2 * store->added_capacity : 64;
+        store->added = realloc(store->added, store->added_capacity * sizeof(StoreRecord*));
+        if (!store->added) {
+            fprintf(stderr, "Error: Memory reallocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (store->added)[store->added_count++] = record;
+    insert_slot(store, record);
+    write_all(store->fd, record, length);
+    pthread_mutex_unlock(&(store->lock));
+}
+
+/* Makes records written so far durable, called at checkpoints */
+void sync_certificate_store(CertificateStore *store) {
+    pthread_mutex_lock(&(store->lock));
+    fdatasync(store->fd);
+    pthread_mutex_unlock(&(store->lock));
+}
+
+void close_certificate_store(CertificateStore *store) {
+    sync_certificate_store(store);
+    if (store->data) munmap(store->data, store->length);
+    close(store->fd);
+    for (size_t i = 0; i < store->added_count; i++)
+        free((store->added)[i]);
+    free(store->added);
+    free(store->slots);
+    pthread_mutex_destroy(&(store->lock));
+}
+
+size_t record_length(const uint32_t size) {
+    return sizeof(StoreRecord) + (((size_t)size + 7) & ~(size_t)7);
+}
+
+bool same_graph(const StoreRecord *record, const uint64_t key, const uint64_t *digest) {
+    return record->key == key && record->digest[0] == digest[0] && record->digest[1] == digest[1];
+}
+
+/* Final mixing of digest halves, so that every byte of line affects all bits */
+uint64_t mix_digest(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/* Inserts record into index, table is kept at most half full. Called under lock or before threads start. */
+void insert_slot(CertificateStore *store, const StoreRecord *record) {
+    if (2 * (store->count + 1) > store->capacity) {
+        const size_t old_capacity = store->capacity;
+        StoreSlot *old_slots = store->slots;
+        store->capacity = old_capacity ? 2 * old_capacity : 1024;
+        store->slots = calloc(store->capacity, sizeof(StoreSlot));
+        if (!store->slots) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        store->count = 0;
+        for (size_t i = 0; i < old_capacity; i++)
+            if (old_slots[i].record) insert_slot(store, old_slots[i].record);
+        free(old_slots);
+    }
+
+    size_t slot = record->key & (store->capacity - 1);
+    while ((store->slots)[slot].record) {
+        // Same key and digest means same graph and engine, first certificate is kept
+        if (same_graph((store->slots)[slot].record, record->key, record->digest)) return;
+        slot = (slot + 1) & (store->capacity - 1);
+    }
+    (store->slots)[slot].key = record->key;
+    (store->slots)[slot].record = record;
+    store->count++;
+}
+
+void write_all(const int fd, const void *buffer, size_t size) {
+    const char *bytes = buffer;
+    while (size > 0) {
+        const ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            fprintf(stderr, "Error: Unable to write certificate store\n");
+            exit(EXIT_FAILURE);
+        }
+        bytes += written;
+        size -= written;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef CERTIFICATE_STORE_H
+#define CERTIFICATE_STORE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "nauty.h"
+#include "nauty_isomorphism.h"
+
+/* Identity of graph in store. Key places it in index, digest is independent hash checked on lookup,
+   so graphs whose keys collide are not given certificate of each other. */
+typedef struct {
+    uint64_t key;       // Hash of graph6/sparse6 line and labelling settings
+    uint64_t digest[2];
+} StoreKey;
+
+/* Record of store file, certificate bytes follow it, padded to 8 bytes */
+typedef struct {
+    uint64_t key;
+    uint64_t digest[2];
+    uint32_t size;      // Size of certificate in bytes
+    int32_t engine;     // Engine which produced certificate
+    double time;        // Time spent on canonicalisation when certificate was computed
+} StoreRecord;
+
+typedef struct {
+    uint64_t key;
+    const StoreRecord *record;  // Points into mapping or to record added in this run, NULL if slot is empty
+} StoreSlot;
+
+/* Append-only file of canonical certificates. Existing records are used directly from mapping,
+   new ones are appended to file and kept in memory until store is closed. */
+typedef struct {
+    int fd;
+    char *data;                 // Mapped contents of file at opening
+    size_t length;
+    StoreSlot *slots;           // Open addressing index over all records
+    size_t capacity;
+    size_t count;
+    StoreRecord **added;        // Records appended in this run
+    size_t added_count;
+    size_t added_capacity;
+    long hits;
+    long misses;
+    pthread_mutex_t lock;
+} CertificateStore;
+
+void open_certificate_store(const char*, CertificateStore*);
+StoreKey store_key(const char*, const size_t, const uint64_t);
+const StoreRecord* find_certificate(CertificateStore*, const StoreKey*);
+void add_certificate(CertificateStore*, const StoreKey*, const void*, const size_t, Engine, const double);
+void sync_certificate_store(CertificateStore*);
+void close_certificate_store(CertificateStore*);
+
+static inline const void* record_certificate(const StoreRecord *record) {
+    return record + 1;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include "graph_reader.h"
+
+#define CHECKPOINT_MAGIC "GICHECK2"
+
+typedef struct {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t options_hash;
+} CheckpointHeader;
+
+/* Opens or creates checkpoint file and loads records of previous runs */
+void open_checkpoint(const char *filename, const uint64_t options_hash, Checkpoint *checkpoint) {
+    memset(checkpoint, 0, sizeof(Checkpoint));
+    checkpoint->options_hash = options_hash;
+    pthread_mutex_init(&(checkpoint->lock), NULL);
+
+    CheckpointHeader expected;
+    memset(&expected, 0, sizeof(expected));
+    memcpy(expected.magic, CHECKPOINT_MAGIC, sizeof(expected.magic));
+    expected.record_size = sizeof(CheckpointRecord);
+    expected.options_hash = options_hash;
+
+    checkpoint->file = fopen(filename, "r+b");
+    if (!checkpoint->file) {
+        checkpoint->file = fopen(filename, "w+b");
+        if (!checkpoint->file) {
+            fprintf(stderr, "Error: Unable to open checkpoint %s\n", filename);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    CheckpointHeader header;
+    if (fread(&header, sizeof(header), 1, checkpoint->file) != 1) {
+        // Empty or broken file, start from scratch
+        if (ftruncate(fileno(checkpoint->file), 0) != 0) {
+            fprintf(stderr, "Error: Unable to truncate checkpoint %s\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        rewind(checkpoint->file);
+        fwrite(&expected, sizeof(expected), 1, checkpoint->file);
+        fflush(checkpoint->file);
+        return;
+    }
+    if (memcmp(&header, &expected, sizeof(header)) != 0) {
+        fprintf(stderr, "Error: checkpoint %s was written with different options or by different build\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Load complete records, incomplete last record is overwritten by next one
+    int capacity = 16;
+    checkpoint->records = malloc(capacity * sizeof(CheckpointRecord));
+    if (!checkpoint->records) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    CheckpointRecord record;
+    while (fread(&record, sizeof(record), 1, checkpoint->file) == 1) {
+        if (checkpoint->count >= capacity) {
+            capacity *= 2;
+            checkpoint->records = realloc(checkpoint->records, capacity * sizeof(CheckpointRecord));
+            if (!checkpoint->records) {
+                fprintf(stderr, "Error: Memory reallocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        (checkpoint->records)[checkpoint->count++] = record;
+    }
+    const long end = (long)(sizeof(CheckpointHeader) + checkpoint->count * sizeof(CheckpointRecord));
+    if (ftruncate(fileno(checkpoint->file), end) != 0) {
+        fprintf(stderr, "Error: Unable to truncate checkpoint %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    fseek(checkpoint->file, end, SEEK_SET);
+
+    if (checkpoint->count > 0)
+        printf("Checkpoint: %d finished files are restored.\n", checkpoint->count);
+}
+
+/* Identity of file which holds set, of whole dataset if it is packed. Missing file has zero identity. */
+void graph_set_identity(const char *path, const int n, FileIdentity *identity) {
+    char filename[1280];
+    graph_set_filename(path, n, filename, sizeof(filename));
+    memset(identity, 0, sizeof(FileIdentity));
+    struct stat st;
+    if (stat(filename, &st) == 0) {
+        identity->size = st.st_size;
+        identity->mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    }
+}
+
+const CheckpointRecord* find_checkpoint_record(const Checkpoint *checkpoint, const bool is_isomorphic, const int n, const FileIdentity *identity) {
+    for (int i = 0; i < checkpoint->count; i++) {
+        const CheckpointRecord *record = &(checkpoint->records)[i];
+        if (record->is_isomorphic == is_isomorphic && record->n == n
+            && record->file.size == identity->size && record->file.mtime == identity->mtime)
+            return record;
+    }
+    return NULL;
+}
+
+/* Appends record and flushes it to disk, so it survives interruption of the run */
+void save_checkpoint_record(Checkpoint *checkpoint, const CheckpointRecord *record) {
+    pthread_mutex_lock(&(checkpoint->lock));
+    if (fwrite(record, sizeof(CheckpointRecord), 1, checkpoint->file) != 1) {
+        fprintf(stderr, "Error: Unable to write checkpoint\n");
+        exit(EXIT_FAILURE);
+    }
+    fflush(checkpoint->file);
+    fdatasync(fileno(checkpoint->file));
+    pthread_mutex_unlock(&(checkpoint->lock));
+}
+
+void close_checkpoint(Checkpoint *checkpoint) {
+    fclose(checkpoint->file);
+    free(checkpoint->records);
+    pthread_mutex_destroy(&(checkpoint->lock));
+}
@@ -0,0 +1,42 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "result_struct.h"
+
+/* Size and modification time of graph file, record of a file changed since is not restored */
+typedef struct {
+    int64_t size;
+    int64_t mtime;
+} FileIdentity;
+
+/* Result of one finished <n>.g6 file */
+typedef struct {
+    int is_isomorphic;
+    int n;
+    FileIdentity file;
+    double time;
+    Statistics stats;
+    SetReport report;
+} CheckpointRecord;
+
+/* Append-only log of finished files. Run with the same checkpoint restores them instead of processing again. */
+typedef struct {
+    FILE *file;
+    CheckpointRecord *records;  // Records written by previous runs
+    int count;
+    uint64_t options_hash;      // Options which affect results, checkpoint of other options is rejected
+    pthread_mutex_t lock;
+} Checkpoint;
+
+void open_checkpoint(const char*, const uint64_t, Checkpoint*);
+void graph_set_identity(const char*, const int, FileIdentity*);
+const CheckpointRecord* find_checkpoint_record(const Checkpoint*, const bool, const int, const FileIdentity*);
+void save_checkpoint_record(Checkpoint*, const CheckpointRecord*);
+void close_checkpoint(Checkpoint*);
+
+#endif
@@ -0,0 +1,138 @@
+#include "classifier.h"
+
+// Graphs canonicalised by one task in multi-threaded mode
+#define CLASSIFY_CHUNK 64
+
+typedef struct {
+    CanonicalCache *cache;
+    const GraphFile *graphs;
+    int start;
+    int end;
+    atomic_int *remaining;
+} ClassifyTask;
+
+bool single_order(const GraphFile*);
+void canonicalise_chunk(void*);
+void assign_classes(CanonicalCache*, const GraphFile*, IsoClasses*);
+
+/* Splits graphs of file into isomorphism classes. Each graph is canonicalised once, in parallel with --threads,
+   and graphs are grouped by a hash table of certificates, so only graphs with equal hashes are compared.
+   Graphs of different orders may be mixed in one file, their certificates never match. */
+void classify_graphs(const GraphFile *graphs, const Options *options, IsoClasses *classes) {
+    const double start = monotonic_time();
+    const int count = graphs->count;
+
+    CanonicalCache cache;
+    init_canonical_cache(&cache, count, count > 0 ? graph_file_order(graphs, 0) : 0, options);
+    // Auto invariant is chosen on a sample, which is meaningful only when all graphs have the same order
+    if (options->invariant == INVARIANT_AUTO && single_order(graphs))
+        select_invariant(&cache, graphs);
+
+    canonicalise_all(&cache, graphs, options);
+
+    classes->count = count;
+    classes->class_ids = malloc((count > 0 ? count : 1) * sizeof(int));
+    classes->class_sizes = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!classes->class_ids || !classes->class_sizes) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    assign_classes(&cache, graphs, classes);
+    classes->time = canonical_cache_time(&cache);
+
+    free_canonical_cache(&cache);
+    classes->wall_time = monotonic_time() - start;
+}
+
+bool single_order(const GraphFile *graphs) {
+    for (int i = 1; i < graphs->count; i++) {
+        if (graph_file_order(graphs, i) != graph_file_order(graphs, 0)) return false;
+    }
+    return true;
+}
+
+/* Canonicalises every graph of file, with --threads by chunks of graphs in work-stealing pool */
+void canonicalise_all(CanonicalCache *cache, const GraphFile *graphs, const Options *options) {
+    if (options->threads <= 1 || graphs->count < 2 * CLASSIFY_CHUNK) {
+        for (int i = 0; i < graphs->count; i++)
+            get_canonical_entry(cache, graphs, i);
+        return;
+    }
+
+    ThreadPool pool;
+    init_thread_pool(&pool, options->threads, options->pin);
+
+    const int task_count = (graphs->count + CLASSIFY_CHUNK - 1) / CLASSIFY_CHUNK;
+    ClassifyTask *tasks = malloc(task_count * sizeof(ClassifyTask));
+    if (!tasks) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_int remaining;
+    atomic_init(&remaining, task_count);
+    for (int t = 0; t < task_count; t++) {
+        const int end = (t + 1) * CLASSIFY_CHUNK;
+        ClassifyTask task = {cache, graphs, t * CLASSIFY_CHUNK, end < graphs->count ? end : graphs->count, &remaining};
+        tasks[t] = task;
+        inject_task(&pool, canonicalise_chunk, &tasks[t]);
+    }
+    wait_for_tasks(&pool, &remaining, true);
+
+    free_thread_pool(&pool);
+    free(tasks);
+}
+
+void canonicalise_chunk(void *data) {
+    ClassifyTask *task = data;
+    for (int i = task->start; i < task->end; i++)
+        get_canonical_entry(task->cache, task->graphs, i);
+    atomic_fetch_sub(task->remaining, 1);
+}
+
+/* Open addressing table keyed by certificate hash, each slot holds the first graph of its class */
+void assign_classes(CanonicalCache *cache, const GraphFile *graphs, IsoClasses *classes) {
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)graphs->count)
+        capacity *= 2;
+    int *slots = malloc(capacity * sizeof(int));
+    if (!slots) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(slots, -1, capacity * sizeof(int));
+
+    classes->class_count = 0;
+    classes->censored = 0;
+    for (int i = 0; i < graphs->count; i++) {
+        const CanonicalEntry *entry = get_canonical_entry(cache, graphs, i);
+        if (entry->censored) {
+            (classes->class_ids)[i] = -1;
+            classes->censored++;
+            continue;
+        }
+
+        size_t slot = entry->hash & (capacity - 1);
+        while (slots[slot] >= 0 && !compare_canonical_entries(&(cache->entries)[slots[slot]], entry))
+            slot = (slot + 1) & (capacity - 1);
+
+        if (slots[slot] < 0) {
+            slots[slot] = i;
+            (classes->class_sizes)[classes->class_count] = 0;
+            (classes->class_ids)[i] = classes->class_count++;
+        } else {
+            (classes->class_ids)[i] = (classes->class_ids)[slots[slot]];
+        }
+        (classes->class_sizes)[(classes->class_ids)[i]]++;
+    }
+
+    free(slots);
+}
+
+void free_iso_classes(IsoClasses *classes) {
+    free(classes->class_ids);
+    free(classes->class_sizes);
+    classes->class_ids = NULL;
+    classes->class_sizes = NULL;
+    classes->count = 0;
+    classes->class_count = 0;
+}
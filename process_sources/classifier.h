@@ -0,0 +1,30 @@
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "graph_reader.h"
+#include "canonical_cache.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+/* Partition of graphs of one file into isomorphism classes */
+typedef struct {
+    int *class_ids;     // Class of each graph, classes are numbered by their first graph, -1 if graph was censored
+    int *class_sizes;   // Number of graphs in each class
+    int count;          // Number of graphs
+    int class_count;
+    int censored;       // Graphs whose canonicalisation exceeded budget, they belong to no class
+    double time;        // Total time of canonicalisations
+    double wall_time;   // Wall-clock time of whole classification
+} IsoClasses;
+
+void classify_graphs(const GraphFile*, const Options*, IsoClasses*);
+void canonicalise_all(CanonicalCache*, const GraphFile*, const Options*);
+void free_iso_classes(IsoClasses*);
+
+#endif
@@ -1,43 +1,18 @@
 #include "file_processor.h"
 
-int create_directories(const char *path);
+int compare_nodes(const void*, const void*);
 
-void read_all_graphs_from_file(const char *filename, graph ***graphs, int *count) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Unable to open file %s\n", filename);
-        exit(EXIT_FAILURE);
-    }
-
-    int capacity = 10;
-    *graphs = malloc(capacity * sizeof(graph *));
-    if (!*graphs) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        fclose(file);
-        exit(EXIT_FAILURE);
-    }
-
-    *count = 0;
-    graph *g = NULL;
-    int reqm = 0, m, n;
-    while ((g = readg(file, NULL, reqm, &m, &n)) != NULL) {
-        if (*count >= capacity) {
-            capacity *= 2;
-            *graphs = realloc(*graphs, capacity * sizeof(graph*));
-            if (!*graphs) {
-                fprintf(stderr, "Error: Memory reallocation failed\n");
-                fclose(file);
-                exit(EXIT_FAILURE);
-            }
-        }
-        (*graphs)[*count] = g;
-        (*count)++;
-    }
-
-    fclose(file);
+/* Sets of directory, from its packed dataset if it has one */
+void read_filenames(const char* path, Result *result) {
+    char packed[1280];
+    if (packed_dataset_path(path, packed, sizeof(packed)))
+        result->count = read_packed_orders(packed, &(result->nodes));
+    else
+        list_graph_files(path, result);
 }
 
-void read_filenames(const char* path, Result *result) {
+/* <n>.g6 files of directory. Files are ordered by n, so results do not depend on order of directory entries. */
+void list_graph_files(const char* path, Result *result) {
     // Open directory
     DIR* dir = opendir(path);
     if (!dir) {
@@ -88,41 +63,42 @@ void read_filenames(const char* path, Result *result) {
     }
 
     closedir(dir);
+    qsort(ids, size, sizeof(int), compare_nodes);
     result->count = size;
     result->nodes = ids;
 }
 
-void write_to_csv(const char *filename, Result *result_i, Result *result_ni, bool only_isomorphic) {
-    // Create directories
-    char *dir = strdup(filename);
-    char *last_slash = strrchr(dir, '/');
-    if (last_slash) {
-        *last_slash = '\0'; // Truncate to get the directory path
-        if (create_directories(dir) != 0)
-            fprintf(stderr, "Failed to create directories for: %s\n", dir);
-    } else {
-        printf("No directory part in filename.\n");
-    }
-    free(dir);
+int compare_nodes(const void *a, const void *b) {
+    const int n1 = *(const int*)a;
+    const int n2 = *(const int*)b;
+    return (n1 > n2) - (n1 < n2);
+}
 
-    // Write to file
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        perror("Error opening file");
-        return;
-    }
+/* Directory with graph files of one kind, false if dataset has none. Dataset without subdirectories is isomorphic. */
+bool dataset_directory(const char *dataset_path, const bool is_isomorphic, char *path, const size_t size) {
+    snprintf(path, size, "%s%s", dataset_path, is_isomorphic ? "isomorphic/" : "non_isomorphic/");
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+        return true;
+    if (!is_isomorphic)
+        return false;
+    snprintf(path, size, "%s", dataset_path);
+    return true;
+}
 
-    // Write CSV header
-    fprintf(file, "node_count,average_time,is_isomorphic\n");
+void write_to_csv(const char *filename, Result *result_i, Result *result_ni, bool only_isomorphic) {
+    FILE *file = open_output_file(filename);
+    if (!file) return;
+    write_csv_header(file);
 
     // Write data for result_i (is_isomorphic = true) and result_ni (is_isomorphic = false)
     for (int i = 0; i < result_i->count; i++) {
-        fprintf(file, "%d,%f,true\n", (result_i->nodes)[i], (result_i->time)[i]);
+        write_csv_row(file, result_i, i, true);
     }
 
     if (!only_isomorphic) {
         for (int i = 0; i < result_ni->count; i++) {
-             fprintf(file, "%d,%f,false\n", (result_ni->nodes)[i], (result_ni->time)[i]);
+             write_csv_row(file, result_ni, i, false);
         }
     }
 
@@ -130,6 +106,151 @@ void write_to_csv(const char *filename, Result *result_i, Result *result_ni, boo
     printf("Data written to %s successfully.\n", filename);
 }
 
+void write_csv_row(FILE *file, Result *result, const int i, bool is_isomorphic) {
+    const SetReport *report = &(result->reports)[i];
+    char engines[64];
+    format_engines(report->engines, engines, sizeof(engines));
+    const Statistics *stats = &(result->stats)[i];
+
+    // Statistics are printed with %g, as small graphs take less than a microsecond
+    fprintf(file, "%d,%f,%s,%s,%g,%g,%g,%g,%g,%g,%d", (result->nodes)[i], (result->time)[i],
+            is_isomorphic ? "true" : "false", engines, stats->min, stats->median, stats->p90, stats->p99,
+            stats->stddev, stats->median_wall, stats->repetitions);
+
+    // Prefilter stages, all zero if prefilter was not used
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+        fprintf(file, ",%ld,%g", report->filter.resolved[stage], report->filter.time[stage]);
+    fprintf(file, ",%ld", report->filter.resolved[STAGE_COUNT]);
+
+    // Checks aborted by budget, average time of such set is only a lower bound
+    fprintf(file, ",%ld", report->censored);
+
+    // Invariant time is included in average time
+    fprintf(file, ",%s,%g", invariant_name(report->invariant), report->invariant_time);
+
+    // Checks decided by special solvers, all zero if they were not used
+    for (int solver = 0; solver < SOLVER_COUNT; solver++)
+        fprintf(file, ",%ld", report->solved[solver]);
+
+    // Scratch memory of the last repetition, blocks are those which arena had to take from malloc
+    fprintf(file, ",%ld,%zu,%zu,%ld", report->arena.allocations, report->arena.bytes, report->arena.peak,
+            report->arena.blocks);
+    fprintf(file, "\n");
+}
+
+void write_csv_header(FILE *file) {
+    fprintf(file, "node_count,average_time,is_isomorphic,engine,"
+                  "min_time,median_time,p90_time,p99_time,stddev_time,median_wall_time,repetitions");
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+        fprintf(file, ",resolved_%s,time_%s", filter_stage_name(stage), filter_stage_name(stage));
+    fprintf(file, ",unresolved,censored,invariant,invariant_time");
+    for (int solver = 0; solver < SOLVER_COUNT; solver++)
+        fprintf(file, ",solved_%s", solver_name(solver));
+    fprintf(file, ",arena_allocations,arena_bytes,arena_peak,arena_blocks\n");
+}
+
+/* Writes search statistics and hardware counters of each set as CSV, or as JSON lines if filename ends with .jsonl */
+void write_instrumentation(const char *filename, Result *result_i, Result *result_ni, bool only_isomorphic) {
+    FILE *file = open_output_file(filename);
+    if (!file) return;
+
+    const bool jsonl = is_jsonl_file(filename);
+    write_instrumentation_header(file, jsonl);
+
+    for (int i = 0; i < result_i->count; i++)
+        write_instrumentation_row(file, result_i, i, true, jsonl);
+    if (!only_isomorphic) {
+        for (int i = 0; i < result_ni->count; i++)
+            write_instrumentation_row(file, result_ni, i, false, jsonl);
+    }
+
+    fclose(file);
+    printf("Instrumentation written to %s successfully.\n", filename);
+}
+
+bool is_jsonl_file(const char *filename) {
+    const size_t len = strlen(filename);
+    return len >= 6 && strcmp(filename + len - 6, ".jsonl") == 0;
+}
+
+/* JSON lines have no header */
+void write_instrumentation_header(FILE *file, bool jsonl) {
+    if (jsonl) return;
+    fprintf(file, "node_count,is_isomorphic,average_time,labellings,mean_nodes,max_nodes,mean_bad_leaves,"
+                  "max_level,mean_log10_group_size,mean_orbits");
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        fprintf(file, ",%s", counter_name(c));
+    fprintf(file, ",peak_rss_kb\n");
+}
+
+void write_instrumentation_row(FILE *file, Result *result, const int i, bool is_isomorphic, bool jsonl) {
+    const Instrumentation *instrumentation = &(result->reports)[i].instrumentation;
+    const double labellings = instrumentation->labellings > 0 ? (double)instrumentation->labellings : 1.0;
+
+    // Means are over canonical labellings of the last repetition, counters are their sums
+    if (jsonl) {
+        fprintf(file, "{\"node_count\": %d, \"is_isomorphic\": %s, \"average_time\": %g, \"labellings\": %ld, "
+                      "\"mean_nodes\": %g, \"max_nodes\": %lu, \"mean_bad_leaves\": %g, \"max_level\": %d, "
+                      "\"mean_log10_group_size\": %g, \"mean_orbits\": %g",
+                (result->nodes)[i], is_isomorphic ? "true" : "false", (result->time)[i], instrumentation->labellings,
+                instrumentation->nodes / labellings, instrumentation->max_nodes, instrumentation->bad_leaves / labellings,
+                instrumentation->max_level, instrumentation->log10_group_size / labellings, instrumentation->orbits / labellings);
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            if (instrumentation->counters.values[c] < 0)
+                fprintf(file, ", \"%s\": null", counter_name(c));
+            else
+                fprintf(file, ", \"%s\": %lld", counter_name(c), instrumentation->counters.values[c]);
+        }
+        fprintf(file, ", \"peak_rss_kb\": %ld}\n", instrumentation->peak_rss_kb);
+        return;
+    }
+
+    fprintf(file, "%d,%s,%g,%ld,%g,%lu,%g,%d,%g,%g", (result->nodes)[i], is_isomorphic ? "true" : "false",
+            (result->time)[i], instrumentation->labellings, instrumentation->nodes / labellings, instrumentation->max_nodes,
+            instrumentation->bad_leaves / labellings, instrumentation->max_level,
+            instrumentation->log10_group_size / labellings, instrumentation->orbits / labellings);
+    // Unavailable counters are left empty
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        if (instrumentation->counters.values[c] < 0)
+            fprintf(file, ",");
+        else
+            fprintf(file, ",%lld", instrumentation->counters.values[c]);
+    }
+    fprintf(file, ",%ld\n", instrumentation->peak_rss_kb);
+}
+
+/* One row per graph of classified file, censored graphs have class -1 */
+void write_classes(const char *filename, const IsoClasses *classes) {
+    FILE *file = open_output_file(filename);
+    if (!file) return;
+
+    fprintf(file, "graph,class,class_size\n");
+    for (int i = 0; i < classes->count; i++) {
+        const int class_id = (classes->class_ids)[i];
+        fprintf(file, "%d,%d,%d\n", i, class_id, class_id >= 0 ? (classes->class_sizes)[class_id] : 0);
+    }
+
+    fclose(file);
+    printf("Data written to %s successfully.\n", filename);
+}
+
+/* Creates directories of filename and opens it for writing */
+FILE* open_output_file(const char *filename) {
+    char *dir = strdup(filename);
+    char *last_slash = strrchr(dir, '/');
+    if (last_slash) {
+        *last_slash = '\0'; // Truncate to get the directory path
+        if (create_directories(dir) != 0)
+            fprintf(stderr, "Failed to create directories for: %s\n", dir);
+    }
+    free(dir);
+
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+        perror("Error opening file");
+    return file;
+}
+
 int create_directories(const char *path) {
     char *tmp = strdup(path); // Duplicate the path to modify it
     char *p = NULL;
@@ -7,9 +7,22 @@
 #include <stdio.h>
 #include "gtools.h"
 #include "result_struct.h"
+#include "nauty_isomorphism.h"
+#include "classifier.h"
+#include "packed_dataset.h"
 
-void read_all_graphs_from_file(const char*, graph***, int*);
 void read_filenames(const char*, Result*);
+void list_graph_files(const char*, Result*);
+bool dataset_directory(const char*, const bool, char*, const size_t);
 void write_to_csv(const char*, Result*, Result*, bool);
+void write_csv_header(FILE*);
+void write_csv_row(FILE*, Result*, const int, bool);
+void write_instrumentation(const char*, Result*, Result*, bool);
+bool is_jsonl_file(const char*);
+void write_instrumentation_header(FILE*, bool);
+void write_instrumentation_row(FILE*, Result*, const int, bool, bool);
+void write_classes(const char*, const IsoClasses*);
+FILE* open_output_file(const char*);
+int create_directories(const char*);
 
 #endif
@@ -1,16 +1,48 @@
 #include "graph_processor.h"
 
-double process_graph_set(graph**, const int, const int, bool, bool);
-bool try_tree_optimization(graph*, graph*, const int, bool, double*);
-void free_graphs(graph**, const int);
+// Sets with at least this many graphs are canonicalised by several tasks in multi-threaded mode
+#define PARALLEL_SET_MIN 4
 
-void process_graphs(const char *path, const bool is_isomorphic, Result *result, bool opt_tree) {
+typedef struct {
+    const char *path;
+    int index;              // Index of file in result
+    bool is_isomorphic;
+    Result *result;
+    const Options *options;
+    ThreadPool *pool;       // NULL in single-threaded mode
+    atomic_int *remaining;  // Counter of unfinished files, NULL in single-threaded mode
+    GraphFile *prefetched;  // File mapped by prefetching reader, NULL if task opens file itself
+} FileTask;
+
+typedef struct {
+    CanonicalCache *cache;
+    const GraphFile *graphs;
+    int index;
+    atomic_int *remaining;
+} CanonicalTask;
+
+void process_files_parallel(const char*, const bool, Result*, const Options*);
+void process_files_prefetched(const char*, const bool, Result*, const Options*);
+void process_file(void*);
+const CheckpointRecord* options_checkpoint_record(const Options*, const char*, const bool, const int, FileIdentity*);
+void canonicalise_graph(void*);
+int compare_file_tasks(const void*, const void*);
+double process_graph_set(const GraphFile*, const int, const int, bool, const Options*, ThreadPool*, SetReport*);
+double compare_canonical_forms(CanonicalCache*, const GraphFile*, const int, const int, bool, SetReport*);
+double compare_by_matching(MatchCache*, const GraphFile*, const int, const int, bool, SetReport*);
+void check_expected_result(const int, bool, bool);
+
+void process_graphs(const char *path, const bool is_isomorphic, Result *result, const Options *options) {
     // Fills result->count and result->nodes
     read_filenames(path, result);
+    if (options->shard)
+        filter_shard_files(options->shard, is_isomorphic, result);
 
-    // Time result allocation
+    // Time, statistics and report result allocation
     result->time = malloc((result->count) * sizeof(double));
-    if (!(result->time)) {
+    result->stats = calloc(result->count, sizeof(Statistics));
+    result->reports = calloc(result->count, sizeof(SetReport));
+    if (!(result->time) || !(result->stats) || !(result->reports)) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         exit(EXIT_FAILURE);
     }
@@ -19,90 +51,304 @@ void process_graphs(const char *path, const bool is_isomorphic, Result *result,
         (result->time)[i] = 0;
 
     // Read and process each file
+    if (options->threads > 1) {
+        process_files_parallel(path, is_isomorphic, result, options);
+    } else if (options->prefetch > 0) {
+        process_files_prefetched(path, is_isomorphic, result, options);
+    } else {
+        for (int i = 0; i < result->count; i++) {
+            FileTask task = {path, i, is_isomorphic, result, options, NULL, NULL, NULL};
+            process_file(&task);
+        }
+    }
+
+    printf("%s graphs are processed.\n", is_isomorphic ? "Isomorphic" : "Non-isomorphic");
+}
+
+/* Each file is a task of work-stealing pool. Larger graphs are scheduled first, so they do not form a long tail. */
+void process_files_parallel(const char *path, const bool is_isomorphic, Result *result, const Options *options) {
+    ThreadPool pool;
+    init_thread_pool(&pool, options->threads, options->pin);
+
+    atomic_int remaining;
+    atomic_init(&remaining, result->count);
+
+    FileTask *tasks = malloc(result->count * sizeof(FileTask));
+    if (!tasks) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
     for (int i = 0; i < result->count; i++) {
-        graph **graphs;
-        int graph_count;
+        FileTask task = {path, i, is_isomorphic, result, options, &pool, &remaining, NULL};
+        tasks[i] = task;
+    }
+    qsort(tasks, result->count, sizeof(FileTask), compare_file_tasks);
 
-        // Read
-        char filename[512];
-        snprintf(filename, sizeof(filename), "%s%d.g6", path, (result->nodes)[i]);
-        read_all_graphs_from_file(filename, &graphs, &graph_count);
+    for (int i = 0; i < result->count; i++)
+        inject_task(&pool, process_file, &tasks[i]);
+    wait_for_tasks(&pool, &remaining, true);
 
-        // Process graph set
-        const double time = process_graph_set(graphs, graph_count, (result->nodes)[i], is_isomorphic, opt_tree);
-        (result->time)[i] = time;
+    free_thread_pool(&pool);
+    free(tasks);
+}
 
-        // Free
-        free_graphs(graphs, graph_count);
+/* Reader thread maps and indexes following files while current one is processed, so I/O overlaps with computation */
+void process_files_prefetched(const char *path, const bool is_isomorphic, Result *result, const Options *options) {
+    PrefetchReader reader;
+    start_prefetch_reader(&reader, path, is_isomorphic, result, options);
+    for (int i = 0; i < result->count; i++) {
+        FileTask task = {path, i, is_isomorphic, result, options, NULL, NULL, take_prefetched_file(&reader)};
+        process_file(&task);
+        release_prefetched_file(&reader);
     }
+    stop_prefetch_reader(&reader);
+    print_prefetch_counters(&(reader.counters), options->prefetch, is_isomorphic);
+}
 
-    printf("%s graphs are processed.\n", is_isomorphic ? "Isomorphic" : "Non-isomorphic");
+void process_file(void *data) {
+    FileTask *task = data;
+    Result *result = task->result;
+    const int n = (result->nodes)[task->index];
+
+    // Files finished by previous run are restored from checkpoint, unless they changed since
+    FileIdentity identity;
+    const CheckpointRecord *restored = options_checkpoint_record(task->options, task->path, task->is_isomorphic, n, &identity);
+    if (restored) {
+        (result->time)[task->index] = restored->time;
+        (result->stats)[task->index] = restored->stats;
+        (result->reports)[task->index] = restored->report;
+        if (task->remaining)
+            atomic_fetch_sub(task->remaining, 1);
+        return;
+    }
+
+    GraphFile own_graphs;
+    GraphFile *graphs = task->prefetched;
+
+    // Map and index file, graphs are decoded only when needed
+    if (!graphs) {
+        open_graph_set(task->path, n, &own_graphs);
+        graphs = &own_graphs;
+    }
+
+    // Isomorphic set is replaced by first graph of file and its relabellings generated in memory
+    GraphFile relabelled;
+    const bool relabel = task->options->relabel > 0 && task->is_isomorphic;
+    if (relabel) {
+        relabel_graph_set(graphs, n, task->options->relabel, task->options->seed, &relabelled);
+        graphs = &relabelled;
+    }
+
+    // Process graph set, peak RSS is process-wide, so with several threads it covers concurrent files too
+    if (task->options->instrument)
+        reset_peak_rss();
+    benchmark_graph_set(graphs, graphs->count, n, task->is_isomorphic, task->options,
+                        task->pool, &(result->reports)[task->index], &(result->stats)[task->index]);
+    (result->time)[task->index] = (result->stats)[task->index].mean;
+    if (task->options->instrument)
+        (result->reports)[task->index].instrumentation.peak_rss_kb = peak_rss_kb();
+
+    // Free, prefetched file is released by reader
+    if (relabel)
+        close_relabelled_set(&relabelled);
+    if (!task->prefetched)
+        close_graph_file(&own_graphs);
+
+    // Checkpoint after certificates of the file are on disk
+    if (task->options->checkpoint) {
+        if (task->options->store)
+            sync_certificate_store(task->options->store);
+        CheckpointRecord record;
+        memset(&record, 0, sizeof(record));
+        record.is_isomorphic = task->is_isomorphic;
+        record.n = n;
+        record.file = identity;
+        record.time = (result->time)[task->index];
+        record.stats = (result->stats)[task->index];
+        record.report = (result->reports)[task->index];
+        save_checkpoint_record(task->options->checkpoint, &record);
+    }
+
+    if (task->remaining)
+        atomic_fetch_sub(task->remaining, 1);
 }
 
-double process_graph_set(graph **graphs, const int graph_count, const int n, bool is_isomorphic, bool opt_tree_flag) {
-    double total_time = 0.0;  // Total time for isomorphism checks
-    int num_checks = 0;       // Number of comparisons made
-    for (int i = 0; i < graph_count; i++) {
-        for (int j = i + 1; j < graph_count; j++) {
-            // Try optimization for trees, if flag --opt_tree was set
-            bool opt_tree_success = opt_tree_flag ? try_tree_optimization(graphs[i], graphs[j], n, is_isomorphic, &total_time) : false;
+/* Identity of graph file is taken before processing, so file changed during run is not recorded as finished */
+const CheckpointRecord* options_checkpoint_record(const Options *options, const char *path, const bool is_isomorphic, const int n,
+                                                  FileIdentity *identity) {
+    if (!options->checkpoint) return NULL;
+    graph_set_identity(path, n, identity);
+    return find_checkpoint_record(options->checkpoint, is_isomorphic, n, identity);
+}
 
-            // If no optimization successed, then run common nauty algorithm
-            if (!opt_tree_success) {
-                total_time += check_isomorphism_nauty(graphs[i], graphs[j], n, is_isomorphic);
-            }
+/* Runs graph set warmup + repetitions times, only repetitions are measured. Samples are average time per check.
+   Report is filled by the last repetition. */
+void benchmark_graph_set(const GraphFile *graphs, const int graph_count, const int n, bool is_isomorphic, const Options *options,
+                         ThreadPool *pool, SetReport *report, Statistics *stats) {
+    for (int r = 0; r < options->warmup; r++)
+        process_graph_set(graphs, graph_count, n, is_isomorphic, options, pool, report);
 
-            num_checks++;
-        }
+    double *cpu_samples = malloc(options->repetitions * sizeof(double));
+    double *wall_samples = malloc(options->repetitions * sizeof(double));
+    if (!cpu_samples || !wall_samples) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
     }
 
-    return total_time / num_checks;
+    const int num_checks = graph_count * (graph_count - 1) / 2;
+    for (int r = 0; r < options->repetitions; r++) {
+        const double wall_start = monotonic_time();
+        cpu_samples[r] = process_graph_set(graphs, graph_count, n, is_isomorphic, options, pool, report);
+        wall_samples[r] = (monotonic_time() - wall_start) / num_checks;
+    }
+
+    compute_statistics(cpu_samples, wall_samples, options->repetitions, stats);
+    free(cpu_samples);
+    free(wall_samples);
 }
 
-bool try_tree_optimization(graph *graph1, graph *graph2, const int n, bool should_be_isomorphic, double *total_time) {
-    // Check if first graph is a tree
-    myGraph *my_graph1 = convert_nauty_to_mygraph(graph1, n);
+void canonicalise_graph(void *data) {
+    CanonicalTask *task = data;
+    get_canonical_entry(task->cache, task->graphs, task->index);
+    atomic_fetch_sub(task->remaining, 1);
+}
 
-    const clock_t first_tree_check_start = clock();
-    bool is_tree_first = is_tree(my_graph1);
-    const clock_t first_tree_check_end = clock();
+/* Descending order by node count */
+int compare_file_tasks(const void *a, const void *b) {
+    const FileTask *task1 = a;
+    const FileTask *task2 = b;
+    const int n1 = (task1->result->nodes)[task1->index];
+    const int n2 = (task2->result->nodes)[task2->index];
+    return (n1 < n2) - (n1 > n2);
+}
 
-    *total_time += (double)(first_tree_check_end - first_tree_check_start) / CLOCKS_PER_SEC;
-    if (!is_tree_first) return false;
+double process_graph_set(const GraphFile *graphs, const int graph_count, const int n, bool is_isomorphic, const Options *options, ThreadPool *pool, SetReport *report) {
+    double total_time = 0.0;  // Total time for isomorphism checks
+    int num_checks = 0;       // Number of comparisons made
 
-    // Check if second graph is a tree
-    myGraph *my_graph2 = convert_nauty_to_mygraph(graph2, n);
+    // Scratch memory of the set is allocated from arena of this thread and released at once when set ends
+    Arena *arena = thread_arena();
+    const ArenaMark arena_start = begin_arena_set(arena);
 
-    const clock_t second_tree_check_start = clock();
-    bool is_tree_second = is_tree(my_graph2);
-    const clock_t second_tree_check_end = clock();
+    // Each graph is canonicalised at most once, pairs only compare cached certificates
+    CanonicalCache cache;
+    init_canonical_cache(&cache, graph_count, n, options);
+    if (options->invariant == INVARIANT_AUTO)
+        total_time += select_invariant(&cache, graphs);
 
-    *total_time += (double)(second_tree_check_end - second_tree_check_start) / CLOCKS_PER_SEC;
-    if (!is_tree_second) return false;
+    // vf2pp engine matches pairs directly, graphs are only prepared once
+    const bool matching = options->engine == ENGINE_VF2PP;
+    MatchCache matches;
+    init_match_cache(&matches, matching ? graph_count : 0, &(options->budget));
 
-    // Run tree isomorphism algorithm
-    const clock_t isomorphism_check_start = clock();
-    bool result = check_isomorphism_tree(my_graph1, my_graph2);
-    const clock_t isomorphism_check_end = clock();
+    // Invariants for prefilter are computed lazily too
+    InvariantCache invariants;
+    init_invariant_cache(&invariants, options->prefilter ? graph_count : 0, n);
+    memset(&(report->filter), 0, sizeof(FilterStats));
+    report->censored = 0;
 
-    *total_time += (double)(isomorphism_check_end - isomorphism_check_start) / CLOCKS_PER_SEC;
+    // Each graph is recognised by special solvers at most once, on its sparse form
+    SolverCache solvers;
+    init_solver_cache(&solvers, graph_count, n, options->solvers);
+    memset(report->solved, 0, sizeof(report->solved));
 
-    // Check for error
-    if (result != should_be_isomorphic) {
-        printf("Error: graphs with n=%d vertexes should be is_isomorphic=%hhd but was is_isomorphic=%hhd\n", n, should_be_isomorphic, result);
-        exit(EXIT_FAILURE);
+    // In multi-threaded mode canonicalise large sets in parallel beforehand.
+    // Special solvers and prefilter canonicalise lazily, only graphs which they cannot decide.
+    if (pool && !matching && !options->solvers && !options->prefilter && graph_count >= PARALLEL_SET_MIN) {
+        CanonicalTask *tasks = malloc(graph_count * sizeof(CanonicalTask));
+        if (!tasks) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        atomic_int remaining;
+        atomic_init(&remaining, graph_count);
+        for (int i = 0; i < graph_count; i++) {
+            CanonicalTask task = {&cache, graphs, i, &remaining};
+            tasks[i] = task;
+            submit_task(pool, canonicalise_graph, &tasks[i]);
+        }
+        wait_for_tasks(pool, &remaining, false);
+        free(tasks);
     }
 
-    // Free memory
-    free_mygraph(my_graph1);
-    free_mygraph(my_graph2);
+    for (int i = 0; i < graph_count; i++) {
+        for (int j = i + 1; j < graph_count; j++) {
+            num_checks++;
 
-    return true;
+            // Reject pair by invariants, if flag --prefilter was set
+            if (options->prefilter && filter_rejects_pair(&invariants, graphs, i, j, &(report->filter))) {
+                check_expected_result(n, is_isomorphic, false);
+                continue;
+            }
+
+            // Try special solvers, if flag --opt_tree or --solvers was set
+            bool result;
+            Solver solver;
+            if (options->solvers && try_special_solvers(&solvers, graphs, i, j, &result, &solver, &total_time)) {
+                report->solved[solver]++;
+                check_expected_result(n, is_isomorphic, result);
+                continue;
+            }
+
+            // If no solver recognised the graphs, then compare canonical forms made by nauty or match graphs directly
+            if (matching)
+                total_time += compare_by_matching(&matches, graphs, i, j, is_isomorphic, report);
+            else
+                total_time += compare_canonical_forms(&cache, graphs, i, j, is_isomorphic, report);
+        }
+    }
+
+    // Canonicalisation, preparation for matching, recognition and invariant time is amortised over all checks
+    total_time += canonical_cache_time(&cache) + match_cache_time(&matches) + solvers.time + filter_stats_time(&(report->filter));
+    report->engines = canonical_cache_engines(&cache) | (matches.search.labellings ? 1 << ENGINE_VF2PP : 0);
+    report->invariant = cache.settings.invariant;
+    report->invariant_time = canonical_cache_invariant_time(&cache) / num_checks;
+    init_instrumentation(&(report->instrumentation));
+    if (options->instrument) {
+        canonical_cache_instrumentation(&cache, &(report->instrumentation));
+        match_cache_instrumentation(&matches, &(report->instrumentation));
+    }
+    free_canonical_cache(&cache);
+    free_match_cache(&matches);
+    free_invariant_cache(&invariants);
+    free_solver_cache(&solvers);
+    end_arena_set(arena, arena_start, &(report->arena));
+
+    return total_time / num_checks;
 }
 
-void free_graphs(graph **graphs, const int count) {
-    for (int i = 0; i < count; i++) {
-        free(graphs[i]);
+/* Check is censored if one of graphs exceeded budget, then result is unknown and only time is counted */
+double compare_canonical_forms(CanonicalCache *cache, const GraphFile *graphs, const int i, const int j, bool should_be_isomorphic, SetReport *report) {
+    const CanonicalEntry *entry1 = get_canonical_entry(cache, graphs, i);
+    const CanonicalEntry *entry2 = get_canonical_entry(cache, graphs, j);
+    if (entry1->censored || entry2->censored) {
+        report->censored++;
+        return 0.0;
+    }
+
+    const double start = thread_cpu_time();
+    bool result = compare_canonical_entries(entry1, entry2);
+    const double end = thread_cpu_time();
+
+    check_expected_result(cache->n, should_be_isomorphic, result);
+
+    return end - start;
+}
+
+/* Same as compare_canonical_forms for vf2pp engine, whole search is timed per pair */
+double compare_by_matching(MatchCache *cache, const GraphFile *graphs, const int i, const int j, bool should_be_isomorphic, SetReport *report) {
+    bool result, censored;
+    const double time = match_graphs(cache, graphs, i, j, &result, &censored);
+    if (censored)
+        report->censored++;
+    else
+        check_expected_result(graph_file_order(graphs, i), should_be_isomorphic, result);
+    return time;
+}
+
+void check_expected_result(const int n, bool should_be_isomorphic, bool is_isomorphic) {
+    if (is_isomorphic != should_be_isomorphic) {
+        printf("Error: graphs with n=%d vertexes should be is_isomorphic=%hhd but was is_isomorphic=%hhd\n", n, should_be_isomorphic, is_isomorphic);
+        exit(EXIT_FAILURE);
     }
-    free(graphs);
 }
@@ -4,11 +4,22 @@
 #include <stdbool.h>
 #include <time.h>
 #include "result_struct.h"
+#include "options.h"
 #include "nauty_isomorphism.h"
+#include "canonical_cache.h"
 #include "file_processor.h"
-#include "tree_optimization.h"
+#include "graph_reader.h"
+#include "special_solvers.h"
 #include "my_graph.h"
+#include "thread_pool.h"
+#include "prefetch_reader.h"
+#include "relabel.h"
+#include "timer.h"
+#include "statistics.h"
+#include "invariant_filter.h"
+#include "vf2pp.h"
 
-void process_graphs(const char*, const bool, Result*, bool);
+void process_graphs(const char*, const bool, Result*, const Options*);
+void benchmark_graph_set(const GraphFile*, const int, const int, bool, const Options*, ThreadPool*, SetReport*, Statistics*);
 
 #endif
\ No newline at end of file
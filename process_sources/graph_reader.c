@@ -0,0 +1,335 @@
+// memmem is a GNU extension
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph_reader.h"
+
+void load_graph_file(const char*, GraphFile*);
+void load_graph_set(const char*, const int, GraphFile*);
+void map_graph_file(const char*, const bool, GraphFile*);
+void index_graph_lines(GraphFile*);
+char* graph_line(const GraphFile*, const int);
+graph* packed_graph(const GraphFile*, const int);
+sparsegraph* packed_sparse_graph(const GraphFile*, const int);
+sparsegraph* dense_to_sparse(graph*, const int);
+
+/* Maps file into memory and indexes its lines, graphs themselves are decoded on request */
+void open_graph_file(const char *filename, GraphFile *file) {
+    file->offsets = NULL;
+    file->capacity = 0;
+    load_graph_file(filename, file);
+}
+
+/* Same as open_graph_file for a file struct which held another file, its offset buffer is reused */
+void reopen_graph_file(const char *filename, GraphFile *file) {
+    unmap_graph_file(file);
+    load_graph_file(filename, file);
+}
+
+/* Opens set with n vertices of dataset directory, from its packed dataset if directory has one, else from <n>.g6 */
+void open_graph_set(const char *path, const int n, GraphFile *file) {
+    file->offsets = NULL;
+    file->capacity = 0;
+    load_graph_set(path, n, file);
+}
+
+/* Same as open_graph_set for a file struct which held another set */
+void reopen_graph_set(const char *path, const int n, GraphFile *file) {
+    unmap_graph_file(file);
+    load_graph_set(path, n, file);
+}
+
+/* File which holds set of given order, true if it is packed dataset */
+bool graph_set_filename(const char *path, const int n, char *filename, const size_t size) {
+    if (packed_dataset_path(path, filename, size)) return true;
+    snprintf(filename, size, "%s%d.g6", path, n);
+    return false;
+}
+
+void load_graph_set(const char *path, const int n, GraphFile *file) {
+    char filename[1280];
+    if (!graph_set_filename(path, n, filename, sizeof(filename))) {
+        load_graph_file(filename, file);
+        return;
+    }
+
+    // nauty takes graphs by non-const pointer, private writable mapping would copy a page only if it was written
+    map_graph_file(filename, true, file);
+    file->packed = find_packed_set(file->data, file->length, n, filename);
+    file->count = file->packed->count;
+    file->tail = NULL;
+
+    // Only rows of this set are read ahead, mapping itself covers whole dataset
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t start = file->packed->rows_offset / page * page;
+    const size_t end = file->packed->rows_offset + file->packed->count * file->packed->stride;
+    if (end > start && end <= file->length)
+        madvise(file->data + start, end - start, MADV_WILLNEED);
+}
+
+/* Indexes graph lines of a buffer in memory, e.g. a set received from stream. Buffer is not copied and has to outlive file. */
+void open_graph_buffer(char *data, const size_t length, GraphFile *file) {
+    file->data = length > 0 ? data : NULL;
+    file->length = length;
+    file->mapped = false;
+    file->packed = NULL;
+    file->offsets = NULL;
+    file->capacity = 0;
+    index_graph_lines(file);
+}
+
+/* Releases contents of file, but keeps offset buffer for reopen_graph_file */
+void unmap_graph_file(GraphFile *file) {
+    if (file->data && file->mapped) munmap(file->data, file->length);
+    free(file->tail);
+    file->data = NULL;
+    file->length = 0;
+    file->packed = NULL;
+    file->tail = NULL;
+    file->count = 0;
+}
+
+void load_graph_file(const char *filename, GraphFile *file) {
+    map_graph_file(filename, false, file);
+    if (file->data)
+        madvise(file->data, file->length, MADV_SEQUENTIAL);
+    index_graph_lines(file);
+}
+
+void map_graph_file(const char *filename, const bool writable, GraphFile *file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Unable to open file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "Error: Unable to stat file %s\n", filename);
+        close(fd);
+        exit(EXIT_FAILURE);
+    }
+
+    file->data = NULL;
+    file->length = st.st_size;
+    file->mapped = true;
+    file->packed = NULL;
+
+    if (file->length > 0) {
+        file->data = mmap(NULL, file->length, PROT_READ | (writable ? PROT_WRITE : 0), MAP_PRIVATE, fd, 0);
+        if (file->data == MAP_FAILED) {
+            fprintf(stderr, "Error: Unable to map file %s\n", filename);
+            close(fd);
+            exit(EXIT_FAILURE);
+        }
+    }
+    close(fd);
+}
+
+void index_graph_lines(GraphFile *file) {
+    file->tail = NULL;
+    file->count = 0;
+
+    // Skip optional >>graph6<< or >>sparse6<< header
+    size_t pos = 0;
+    if (file->length >= 2 && file->data[0] == '>' && file->data[1] == '>') {
+        const char *end = memmem(file->data, file->length, "<<", 2);
+        pos = end ? (size_t)(end - file->data) + 2 : file->length;
+    }
+
+    // Index line offsets
+    if (file->capacity == 0) {
+        file->capacity = 64;
+        file->offsets = malloc(file->capacity * sizeof(size_t));
+        if (!file->offsets) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    while (pos < file->length) {
+        const char *end = memchr(file->data + pos, '\n', file->length - pos);
+        const size_t next = end ? (size_t)(end - file->data) + 1 : file->length;
+        if (next - pos > 1 || !end) {
+            if ((size_t)file->count >= file->capacity) {
+                file->capacity *= 2;
+                file->offsets = realloc(file->offsets, file->capacity * sizeof(size_t));
+                if (!file->offsets) {
+                    fprintf(stderr, "Error: Memory reallocation failed\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (file->offsets)[file->count++] = pos;
+        }
+
+        // Decoders need terminated line, so unterminated last line is copied
+        if (!end) {
+            file->tail = malloc(next - pos + 2);
+            if (!file->tail) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(file->tail, file->data + pos, next - pos);
+            strcpy(file->tail + (next - pos), "\n");
+        }
+        pos = next;
+    }
+}
+
+char* graph_line(const GraphFile *file, const int index) {
+    if (file->tail && index == file->count - 1) return file->tail;
+    return file->data + (file->offsets)[index];
+}
+
+/* Line of graph without trailing newline, it is not terminated. Graphs of packed set are encoded again into per-thread
+   buffer as graph6 from their rows, also in sets with CSR section, so store keys equal those of graph6 text. */
+const char* get_graph_line(const GraphFile *file, const int index, size_t *length) {
+    if (file->packed) {
+        const char *encoded = ntog6(packed_graph(file, index), file->packed->m, file->packed->n);
+        *length = strlen(encoded);
+        while (*length > 0 && encoded[*length - 1] == '\n')
+            (*length)--;
+        return encoded;
+    }
+
+    const char *line = graph_line(file, index);
+    const char *end = file->tail && index == file->count - 1 ? line + strlen(line)
+                      : index + 1 < file->count ? file->data + (file->offsets)[index + 1] : file->data + file->length;
+    while (end > line && (end[-1] == '\n' || end[-1] == '\r'))
+        end--;
+    *length = end - line;
+    return line;
+}
+
+/* Packed sets with CSR section are treated as sparse6 input */
+bool is_sparse6_graph(const GraphFile *file, const int index) {
+    if (file->packed) return file->packed->flags & PACKED_CSR;
+    return graph_line(file, index)[0] == ':';
+}
+
+/* Number of vertices of graph */
+int graph_file_order(const GraphFile *file, const int index) {
+    if (file->packed) return file->packed->n;
+    return graphsize(graph_line(file, index));
+}
+
+/* Decodes graph into per-thread buffer, which is valid until next get_graph call on the same thread.
+   Graphs of packed set are not decoded, pointer to their rows in mapping is returned. */
+graph* get_graph(const GraphFile *file, const int index) {
+    if (file->packed) return packed_graph(file, index);
+    return decode_graph_line(graph_line(file, index));
+}
+
+/* Decodes graph into per-thread sparse buffer, which is valid until next get_sparse_graph or get_graph call on the same thread.
+   sparse6 lines are decoded directly, graph6 lines through dense form. CSR section of packed set is used in place. */
+sparsegraph* get_sparse_graph(const GraphFile *file, const int index) {
+    if (file->packed && file->packed->flags & PACKED_CSR) return packed_sparse_graph(file, index);
+    if (file->packed) return dense_to_sparse(packed_graph(file, index), file->packed->n);
+    return decode_sparse_line(graph_line(file, index));
+}
+
+graph* packed_graph(const GraphFile *file, const int index) {
+    return (graph*)(file->data + file->packed->rows_offset + index * file->packed->stride);
+}
+
+/* Per-thread header which points into CSR block of graph, it is never reallocated */
+sparsegraph* packed_sparse_graph(const GraphFile *file, const int index) {
+    static TLS_ATTR sparsegraph sg;
+    const int n = file->packed->n;
+    const uint64_t *blocks = (const uint64_t*)(file->data + file->packed->csr_offset);
+    char *block = file->data + blocks[index];
+    sg.nv = n;
+    sg.nde = *(uint64_t*)block;
+    sg.v = (size_t*)(block + sizeof(uint64_t));
+    sg.d = (int*)(block + sizeof(uint64_t) + n * sizeof(size_t));
+    sg.e = sg.d + n;
+    sg.w = NULL;
+    sg.vlen = n;
+    sg.dlen = n;
+    sg.elen = sg.nde;
+    sg.wlen = 0;
+    return &sg;
+}
+
+sparsegraph* dense_to_sparse(graph *g, const int n) {
+    static TLS_ATTR SG_DECL(sg);
+    return nauty_to_sg(g, &sg, SETWORDSNEEDED(n), n);
+}
+
+/* Same as get_graph for a single graph6 or sparse6 line, which has to end with newline or null character */
+graph* decode_graph_line(char *line) {
+    DYNALLSTAT(graph,g,g_sz);
+
+    if (line[0] == ':') {
+        sparsegraph *sg = decode_sparse_line(line);
+        int m = SETWORDSNEEDED(sg->nv);
+        DYNALLOC2(graph,g,g_sz,sg->nv,m,"decode_graph_line");
+        return sg_to_nauty(sg, g, m, &m);
+    }
+
+    const int n = graphsize(line);
+    const int m = SETWORDSNEEDED(n);
+    DYNALLOC2(graph,g,g_sz,n,m,"decode_graph_line");
+    stringtograph(line, g, m);
+    return g;
+}
+
+sparsegraph* decode_sparse_line(char *line) {
+    static TLS_ATTR SG_DECL(sg);
+
+    if (line[0] == ':') {
+        int loops;
+        stringtosparsegraph(line, &sg, &loops);
+        return &sg;
+    }
+
+    return dense_to_sparse(decode_graph_line(line), graphsize(line));
+}
+
+/* Checks that line is a well-formed graph6 or sparse6 string of at most max_n vertices, without trailing newline.
+   nauty decoders do not validate their input. */
+bool valid_graph_line(const char *line, const size_t length, const int max_n) {
+    const bool sparse = length > 0 && line[0] == ':';
+    const char *body = sparse ? line + 1 : line;
+    const size_t body_length = sparse ? length - 1 : length;
+    for (size_t k = 0; k < body_length; k++) {
+        if (body[k] < 63 || body[k] > 126) return false;
+    }
+    if (body_length == 0) return false;
+
+    // Order is one character, '~' and three characters, or "~~" and six characters
+    long n;
+    size_t header;
+    if (body[0] != '~') {
+        n = body[0] - 63;
+        header = 1;
+    } else if (body_length >= 4 && body[1] != '~') {
+        n = (long)(body[1] - 63) << 12 | (body[2] - 63) << 6 | (body[3] - 63);
+        header = 4;
+    } else if (body_length >= 8) {
+        n = 0;
+        for (int k = 2; k < 8; k++)
+            n = n << 6 | (body[k] - 63);
+        header = 8;
+    } else {
+        return false;
+    }
+    if (n > max_n) return false;
+    if (sparse) return true;
+
+    const size_t bits = (size_t)n * (n - 1) / 2;
+    return body_length == header + (bits + 5) / 6;
+}
+
+void close_graph_file(GraphFile *file) {
+    if (file->data && file->mapped) munmap(file->data, file->length);
+    free(file->offsets);
+    free(file->tail);
+    file->data = NULL;
+    file->packed = NULL;
+    file->offsets = NULL;
+    file->capacity = 0;
+    file->tail = NULL;
+    file->count = 0;
+}
@@ -0,0 +1,39 @@
+#ifndef GRAPH_READER_H
+#define GRAPH_READER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "gtools.h"
+#include "nausparse.h"
+#include "packed_dataset.h"
+
+typedef struct {
+    char *data;         // Mapped file contents
+    size_t length;      // Size of mapping in bytes
+    bool mapped;        // False if data is a buffer owned by caller
+    const PackedSetEntry *packed;   // Set of mapped packed dataset, NULL for graph6/sparse6 text
+    size_t *offsets;    // Start of each graph line in data, not used by packed set
+    size_t capacity;    // Allocated length of offsets, kept when file struct is reused
+    char *tail;         // Copy of last line if file does not end with newline, NULL otherwise
+    int count;          // Number of graphs in file
+} GraphFile;
+
+void open_graph_file(const char*, GraphFile*);
+void reopen_graph_file(const char*, GraphFile*);
+void open_graph_set(const char*, const int, GraphFile*);
+void reopen_graph_set(const char*, const int, GraphFile*);
+bool graph_set_filename(const char*, const int, char*, const size_t);
+void unmap_graph_file(GraphFile*);
+void open_graph_buffer(char*, const size_t, GraphFile*);
+const char* get_graph_line(const GraphFile*, const int, size_t*);
+bool is_sparse6_graph(const GraphFile*, const int);
+int graph_file_order(const GraphFile*, const int);
+graph* get_graph(const GraphFile*, const int);
+sparsegraph* get_sparse_graph(const GraphFile*, const int);
+graph* decode_graph_line(char*);
+sparsegraph* decode_sparse_line(char*);
+bool valid_graph_line(const char*, const size_t, const int);
+void close_graph_file(GraphFile*);
+
+#endif
@@ -0,0 +1,142 @@
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "instrumentation.h"
+
+static const char *counter_names[COUNTER_COUNT] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+static const unsigned long long counter_configs[COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+// Counter group of each thread is opened on first use and closed when thread exits
+static pthread_key_t counters_key;
+static pthread_once_t counters_once = PTHREAD_ONCE_INIT;
+static TLS_ATTR int counters_state;     // 0 - not opened, 1 - opened, -1 - not available
+static TLS_ATTR int counter_fds[COUNTER_COUNT];
+
+bool open_counters(void);
+void create_counters_key(void);
+void close_counters(void*);
+
+void init_instrumentation(Instrumentation *instrumentation) {
+    memset(instrumentation, 0, sizeof(Instrumentation));
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        instrumentation->counters.values[c] = -1;
+}
+
+void add_search_stats(Instrumentation *instrumentation, const SearchStats *search) {
+    instrumentation->labellings++;
+    instrumentation->nodes += search->nodes;
+    if (search->nodes > instrumentation->max_nodes) instrumentation->max_nodes = search->nodes;
+    instrumentation->bad_leaves += search->bad_leaves;
+    if (search->max_level > instrumentation->max_level) instrumentation->max_level = search->max_level;
+    instrumentation->log10_group_size += search->log10_group_size;
+    instrumentation->orbits += search->orbits;
+}
+
+/* Unavailable counters (-1) stay unavailable */
+void add_counters(HardwareCounters *total, const HardwareCounters *counters) {
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        if (counters->values[c] < 0) continue;
+        total->values[c] = (total->values[c] < 0 ? 0 : total->values[c]) + counters->values[c];
+    }
+}
+
+/* Reads current values of counters of calling thread */
+void read_counters(HardwareCounters *counters) {
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        counters->values[c] = -1;
+    if (!open_counters()) return;
+
+    // Group is read at once: number of counters followed by their values
+    unsigned long long buffer[COUNTER_COUNT + 1];
+    if (read(counter_fds[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) return;
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        counters->values[c] = (long long)buffer[c + 1];
+}
+
+/* Replaces start values by difference between now and start */
+void counters_since(const HardwareCounters *start, HardwareCounters *delta) {
+    HardwareCounters now;
+    read_counters(&now);
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        delta->values[c] = start->values[c] < 0 || now.values[c] < 0 ? -1 : now.values[c] - start->values[c];
+}
+
+/* Linux resets peak RSS of process on writing 5 to clear_refs */
+void reset_peak_rss(void) {
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+    if (!file) return;
+    fputs("5", file);
+    fclose(file);
+}
+
+long peak_rss_kb(void) {
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[256];
+        long value = -1;
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                value = atol(line + 6);
+                break;
+            }
+        }
+        fclose(file);
+        if (value >= 0) return value;
+    }
+
+    // Without procfs only peak of whole run is known
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+const char* counter_name(Counter counter) {
+    return counter_names[counter];
+}
+
+bool open_counters(void) {
+    if (counters_state != 0) return counters_state > 0;
+    counters_state = -1;
+
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = counter_configs[c];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        counter_fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, c == 0 ? -1 : counter_fds[0], 0);
+        if (counter_fds[c] < 0) {
+            while (c-- > 0) close(counter_fds[c]);
+            static atomic_bool warned = false;
+            if (!atomic_exchange(&warned, true)) {
+                fprintf(stderr, "Warning: hardware counters are not available, check perf_event_paranoid\n");
+            }
+            return false;
+        }
+    }
+
+    pthread_once(&counters_once, create_counters_key);
+    pthread_setspecific(counters_key, counter_fds);
+    counters_state = 1;
+    return true;
+}
+
+void create_counters_key(void) {
+    pthread_key_create(&counters_key, close_counters);
+}
+
+/* Destructor of thread, closes its counter group */
+void close_counters(void *data) {
+    int *fds = data;
+    for (int c = COUNTER_COUNT - 1; c >= 0; c--)
+        close(fds[c]);
+}
@@ -0,0 +1,44 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "nauty_isomorphism.h"
+
+typedef enum {
+    COUNTER_CYCLES = 0,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT
+} Counter;
+
+/* Hardware counters of calling thread, all -1 if perf events are not available */
+typedef struct {
+    long long values[COUNTER_COUNT];
+} HardwareCounters;
+
+/* Search statistics and counters summed over canonical labellings of one graph set */
+typedef struct {
+    long labellings;
+    unsigned long nodes;
+    unsigned long max_nodes;
+    unsigned long bad_leaves;
+    int max_level;
+    double log10_group_size;
+    long orbits;
+    HardwareCounters counters;
+    long peak_rss_kb;           // Peak resident set size of process while set was processed
+} Instrumentation;
+
+void init_instrumentation(Instrumentation*);
+void add_search_stats(Instrumentation*, const SearchStats*);
+void add_counters(HardwareCounters*, const HardwareCounters*);
+void read_counters(HardwareCounters*);
+void counters_since(const HardwareCounters*, HardwareCounters*);
+void reset_peak_rss(void);
+long peak_rss_kb(void);
+const char* counter_name(Counter);
+
+#endif
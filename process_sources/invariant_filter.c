@@ -0,0 +1,202 @@
+#include "invariant_filter.h"
+
+static const char *stage_names[STAGE_COUNT] = {"edges", "degrees", "triangles", "wl"};
+
+double compute_stage(InvariantCache*, graph*, InvariantEntry*, FilterStage);
+bool stage_differs(const InvariantCache*, const InvariantEntry*, const InvariantEntry*, FilterStage);
+void count_triangles(graph*, const int, const int, int*);
+uint64_t refine_colours(graph*, const int, const int, const int*);
+int* allocate_ints(const int);
+int compare_ints(const void*, const void*);
+
+/* Entries and their invariants are allocated from arena of thread, they are released when set ends */
+void init_invariant_cache(InvariantCache *cache, const int count, const int n) {
+    cache->count = count;
+    cache->n = n;
+    cache->m = SETWORDSNEEDED(n);
+    cache->entries = arena_calloc(thread_arena(), count, sizeof(InvariantEntry));
+}
+
+/* Runs stages one after another until some of them proves that graphs are not isomorphic.
+   Invariants of each graph are computed lazily, at most once per stage. */
+bool filter_rejects_pair(InvariantCache *cache, const GraphFile *graphs, const int i, const int j, FilterStats *stats) {
+    InvariantEntry *entry1 = &(cache->entries)[i];
+    InvariantEntry *entry2 = &(cache->entries)[j];
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        // Graphs are decoded one at a time, decoding is not measured
+        double time = 0.0;
+        if (entry1->stages <= stage) time += compute_stage(cache, get_graph(graphs, i), entry1, stage);
+        if (entry2->stages <= stage) time += compute_stage(cache, get_graph(graphs, j), entry2, stage);
+        const double start = thread_cpu_time();
+        const bool differs = stage_differs(cache, entry1, entry2, stage);
+        stats->time[stage] += time + thread_cpu_time() - start;
+
+        if (differs) {
+            stats->resolved[stage]++;
+            return true;
+        }
+    }
+
+    stats->resolved[STAGE_COUNT]++;
+    return false;
+}
+
+/* Total time of all stages */
+double filter_stats_time(const FilterStats *stats) {
+    double total_time = 0.0;
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+        total_time += stats->time[stage];
+    return total_time;
+}
+
+void free_invariant_cache(InvariantCache *cache) {
+    cache->entries = NULL;
+    cache->count = 0;
+}
+
+const char* filter_stage_name(FilterStage stage) {
+    return stage_names[stage];
+}
+
+/* Returns time spent on computation */
+double compute_stage(InvariantCache *cache, graph *g, InvariantEntry *entry, FilterStage stage) {
+    const int n = cache->n;
+    const int m = cache->m;
+    const double start = thread_cpu_time();
+
+    switch (stage) {
+        case STAGE_EDGES:
+            // Degrees are counted with popcount over rows, they are used by later stages too
+            entry->degrees = allocate_ints(n);
+            entry->edges = 0;
+            for (int v = 0; v < n; v++) {
+                const set *row = GRAPHROW(g, v, m);
+                int degree = 0;
+                for (int k = 0; k < m; k++)
+                    degree += POPCOUNT(row[k]);
+                entry->degrees[v] = degree;
+                entry->edges += degree;
+            }
+            entry->edges /= 2;
+            break;
+        case STAGE_DEGREES:
+            entry->sorted_degrees = allocate_ints(n);
+            memcpy(entry->sorted_degrees, entry->degrees, n * sizeof(int));
+            qsort(entry->sorted_degrees, n, sizeof(int), compare_ints);
+            break;
+        case STAGE_TRIANGLES:
+            entry->triangles = allocate_ints(n);
+            count_triangles(g, n, m, entry->triangles);
+            qsort(entry->triangles, n, sizeof(int), compare_ints);
+            break;
+        case STAGE_WL:
+            entry->wl_hash = refine_colours(g, n, m, entry->degrees);
+            break;
+        default:
+            break;
+    }
+    entry->stages = stage + 1;
+
+    return thread_cpu_time() - start;
+}
+
+bool stage_differs(const InvariantCache *cache, const InvariantEntry *entry1, const InvariantEntry *entry2, FilterStage stage) {
+    switch (stage) {
+        case STAGE_EDGES:
+            return entry1->edges != entry2->edges;
+        case STAGE_DEGREES:
+            return memcmp(entry1->sorted_degrees, entry2->sorted_degrees, cache->n * sizeof(int)) != 0;
+        case STAGE_TRIANGLES:
+            return memcmp(entry1->triangles, entry2->triangles, cache->n * sizeof(int)) != 0;
+        case STAGE_WL:
+            return entry1->wl_hash != entry2->wl_hash;
+        default:
+            return false;
+    }
+}
+
+/* Triangles at v are common neighbours of v and its neighbours, counted with popcount of row intersections */
+void count_triangles(graph *g, const int n, const int m, int *triangles) {
+    for (int v = 0; v < n; v++) {
+        const set *row = GRAPHROW(g, v, m);
+        long count = 0;
+        for (int k = 0; k < m; k++) {
+            setword word = row[k];
+            while (word) {
+                int bit_index;
+                TAKEBIT(bit_index, word);
+                const set *neighbour_row = GRAPHROW(g, TIMESWORDSIZE(k) + bit_index, m);
+                for (int l = 0; l < m; l++)
+                    count += POPCOUNT(row[l] & neighbour_row[l]);
+            }
+        }
+        // Each triangle is found from both of its other vertices
+        triangles[v] = (int)(count / 2);
+    }
+}
+
+/* 1-WL colour refinement. New colour combines old colour with an order-independent sum over neighbours.
+   Histogram of colours after each round is folded into the returned hash. */
+uint64_t refine_colours(graph *g, const int n, const int m, const int *degrees) {
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    uint64_t *colours = arena_alloc(arena, n * sizeof(uint64_t));
+    uint64_t *next = arena_alloc(arena, n * sizeof(uint64_t));
+
+    for (int v = 0; v < n; v++)
+        colours[v] = (uint64_t)degrees[v];
+
+    uint64_t hash = 0;
+    for (int round = 0; round < WL_ROUNDS; round++) {
+        for (int v = 0; v < n; v++) {
+            const set *row = GRAPHROW(g, v, m);
+            uint64_t sum = 0;
+            for (int k = 0; k < m; k++) {
+                setword word = row[k];
+                while (word) {
+                    int bit_index;
+                    TAKEBIT(bit_index, word);
+                    sum += mix_colour(colours[TIMESWORDSIZE(k) + bit_index]);
+                }
+            }
+            next[v] = mix_colour(colours[v] ^ (sum * 0x9e3779b97f4a7c15ULL));
+        }
+        uint64_t *swap = colours;
+        colours = next;
+        next = swap;
+
+        // Hash of sorted colours does not depend on labelling
+        memcpy(next, colours, n * sizeof(uint64_t));
+        qsort(next, n, sizeof(uint64_t), compare_colours);
+        for (int v = 0; v < n; v++)
+            hash = mix_colour(hash ^ next[v]);
+    }
+
+    arena_release(arena, mark);
+    return hash;
+}
+
+/* splitmix64 finaliser */
+uint64_t mix_colour(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+int* allocate_ints(const int count) {
+    return arena_alloc(thread_arena(), count * sizeof(int));
+}
+
+int compare_ints(const void *a, const void *b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int compare_colours(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
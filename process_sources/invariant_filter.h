@@ -0,0 +1,54 @@
+#ifndef INVARIANT_FILTER_H
+#define INVARIANT_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nauty.h"
+#include "timer.h"
+#include "graph_reader.h"
+#include "arena.h"
+
+// Rounds of colour refinement in the last stage
+#define WL_ROUNDS 3
+
+/* Stages of prefilter, from the cheapest one */
+typedef enum {
+    STAGE_EDGES = 0,
+    STAGE_DEGREES,
+    STAGE_TRIANGLES,
+    STAGE_WL,
+    STAGE_COUNT
+} FilterStage;
+
+typedef struct {
+    long resolved[STAGE_COUNT + 1];   // Pairs rejected by each stage, the last item counts pairs passed to exact check
+    double time[STAGE_COUNT];         // Time spent in each stage (invariant computation and comparison)
+} FilterStats;
+
+typedef struct {
+    int stages;             // Number of stages whose invariants are already computed
+    long edges;
+    int *degrees;           // Degree of each vertex
+    int *sorted_degrees;
+    int *triangles;         // Sorted per-vertex triangle counts
+    uint64_t wl_hash;       // Hash of colour histograms of all refinement rounds
+} InvariantEntry;
+
+typedef struct {
+    InvariantEntry *entries;
+    int count;
+    int n;
+    int m;
+} InvariantCache;
+
+void init_invariant_cache(InvariantCache*, const int, const int);
+bool filter_rejects_pair(InvariantCache*, const GraphFile*, const int, const int, FilterStats*);
+double filter_stats_time(const FilterStats*);
+void free_invariant_cache(InvariantCache*);
+const char* filter_stage_name(FilterStage);
+uint64_t mix_colour(uint64_t);
+int compare_colours(const void*, const void*);
+
+#endif
@@ -1,17 +1,118 @@
 #include <stdbool.h>
+#include <unistd.h>
 #include "result_struct.h"
+#include "options.h"
 #include "graph_processor.h"
 #include "file_processor.h"
+#include "stream_processor.h"
 
-void process_arguments(const int, char**, const char*, const char*, bool*);
-void start_process(const char*, bool, Result*, bool*, bool);
+void process_arguments(const int, char**, const char*, const char*, Options*, const char**, const char**, const char**, bool*, bool*,
+                       const char**, const char**);
+uint64_t hash_options(const Options*);
+void start_process(const char*, bool, Result*, bool*, const Options*);
+void classify_file(const char*, const char*, const Options*);
 
 int main(const int argc, char *argv[]) {
+    // Combine results of shards processed on several machines
+    if (argc >= 2 && strcmp(argv[1], "--merge") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Usage: %s --merge <result_file> <shard_result_file>...\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        merge_shard_results(argv[2], argv + 3, argc - 3);
+        return EXIT_SUCCESS;
+    }
+
+    // Convert dataset directories to packed datasets, which are loaded without decoding
+    if (argc >= 2 && strcmp(argv[1], "--pack") == 0) {
+        if (argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "--csr") != 0)) {
+            fprintf(stderr, "Usage: %s --pack <dataset_path> [--csr]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        pack_dataset(argv[2], argc == 4);
+        return EXIT_SUCCESS;
+    }
+
     // Process arguments
     const char *dataset_path = argv[1];
     const char *result_file = argv[2];
-    bool opt_tree = false;
-    process_arguments(argc, argv, dataset_path, result_file, &opt_tree);
+    Options options = {
+        .solvers = 0,
+        .engine = ENGINE_DENSE,
+        .threads = 1,
+        .warmup = 0,
+        .repetitions = 1,
+        .pin = false,
+        .prefetch = 0,
+        .relabel = 0,
+        .seed = 1,
+        .prefilter = false,
+        .invariant = INVARIANT_NONE,
+        .invar_level = 1,
+        .invar_arg = 0,
+        .instrument = false,
+        .budget = {0.0, 0},
+        .store = NULL,
+        .checkpoint = NULL,
+        .shard = NULL
+    };
+    const char *store_file = NULL;
+    const char *checkpoint_file = NULL;
+    const char *instrument_file = NULL;
+    bool classify = false;
+    bool stream = false;
+    const char *shard = NULL;
+    const char *shard_costs = NULL;
+    process_arguments(argc, argv, dataset_path, result_file, &options, &store_file, &checkpoint_file, &instrument_file,
+                      &classify, &stream, &shard, &shard_costs);
+    options.instrument = instrument_file != NULL;
+    if (options.relabel > 0)
+        printf("Isomorphic sets: first graph and %d relabellings, seed %llu\n", options.relabel,
+               (unsigned long long)options.seed);
+    if (options.pin && options.threads <= 1)
+        pin_current_thread(0);
+
+    // Persistent state shared by runs over the same dataset
+    CertificateStore store;
+    Checkpoint checkpoint;
+    if (store_file) {
+        open_certificate_store(store_file, &store);
+        options.store = &store;
+    }
+    if (checkpoint_file) {
+        open_checkpoint(checkpoint_file, hash_options(&options), &checkpoint);
+        options.checkpoint = &checkpoint;
+    }
+
+    // Every machine of a sweep computes the same plan and keeps only its own files
+    ShardPlan shard_plan;
+    if (shard) {
+        int shard_index, shard_count;
+        parse_shard(shard, &shard_index, &shard_count);
+        plan_shards(dataset_path, shard_costs, shard_index, shard_count, &shard_plan);
+        print_shard_plan(&shard_plan);
+        options.shard = &shard_plan;
+    }
+
+    // Partition one graph file into isomorphism classes instead of benchmarking dataset
+    if (classify) {
+        classify_file(dataset_path, result_file, &options);
+        if (options.store) {
+            printf("Certificate store: %ld certificates reused, %ld computed.\n", store.hits, store.misses);
+            close_certificate_store(&store);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Process sets as they arrive from generator, dataset_path is the stream
+    if (stream) {
+        process_stream(dataset_path, result_file, instrument_file, &options);
+        if (options.store) {
+            printf("Certificate store: %ld certificates reused, %ld computed.\n", store.hits, store.misses);
+            close_certificate_store(&store);
+        }
+        return EXIT_SUCCESS;
+    }
 
     // Init results
     Result result_i;
@@ -19,59 +120,237 @@ int main(const int argc, char *argv[]) {
     bool only_isomorphic = true;
 
     // Start isomorphic/non-isomorphic graph processing
-    start_process(dataset_path, true, &result_i, NULL, opt_tree);
-    start_process(dataset_path, false, &result_ni, &only_isomorphic, opt_tree);
+    start_process(dataset_path, true, &result_i, NULL, &options);
+    start_process(dataset_path, false, &result_ni, &only_isomorphic, &options);
 
     // Save to CSV
     write_to_csv(result_file, &result_i, &result_ni, only_isomorphic);
+    if (instrument_file)
+        write_instrumentation(instrument_file, &result_i, &result_ni, only_isomorphic);
 
     // Free
+    if (options.store) {
+        printf("Certificate store: %ld certificates reused, %ld computed.\n", store.hits, store.misses);
+        close_certificate_store(&store);
+    }
+    if (options.checkpoint)
+        close_checkpoint(&checkpoint);
+    if (options.shard)
+        free_shard_plan(&shard_plan);
     free(result_i.nodes);
     free(result_i.time);
+    free(result_i.reports);
+    free(result_i.stats);
     if (!only_isomorphic) {
         free(result_ni.nodes);
         free(result_ni.time);
+        free(result_ni.reports);
+        free(result_ni.stats);
     }
 
     return EXIT_SUCCESS;
 }
 
-void process_arguments(const int argc, char **argv, const char *dataset_path, const char *result_file, bool *opt_tree) {
+void process_arguments(const int argc, char **argv, const char *dataset_path, const char *result_file, Options *options,
+                       const char **store_file, const char **checkpoint_file, const char **instrument_file, bool *classify,
+                       bool *stream, const char **shard, const char **shard_costs) {
     // Process required flags
     if (argc < 3) {
-        fprintf(stderr, "Usage: %s <dataset_path> <result_file> [--opt_tree]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <dataset_path> <result_file> [--opt_tree] [--opt_planar] [--solvers LIST] [--engine dense|sparse|traces|auto|vf2pp]\n"
+                        "       [--threads N] [--prefetch N] [--warmup N] [--reps N] [--pin] [--prefilter] [--store FILE] [--checkpoint FILE]\n"
+                        "       [--self_relabel K] [--seed N]\n"
+                        "       [--budget_time SECONDS] [--budget_nodes N] [--instrument FILE.csv|FILE.jsonl] [--shard i/N] [--shard_costs FILE.csv]\n"
+                        "       [--invariant none|cellquads|cellfano|distances|adjtriang|auto] [--invarlev N] [--invararg N]\n"
+                        "       %s <graph_file> <result_file> --classify [--engine ...] [--threads N] [--store FILE] [--budget_time SECONDS]\n"
+                        "       %s <stream|-> <result_file> --stream [options of dataset processing except --prefetch, --checkpoint and --shard]\n"
+                        "       %s --merge <result_file> <shard_result_file>...\n"
+                        "       %s --pack <dataset_path> [--csr]\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0]);
         exit(EXIT_FAILURE);
     }
     dataset_path = argv[1];
     result_file = argv[2];
 
     // Process optional flags
+    bool seed = false;
     for (int i = 3; i < argc; ++i) {
         if (strcmp(argv[i], "--opt_tree") == 0) {
-            *opt_tree = true;
+            options->solvers |= 1 << SOLVER_TREE;
+        } else if (strcmp(argv[i], "--opt_planar") == 0) {
+            options->solvers |= 1 << SOLVER_PLANAR;
+        } else if (strcmp(argv[i], "--solvers") == 0 && i + 1 < argc) {
+            options->solvers |= parse_solvers(argv[++i]);
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            options->engine = parse_engine(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // 0 means one thread per online CPU
+            options->threads = atoi(argv[++i]);
+            if (options->threads <= 0)
+                options->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        } else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+            options->prefetch = atoi(argv[++i]);
+            if (options->prefetch < 0) {
+                fprintf(stderr, "Error: --prefetch must not be negative\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--self_relabel") == 0 && i + 1 < argc) {
+            options->relabel = atoi(argv[++i]);
+            if (options->relabel < 1) {
+                fprintf(stderr, "Error: --self_relabel must be at least 1\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options->seed = strtoull(argv[++i], NULL, 10);
+            seed = true;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options->warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            options->repetitions = atoi(argv[++i]);
+            if (options->repetitions < 1) {
+                fprintf(stderr, "Error: --reps must be at least 1\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--pin") == 0) {
+            options->pin = true;
+        } else if (strcmp(argv[i], "--prefilter") == 0) {
+            options->prefilter = true;
+        } else if (strcmp(argv[i], "--budget_time") == 0 && i + 1 < argc) {
+            options->budget.time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--budget_nodes") == 0 && i + 1 < argc) {
+            options->budget.nodes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--invariant") == 0 && i + 1 < argc) {
+            options->invariant = parse_invariant(argv[++i]);
+        } else if (strcmp(argv[i], "--invarlev") == 0 && i + 1 < argc) {
+            options->invar_level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--invararg") == 0 && i + 1 < argc) {
+            options->invar_arg = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--instrument") == 0 && i + 1 < argc) {
+            *instrument_file = argv[++i];
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            *store_file = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            *checkpoint_file = argv[++i];
+        } else if (strcmp(argv[i], "--classify") == 0) {
+            *classify = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            *stream = true;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            *shard = argv[++i];
+        } else if (strcmp(argv[i], "--shard_costs") == 0 && i + 1 < argc) {
+            *shard_costs = argv[++i];
         } else {
             fprintf(stderr, "Unknown option: %s\n", argv[i]);
             exit(EXIT_FAILURE);
         }
     }
+
+    // Traces has no hook to abort search, budget would be silently ignored
+    if (options->engine == ENGINE_TRACES && (options->budget.time > 0 || options->budget.nodes > 0)) {
+        fprintf(stderr, "Error: --budget_time and --budget_nodes cannot be combined with --engine traces\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // nauty keeps its work buffers in static variables, they are thread-local only in nautyT.a
+#ifndef USE_TLS
+    if (options->threads > 1) {
+        fprintf(stderr, "Error: --threads requires thread-safe nauty, configure with -DNAUTY_TLS=ON\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    // In multi-threaded mode files are already processed concurrently
+    if (options->prefetch > 0 && options->threads > 1) {
+        fprintf(stderr, "Error: --prefetch is used only in single-threaded mode, it cannot be combined with --threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Sets of stream are not files, they can be neither read ahead nor restored. Classification is done per file.
+    if (*stream && (options->prefetch > 0 || *checkpoint_file || *classify || *shard)) {
+        fprintf(stderr, "Error: --stream cannot be combined with --prefetch, --checkpoint, --classify or --shard\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Classification does not benchmark sets, options of benchmark have no meaning there
+    if (*classify && (options->solvers || options->prefilter || *checkpoint_file || *instrument_file || *shard)) {
+        fprintf(stderr, "Error: --classify cannot be combined with special solvers, --prefilter, --checkpoint, --instrument or --shard\n");
+        exit(EXIT_FAILURE);
+    }
+    // Relabellings replace isomorphic sets of dataset directory, stream and classified file have no such sets
+    if (options->relabel > 0 && (*stream || *classify)) {
+        fprintf(stderr, "Error: --self_relabel cannot be combined with --stream or --classify\n");
+        exit(EXIT_FAILURE);
+    }
+    if (seed && options->relabel == 0) {
+        fprintf(stderr, "Error: --seed is used only with --self_relabel\n");
+        exit(EXIT_FAILURE);
+    }
+    // vf2pp decides pairs directly, there are no certificates to classify or store and no labelling to apply invariant in
+    if (options->engine == ENGINE_VF2PP && (*classify || *store_file || options->invariant != INVARIANT_NONE)) {
+        fprintf(stderr, "Error: --engine vf2pp cannot be combined with --classify, --store or --invariant\n");
+        exit(EXIT_FAILURE);
+    }
+    // Store gives later repetitions the certificates and recorded times of the first one, their samples would be equal
+    if (*store_file && !*classify && (options->warmup > 0 || options->repetitions > 1)) {
+        fprintf(stderr, "Error: --store requires --warmup 0 and --reps 1, repetitions would reuse certificates of the first one\n");
+        exit(EXIT_FAILURE);
+    }
+    if (*shard_costs && !*shard) {
+        fprintf(stderr, "Error: --shard_costs is used only with --shard\n");
+        exit(EXIT_FAILURE);
+    }
 }
 
-void start_process(const char *dataset_path, bool is_isomorphic, Result *result, bool *only_isomorphic, bool opt_tree) {
-    // Construct path with subdirectory
+void start_process(const char *dataset_path, bool is_isomorphic, Result *result, bool *only_isomorphic, const Options *options) {
+    // Subdirectory is used if it exists, else data directly from dataset_path (it is considered isomorphic)
     char path[1024];
-    snprintf(path, sizeof(path), "%s%s", dataset_path, is_isomorphic ? "isomorphic/" : "non_isomorphic/");
+    if (!dataset_directory(dataset_path, is_isomorphic, path, sizeof(path)))
+        return;
 
-    // If subdirectory exists, use data from it
+    // If "non-isomorphic" subdirectory exists, then dataset contains non-isomorphic data
+    if (!is_isomorphic) {
+      *only_isomorphic = false;
+    }
+    process_graphs(path, is_isomorphic, result, options);
+}
+
+/* Splits graphs of one graph6/sparse6 file into isomorphism classes and writes class of each graph */
+void classify_file(const char *graph_file, const char *result_file, const Options *options) {
     struct stat st;
-    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) { // directory exists
-        // If "non-isomorphic" subdirectory exists, then dataset contains non-isomorphic data
-        if (!is_isomorphic) {
-          *only_isomorphic = false;
-        }
-        process_graphs(path, is_isomorphic, result, opt_tree);
+    if (stat(graph_file, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "Error: --classify expects a graph file, %s is not one\n", graph_file);
+        exit(EXIT_FAILURE);
     }
-    // Else use data directly from dataset_path (it is considered isomorphic)
-    else if (is_isomorphic) {
-        process_graphs(dataset_path, is_isomorphic, result, opt_tree);
+
+    GraphFile graphs;
+    open_graph_file(graph_file, &graphs);
+    IsoClasses classes;
+    classify_graphs(&graphs, options, &classes);
+    close_graph_file(&graphs);
+
+    printf("%d graphs split into %d isomorphism classes in %f s (canonical labelling %f s), %d censored.\n",
+           classes.count, classes.class_count, classes.wall_time, classes.time, classes.censored);
+    write_classes(result_file, &classes);
+    free_iso_classes(&classes);
+}
+
+/* Hash of options which affect results, checkpoints are valid only for the same options.
+   Instrumentation is included, sets restored from run without it would have no counters. */
+uint64_t hash_options(const Options *options) {
+    const int values[] = {options->solvers, options->engine, options->warmup, options->repetitions,
+                          options->prefilter, options->store != NULL, options->invariant, options->invar_level,
+                          options->invar_arg, options->relabel, options->instrument};
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t k = 0; k < sizeof(values) / sizeof(values[0]); ++k) {
+        hash ^= (uint64_t)(unsigned)values[k];
+        hash *= 0x100000001b3ULL;
     }
-}
\ No newline at end of file
+    uint64_t budget_time;
+    memcpy(&budget_time, &(options->budget.time), sizeof(budget_time));
+    hash ^= budget_time;
+    hash *= 0x100000001b3ULL;
+    hash ^= (uint64_t)options->budget.nodes;
+    hash *= 0x100000001b3ULL;
+    hash ^= options->seed;
+    hash *= 0x100000001b3ULL;
+    return hash;
+}
@@ -1,42 +1,104 @@
+#include <string.h>
 #include "my_graph.h"
 
+/* Degrees are counted with popcount, neighbours are taken word by word with FIRSTBITNZ */
 myGraph* convert_nauty_to_mygraph(graph *g, int n) {
     int m = SETWORDSNEEDED(n);
-    myGraph *result = malloc(sizeof(myGraph));
+
+    // Count edges first to allocate everything at once
+    size_t degree_sum = 0;
+    for (size_t k = 0; k < m*(size_t)n; ++k)
+        degree_sum += POPCOUNT(g[k]);
+
+    myGraph *result = arena_alloc(thread_arena(), sizeof(myGraph) + (n + 1 + degree_sum) * sizeof(int));
     result->vertex_count = n;
-    result->vertices = calloc(n, sizeof(myVertex));
+    result->edge_count = (int)(degree_sum / 2);
+    result->offsets = (int*)(result + 1);
+    result->neighbours = result->offsets + n + 1;
 
+    // Fill neighbours
+    int idx = 0;
     for (int u = 0; u < n; ++u) {
-        result->vertices[u].id = u;
-
-        // Count degree first
-        int deg = 0;
+        result->offsets[u] = idx;
         set *row = GRAPHROW(g, u, m);
-        for (int v = 0; v < n; ++v) {
-            if (ISELEMENT(row, v)) deg++;
+        for (int k = 0; k < m; ++k) {
+            setword word = row[k];
+            while (word) {
+                int bit_index;
+                TAKEBIT(bit_index, word);
+                result->neighbours[idx++] = TIMESWORDSIZE(k) + bit_index;
+            }
         }
+    }
+    result->offsets[n] = idx;
+
+    return result;
+}
 
-        result->vertices[u].neighbours = malloc(deg * sizeof(int));
-        result->vertices[u].neighbour_count = deg;
+int compare_neighbours(const void*, const void*);
 
-        // Fill neighbors
-        int idx = 0;
-        for (int v = 0; v < n; ++v) {
-            if (ISELEMENT(row, v)) {
-                result->vertices[u].neighbours[idx] = v;
-                idx++;
-            }
-        }
+/* Edges of sparse graph are copied as they are, only neighbour lists are sorted */
+myGraph* convert_sparse_to_mygraph(sparsegraph *sg) {
+    const int n = sg->nv;
+    myGraph *result = arena_alloc(thread_arena(), sizeof(myGraph) + (n + 1 + sg->nde) * sizeof(int));
+    result->vertex_count = n;
+    result->edge_count = (int)(sg->nde / 2);
+    result->offsets = (int*)(result + 1);
+    result->neighbours = result->offsets + n + 1;
+
+    int idx = 0;
+    for (int u = 0; u < n; ++u) {
+        result->offsets[u] = idx;
+        memcpy(result->neighbours + idx, sg->e + sg->v[u], sg->d[u] * sizeof(int));
+        qsort(result->neighbours + idx, sg->d[u], sizeof(int), compare_neighbours);
+        idx += sg->d[u];
     }
+    result->offsets[n] = idx;
 
     return result;
 }
 
-void free_mygraph(myGraph *g) {
-    if (!g) return;
-    for (int i = 0; i < g->vertex_count; ++i) {
-        free(g->vertices[i].neighbours);
+int compare_neighbours(const void *a, const void *b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* Size of graph in bytes */
+size_t mygraph_size(const myGraph *g) {
+    return sizeof(myGraph) + (g->vertex_count + 1 + 2 * (size_t)g->edge_count) * sizeof(int);
+}
+
+void init_mygraph_cache(myGraphCache *cache, const int count, const int n) {
+    cache->count = count;
+    cache->n = n;
+    cache->graphs = calloc(count > 0 ? count : 1, sizeof(myGraph*));
+    if (!cache->graphs) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Returns CSR form of graphs[index], converting it only on the first request. It is allocated from arena of thread,
+   so it has to be released before the arena is released to a mark taken before the request. */
+myGraph* get_mygraph(myGraphCache *cache, const GraphFile *graphs, const int index) {
+    if (!(cache->graphs)[index]) {
+        if (is_sparse6_graph(graphs, index))
+            (cache->graphs)[index] = convert_sparse_to_mygraph(get_sparse_graph(graphs, index));
+        else
+            (cache->graphs)[index] = convert_nauty_to_mygraph(get_graph(graphs, index), cache->n);
     }
-    free(g->vertices);
-    free(g);
+    return (cache->graphs)[index];
+}
+
+/* Forgets CSR form of one graph when it is no longer needed, its memory goes back with the arena.
+   It is rebuilt if requested again. */
+void release_mygraph(myGraphCache *cache, const int index) {
+    (cache->graphs)[index] = NULL;
+}
+
+void free_mygraph_cache(myGraphCache *cache) {
+    free(cache->graphs);
+    cache->graphs = NULL;
+    cache->count = 0;
 }
@@ -1,20 +1,42 @@
 #ifndef MY_GRAPH_H
 #define MY_GRAPH_H
 
+#include <stdio.h>
+#include <stdlib.h>
 #include "nauty.h"
+#include "graph_reader.h"
+#include "arena.h"
 
+/* Compressed sparse row graph, allocated from arena of thread as one block together with its arrays.
+   Neighbours of v are neighbours[offsets[v]] .. neighbours[offsets[v+1] - 1], sorted increasingly. */
 typedef struct {
-    int id;
-    int *neighbours;
-    int neighbour_count;
-} myVertex;
-
-typedef struct {
-    myVertex *vertices;
     int vertex_count;
+    int edge_count;
+    int *offsets;       // vertex_count + 1 items
+    int *neighbours;    // 2 * edge_count items
 } myGraph;
 
+typedef struct {
+    myGraph **graphs;   // CSR form of each graph of a set, NULL until first requested
+    int count;
+    int n;
+} myGraphCache;
+
 myGraph* convert_nauty_to_mygraph(graph*, int);
-void free_mygraph(myGraph*);
+myGraph* convert_sparse_to_mygraph(sparsegraph*);
+size_t mygraph_size(const myGraph*);
+
+void init_mygraph_cache(myGraphCache*, const int, const int);
+myGraph* get_mygraph(myGraphCache*, const GraphFile*, const int);
+void release_mygraph(myGraphCache*, const int);
+void free_mygraph_cache(myGraphCache*);
+
+static inline int mygraph_degree(const myGraph *g, const int v) {
+    return g->offsets[v + 1] - g->offsets[v];
+}
+
+static inline const int* mygraph_neighbours(const myGraph *g, const int v) {
+    return g->neighbours + g->offsets[v];
+}
 
 #endif
@@ -1,46 +1,267 @@
 #include "nauty_isomorphism.h"
 
-double check_isomorphism_nauty(graph *graph1, graph *graph2, const int n, bool should_be_isomorphic) {
-    DYNALLSTAT(int,lab1,lab1_sz);
-    DYNALLSTAT(int,lab2,lab2_sz);
+static const char *engine_names[ENGINE_COUNT] = {"dense", "sparse", "traces", "auto", "vf2pp"};
+static const char *invariant_names[INVARIANT_COUNT] = {"none", "cellquads", "cellfano", "distances", "adjtriang", "auto"};
+
+typedef void (*InvariantProc)(graph*, int*, int*, int, int, int, int*, int, boolean, int, int);
+static const InvariantProc invariant_procs[INVARIANT_COUNT] = {NULL, cellquads, cellfano, distances, adjtriang, NULL};
+
+// Invariant called through timed_invariant and its time in labelling running on this thread
+static TLS_ATTR InvariantProc invariant_proc;
+static TLS_ATTR double invariant_time;
+
+// Budget of canonical labelling running on this thread
+static TLS_ATTR long budget_nodes_left;
+static TLS_ATTR double budget_deadline;
+static TLS_ATTR bool budget_exceeded;
+
+void start_budget(const Budget*);
+bool finish_budget(const Budget*);
+void budget_node_hook(graph*, int*, int*, int, int, int, int, int, int);
+void copy_search_stats(const statsblk*, SearchStats*);
+void timed_invariant(graph*, int*, int*, int, int, int, int*, int, boolean, int, int);
+
+Engine parse_engine(const char *name) {
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (strcmp(name, engine_names[e]) == 0) return (Engine)e;
+    }
+    fprintf(stderr, "Unknown engine: %s\n", name);
+    exit(EXIT_FAILURE);
+}
+
+const char* engine_name(Engine engine) {
+    return engine_names[engine];
+}
+
+Invariant parse_invariant(const char *name) {
+    for (int i = 0; i < INVARIANT_COUNT; i++) {
+        if (strcmp(name, invariant_names[i]) == 0) return (Invariant)i;
+    }
+    fprintf(stderr, "Unknown invariant: %s\n", name);
+    exit(EXIT_FAILURE);
+}
+
+const char* invariant_name(Invariant invariant) {
+    return invariant_names[invariant];
+}
+
+/* Writes engines from bitmask (1 << Engine) joined with '+', e.g. "sparse+traces" */
+void format_engines(const int mask, char *buffer, const size_t size) {
+    size_t pos = 0;
+    buffer[0] = '\0';
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (!(mask & (1 << e))) continue;
+        pos += snprintf(buffer + pos, size - pos, "%s%s", pos ? "+" : "", engine_names[e]);
+        if (pos >= size) break;
+    }
+}
+
+/* Resolves auto engine by edge density. Isomorphic graphs have equal edge count, so they always get the same engine.
+   Traces has no budget hook, so budgeted labelling of large sparse graphs stays on sparsenauty. */
+Engine select_engine(graph *g, const int n, Engine requested, const bool budgeted) {
+    if (requested != ENGINE_AUTO) return requested;
+
+    const int m = SETWORDSNEEDED(n);
+    size_t degree_sum = 0;
+    for (size_t k = 0; k < m*(size_t)n; ++k)
+        degree_sum += POPCOUNT(g[k]);
+
+    return select_engine_by_degrees(degree_sum, n, requested, budgeted);
+}
+
+/* Same as select_engine, for graphs which are already known by their degree sum */
+Engine select_engine_by_degrees(const size_t degree_sum, const int n, Engine requested, const bool budgeted) {
+    if (requested != ENGINE_AUTO) return requested;
+    if (n < 2) return ENGINE_DENSE;
+
+    const double density = (double)degree_sum / ((double)n * (n - 1));
+    if (density >= AUTO_SPARSE_DENSITY) return ENGINE_DENSE;
+    return n >= AUTO_TRACES_MIN_N && !budgeted ? ENGINE_TRACES : ENGINE_SPARSE;
+}
+
+/* Writes canonically labelled copy of graph to canon (n*m words) and returns time spent.
+   If budget is exceeded, search is aborted, aborted is set and canon is not valid. Search statistics are optional. */
+double canonical_form_nauty(graph *g, graph *canon, const int n, const LabellingSettings *settings, bool *aborted, SearchStats *search) {
+    const Budget *budget = settings ? settings->budget : NULL;
+    DYNALLSTAT(int,lab,lab_sz);
     DYNALLSTAT(int,ptn,ptn_sz);
     DYNALLSTAT(int,orbits,orbits_sz);
-    DYNALLSTAT(int,map,map_sz);
-    DYNALLSTAT(graph,g1,g1_sz);
-    DYNALLSTAT(graph,g2,g2_sz);
-    DYNALLSTAT(graph,cg1,cg1_sz);
-    DYNALLSTAT(graph,cg2,cg2_sz);
-    static DEFAULTOPTIONS_GRAPH(options);
+    DEFAULTOPTIONS_GRAPH(options);
     statsblk stats;
     options.getcanon = TRUE;
 
     const int m = SETWORDSNEEDED(n);
     nauty_check(WORDSIZE,m,n,NAUTYVERSIONID);
-    DYNALLOC1(int,lab1,lab1_sz,n,"malloc");
-    DYNALLOC1(int,lab2,lab2_sz,n,"malloc");
+    DYNALLOC1(int,lab,lab_sz,n,"malloc");
+    DYNALLOC1(int,ptn,ptn_sz,n,"malloc");
+    DYNALLOC1(int,orbits,orbits_sz,n,"malloc");
+
+    if (budget) options.usernodeproc = budget_node_hook;
+    if (settings && settings->invariant != INVARIANT_NONE) {
+        invariant_proc = invariant_procs[settings->invariant];
+        options.invarproc = timed_invariant;
+        options.mininvarlevel = 0;
+        options.maxinvarlevel = settings->invar_level;
+        options.invararg = settings->invar_arg;
+    }
+
+    const double start = thread_cpu_time();
+    invariant_time = 0.0;
+    start_budget(budget);
+#ifdef SMALL_NAUTY
+    // Fixed size builds run without hooks, so budget and invariants are left to generic build
+    if (budget || options.invarproc || !canonical_form_fixed(g, canon, n, &stats))
+#endif
+    densenauty(g,lab,ptn,orbits,&options,&stats,m,n,canon);
+    const bool exceeded = finish_budget(budget);
+    const double end = thread_cpu_time();
+
+    if (aborted) *aborted = exceeded;
+    if (search) {
+        copy_search_stats(&stats, search);
+        search->invariant_time = invariant_time;
+    }
+    return end - start;
+}
+
+/* Canonicalises dense graph with sparsenauty or Traces, see canonical_form_sparsegraph. */
+double canonical_form_sparse(graph *g, const int n, Engine engine, int **certificate, size_t *size, const LabellingSettings *settings, bool *aborted, SearchStats *search) {
+    static TLS_ATTR SG_DECL(sg);
+
+    // Conversion is a property of the input format, so it is not measured
+    nauty_to_sg(g, &sg, SETWORDSNEEDED(n), n);
+
+    return canonical_form_sparsegraph(&sg, engine, certificate, size, settings, aborted, search);
+}
+
+/* Canonicalises graph with sparsenauty or Traces. Certificate is written as degree of each
+   canonical vertex followed by its sorted neighbours, so certificates can be compared with memcmp.
+   If budget is exceeded, search is aborted, aborted is set and no certificate is written. Invariants are not used here. */
+double canonical_form_sparsegraph(sparsegraph *sg, Engine engine, int **certificate, size_t *size, const LabellingSettings *settings, bool *aborted, SearchStats *search) {
+    const Budget *budget = settings ? settings->budget : NULL;
+    DYNALLSTAT(int,lab,lab_sz);
+    DYNALLSTAT(int,ptn,ptn_sz);
+    DYNALLSTAT(int,orbits,orbits_sz);
+    static TLS_ATTR SG_DECL(canon);
+
+    const int n = sg->nv;
+    const int m = SETWORDSNEEDED(n);
+    nauty_check(WORDSIZE,m,n,NAUTYVERSIONID);
+    DYNALLOC1(int,lab,lab_sz,n,"malloc");
     DYNALLOC1(int,ptn,ptn_sz,n,"malloc");
     DYNALLOC1(int,orbits,orbits_sz,n,"malloc");
-    DYNALLOC1(int,map,map_sz,n,"malloc");
-    DYNALLOC2(graph,g1,g1_sz,n,m,"malloc");
-    DYNALLOC2(graph,g2,g2_sz,n,m,"malloc");
-    DYNALLOC2(graph,cg1,cg1_sz,n,m,"malloc");
-    DYNALLOC2(graph,cg2,cg2_sz,n,m,"malloc");
-
-    // Create canonical graphs
-    const clock_t start = clock();
-    densenauty(graph1,lab1,ptn,orbits,&options,&stats,m,n,cg1);
-    densenauty(graph2,lab2,ptn,orbits,&options,&stats,m,n,cg2);
-
-    // Compare canonically labelled graphs
-    size_t k;
-    for (k = 0; k < m*(size_t)n; ++k)
-        if (cg1[k] != cg2[k]) break;
-    bool is_isomorphic = k == m*(size_t)n;
-    if (should_be_isomorphic != is_isomorphic) {
-        printf("Error: graphs with n=%d vertexes should be is_isomorphic=%hhd but was is_isomorphic=%hhd\n", n, should_be_isomorphic, is_isomorphic);
+
+    const double start = thread_cpu_time();
+    start_budget(budget);
+    if (engine == ENGINE_TRACES) {
+        DEFAULTOPTIONS_TRACES(options);
+        TracesStats stats;
+        options.getcanon = TRUE;
+        Traces(sg,lab,ptn,orbits,&options,&stats,&canon);
+        if (search) {
+            search->nodes = stats.numnodes;
+            search->bad_leaves = 0;
+            search->max_level = stats.treedepth;
+            search->log10_group_size = log10(stats.grpsize1) + stats.grpsize2;
+            search->orbits = stats.numorbits;
+            search->invariant_time = 0.0;
+        }
+    } else {
+        DEFAULTOPTIONS_SPARSEGRAPH(options);
+        statsblk stats;
+        options.getcanon = TRUE;
+        if (budget) options.usernodeproc = budget_node_hook;
+        sparsenauty(sg,lab,ptn,orbits,&options,&stats,&canon);
+        if (search) {
+            copy_search_stats(&stats, search);
+            search->invariant_time = 0.0;
+        }
+    }
+    const bool exceeded = finish_budget(budget);
+    if (!exceeded) sortlists_sg(&canon);
+    const double end = thread_cpu_time();
+
+    if (aborted) *aborted = exceeded;
+    if (exceeded) {
+        *certificate = NULL;
+        *size = 0;
+        return end - start;
+    }
+
+    // Serialise canonical graph
+    *size = (n + canon.nde) * sizeof(int);
+    *certificate = malloc(*size);
+    if (!*certificate) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
         exit(EXIT_FAILURE);
     }
-    const clock_t end = clock();
+    size_t pos = 0;
+    for (int v = 0; v < n; v++) {
+        (*certificate)[pos++] = canon.d[v];
+        memcpy(*certificate + pos, canon.e + canon.v[v], canon.d[v] * sizeof(int));
+        pos += canon.d[v];
+    }
+
+    return end - start;
+}
+
+#ifdef SMALL_NAUTY
+/* process_small.exe routes graphs of at most SMALL_NAUTY_MAXN vertices to nauty build with the smallest
+   sufficient MAXN. Returns false for larger graphs, which are left to generic build. */
+bool canonical_form_fixed(graph *g, graph *canon, const int n, statsblk *stats) {
+    switch (SETWORDSNEEDED(n)) {
+        case 1:
+            canonical_form_small_m1(g, canon, n, stats);
+            return true;
+        case 2:
+            canonical_form_small_m2(g, canon, n, stats);
+            return true;
+        case 3:
+        case 4:
+            canonical_form_small_m4(g, canon, n, stats);
+            return true;
+        default:
+            return false;
+    }
+}
+#endif
+
+void start_budget(const Budget *budget) {
+    if (!budget) return;
+    budget_nodes_left = budget->nodes > 0 ? budget->nodes : -1;
+    budget_deadline = budget->time > 0 ? monotonic_time() + budget->time : -1.0;
+    budget_exceeded = false;
+}
+
+/* Returns true if search was aborted, kill request must be cleared before next call of nauty */
+bool finish_budget(const Budget *budget) {
+    if (!budget) return false;
+    nauty_kill_request = 0;
+    return budget_exceeded;
+}
+
+/* Called by nauty for every node of search tree */
+void budget_node_hook(graph *g, int *lab, int *ptn, int level, int numcells, int tc, int code, int m, int n) {
+    (void)g; (void)lab; (void)ptn; (void)level; (void)numcells; (void)tc; (void)code; (void)m; (void)n;
+    if (budget_nodes_left > 0) budget_nodes_left--;
+    if (budget_nodes_left == 0 || (budget_deadline > 0 && monotonic_time() > budget_deadline)) {
+        budget_exceeded = true;
+        nauty_kill_request = 1;
+    }
+}
+
+/* Group size is kept by nauty as grpsize1 * 10^grpsize2 */
+void copy_search_stats(const statsblk *stats, SearchStats *search) {
+    search->nodes = stats->numnodes;
+    search->bad_leaves = stats->numbadleaves;
+    search->max_level = stats->maxlevel;
+    search->log10_group_size = log10(stats->grpsize1) + stats->grpsize2;
+    search->orbits = stats->numorbits;
+}
 
-    return (double)(end - start) / CLOCKS_PER_SEC;
+/* Invariant of nauty wrapped with timer, so its time can be reported apart from the rest of search */
+void timed_invariant(graph *g, int *lab, int *ptn, int level, int numcells, int tvpos, int *invar, int invararg, boolean digraph, int m, int n) {
+    const double start = thread_cpu_time();
+    invariant_proc(g, lab, ptn, level, numcells, tvpos, invar, invararg, digraph, m, n);
+    invariant_time += thread_cpu_time() - start;
 }
@@ -1,10 +1,80 @@
 #ifndef NAUTY_ISOMORPHISM_H
 #define NAUTY_ISOMORPHISM_H
 
+#include <math.h>
 #include <stdbool.h>
 #include <time.h>
 #include "nauty.h"
+#include "nausparse.h"
+#include "traces.h"
+#include "nautinv.h"
+#include "timer.h"
+#ifdef SMALL_NAUTY
+#include "small_nauty.h"
+#endif
 
-double check_isomorphism_nauty(graph*, graph*, const int, bool);
+// Graphs with edge density below this threshold are canonicalised by sparse engines in auto mode
+#define AUTO_SPARSE_DENSITY 0.1
+// Sparse graphs with at least this many vertices are canonicalised by Traces in auto mode
+#define AUTO_TRACES_MIN_N 100
 
-#endif
\ No newline at end of file
+typedef enum {
+    ENGINE_DENSE = 0,
+    ENGINE_SPARSE,
+    ENGINE_TRACES,
+    ENGINE_AUTO,
+    ENGINE_VF2PP,       // Direct matching of pairs, graphs get no canonical form
+    ENGINE_COUNT
+} Engine;
+
+/* Limits of one canonical labelling, search is aborted when one of them is exceeded.
+   Traces has no node hook, so it is never aborted. */
+typedef struct {
+    double time;    // Wall-clock seconds, 0 means no limit
+    long nodes;     // Nodes of search tree, 0 means no limit
+} Budget;
+
+typedef enum {
+    INVARIANT_NONE = 0,
+    INVARIANT_CELLQUADS,
+    INVARIANT_CELLFANO,
+    INVARIANT_DISTANCES,
+    INVARIANT_ADJTRIANG,
+    INVARIANT_AUTO,
+    INVARIANT_COUNT
+} Invariant;
+
+/* Settings of canonical labelling, the same for all graphs of a set, so their certificates are comparable */
+typedef struct {
+    const Budget *budget;   // NULL means no limit
+    Invariant invariant;    // Vertex invariant of dense engine, never INVARIANT_AUTO
+    int invar_level;        // Invariant is applied on levels 0..invar_level of search tree
+    int invar_arg;          // Argument of invariant, e.g. maximal distance for distances
+} LabellingSettings;
+
+/* Search statistics of one canonical labelling */
+typedef struct {
+    unsigned long nodes;        // Nodes of search tree
+    unsigned long bad_leaves;   // Leaves which did not give automorphism, Traces does not count them
+    int max_level;              // Depth of search tree
+    double log10_group_size;    // Decimal logarithm of automorphism group size
+    int orbits;                 // Orbits of automorphism group
+    double invariant_time;      // Part of labelling time spent in vertex invariant
+} SearchStats;
+
+Engine parse_engine(const char*);
+const char* engine_name(Engine);
+void format_engines(const int, char*, const size_t);
+Engine select_engine(graph*, const int, Engine, const bool);
+Engine select_engine_by_degrees(const size_t, const int, Engine, const bool);
+Invariant parse_invariant(const char*);
+const char* invariant_name(Invariant);
+
+double canonical_form_nauty(graph*, graph*, const int, const LabellingSettings*, bool*, SearchStats*);
+double canonical_form_sparse(graph*, const int, Engine, int**, size_t*, const LabellingSettings*, bool*, SearchStats*);
+double canonical_form_sparsegraph(sparsegraph*, Engine, int**, size_t*, const LabellingSettings*, bool*, SearchStats*);
+#ifdef SMALL_NAUTY
+bool canonical_form_fixed(graph*, graph*, const int, statsblk*);
+#endif
+
+#endif
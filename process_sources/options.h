@@ -0,0 +1,33 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nauty_isomorphism.h"
+#include "certificate_store.h"
+#include "checkpoint.h"
+#include "special_solvers.h"
+#include "shard.h"
+
+typedef struct {
+    int solvers;        // --opt_tree, --solvers, bitmask (1 << Solver) of special solvers used where possible
+    Engine engine;      // --engine, canonical labelling engine
+    int threads;        // --threads, number of worker threads
+    int warmup;         // --warmup, unmeasured runs of each graph set
+    int repetitions;    // --reps, measured runs of each graph set
+    bool pin;           // --pin, pin worker threads to CPUs
+    int prefetch;       // --prefetch, files read ahead by reader thread in single-threaded mode, 0 disables
+    int relabel;        // --self_relabel, isomorphic set is first graph of file and this many relabellings, 0 disables
+    uint64_t seed;      // --seed, seed of relabellings
+    bool prefilter;     // --prefilter, reject pairs by cheap invariants before canonical labelling
+    Invariant invariant;    // --invariant, vertex invariant of dense engine
+    int invar_level;        // --invarlev, deepest level of search tree where invariant is applied
+    int invar_arg;          // --invararg, argument of invariant
+    bool instrument;    // --instrument, collect search statistics, hardware counters and peak RSS
+    Budget budget;      // --budget_time, --budget_nodes, limits of one canonical labelling
+    CertificateStore *store;    // --store, persistent canonical certificates, NULL if not used
+    Checkpoint *checkpoint;     // --checkpoint, results of finished files, NULL if not used
+    const ShardPlan *shard;     // --shard, files processed by this run, NULL processes all files
+} Options;
+
+#endif
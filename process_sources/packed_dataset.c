@@ -0,0 +1,235 @@
+#include <unistd.h>
+#include "packed_dataset.h"
+#include "graph_reader.h"
+#include "file_processor.h"
+
+// CSR vertex offsets are used in place as size_t of sparsegraph
+_Static_assert(sizeof(size_t) == sizeof(uint64_t), "packed CSR section requires 64-bit size_t");
+
+void read_packed_header(FILE*, const char*, PackedHeader*);
+void check_packed_header(const PackedHeader*, const size_t, const char*);
+void pack_directory(const char*, const bool);
+void write_packed_set(FILE*, const GraphFile*, const char*, PackedSetEntry*, const bool);
+void write_padding(FILE*, const size_t, const char*);
+void write_bytes(FILE*, const void*, const size_t, const char*);
+
+/* Path of packed dataset of directory, true if it exists */
+bool packed_dataset_path(const char *path, char *packed, const size_t size) {
+    snprintf(packed, size, "%s%s", path, PACKED_DATASET_NAME);
+    return access(packed, R_OK) == 0;
+}
+
+/* Validates mapped packed dataset and finds set with n vertices */
+const PackedSetEntry* find_packed_set(const char *data, const size_t length, const int n, const char *filename) {
+    if (length < sizeof(PackedHeader)) {
+        fprintf(stderr, "Error: %s is not a packed dataset\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    const PackedHeader *header = (const PackedHeader*)data;
+    check_packed_header(header, length, filename);
+
+    const PackedSetEntry *entries = (const PackedSetEntry*)(data + header->index_offset);
+    for (uint32_t s = 0; s < header->set_count; s++) {
+        if (entries[s].n != n) continue;
+        const PackedSetEntry *entry = &entries[s];
+        if (entry->rows_offset + entry->count * entry->stride > length ||
+            (entry->flags & PACKED_CSR && entry->csr_offset + entry->count * sizeof(uint64_t) > length)) {
+            fprintf(stderr, "Error: Packed dataset %s is truncated\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        return entry;
+    }
+    fprintf(stderr, "Error: Packed dataset %s has no set with %d vertices\n", filename, n);
+    exit(EXIT_FAILURE);
+}
+
+/* Orders of sets of packed dataset in ascending order, returns number of sets */
+int read_packed_orders(const char *filename, int **nodes) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Unable to open file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    PackedHeader header;
+    read_packed_header(file, filename, &header);
+
+    *nodes = malloc((header.set_count > 0 ? header.set_count : 1) * sizeof(int));
+    if (!(*nodes)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    fseeko(file, header.index_offset, SEEK_SET);
+    for (uint32_t s = 0; s < header.set_count; s++) {
+        PackedSetEntry entry;
+        if (fread(&entry, sizeof(entry), 1, file) != 1) {
+            fprintf(stderr, "Error: Packed dataset %s is truncated\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        (*nodes)[s] = entry.n;
+    }
+    fclose(file);
+    return header.set_count;
+}
+
+void read_packed_header(FILE *file, const char *filename, PackedHeader *header) {
+    if (fread(header, sizeof(PackedHeader), 1, file) != 1) {
+        fprintf(stderr, "Error: %s is not a packed dataset\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    fseeko(file, 0, SEEK_END);
+    check_packed_header(header, ftello(file), filename);
+}
+
+void check_packed_header(const PackedHeader *header, const size_t length, const char *filename) {
+    if (memcmp(header->magic, PACKED_MAGIC, sizeof(header->magic)) != 0) {
+        fprintf(stderr, "Error: %s is not a packed dataset\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    if (header->wordsize != WORDSIZE) {
+        fprintf(stderr, "Error: %s was packed with %u-bit setwords, this build uses %d-bit setwords, pack it again\n",
+                filename, header->wordsize, WORDSIZE);
+        exit(EXIT_FAILURE);
+    }
+    if (header->length != length || header->index_offset + header->set_count * sizeof(PackedSetEntry) > length) {
+        fprintf(stderr, "Error: Packed dataset %s is truncated\n", filename);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Packs <n>.g6 files of each directory of dataset into PACKED_DATASET_NAME next to them. Text files are kept, but
+   directory with packed dataset is read only from it, so it has to be packed again after its files change. */
+void pack_dataset(const char *dataset_path, const bool csr) {
+    char dataset[1024];
+    const size_t length = strlen(dataset_path);
+    snprintf(dataset, sizeof(dataset), "%s%s", dataset_path, length > 0 && dataset_path[length - 1] == '/' ? "" : "/");
+    for (int kind = 1; kind >= 0; kind--) {
+        char path[1024];
+        if (dataset_directory(dataset, kind, path, sizeof(path)))
+            pack_directory(path, csr);
+    }
+}
+
+void pack_directory(const char *path, const bool csr) {
+    Result names;
+    list_graph_files(path, &names);
+
+    // Written under temporary name, so interrupted packing does not leave truncated dataset behind
+    char filename[1100], temporary[1110];
+    packed_dataset_path(path, filename, sizeof(filename));
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE *file = fopen(temporary, "w+b");
+    if (!file) {
+        fprintf(stderr, "Error: Unable to open file %s\n", temporary);
+        exit(EXIT_FAILURE);
+    }
+
+    PackedHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PACKED_MAGIC, sizeof(header.magic));
+    header.wordsize = WORDSIZE;
+    header.set_count = names.count;
+    header.index_offset = sizeof(PackedHeader);
+    PackedSetEntry *entries = calloc(names.count > 0 ? names.count : 1, sizeof(PackedSetEntry));
+    if (!entries) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    write_padding(file, header.index_offset + names.count * sizeof(PackedSetEntry), temporary);
+
+    long graphs = 0;
+    for (int s = 0; s < names.count; s++) {
+        char graph_file[1280];
+        snprintf(graph_file, sizeof(graph_file), "%s%d.g6", path, (names.nodes)[s]);
+        GraphFile text;
+        open_graph_file(graph_file, &text);
+        entries[s].n = (names.nodes)[s];
+        write_packed_set(file, &text, graph_file, &entries[s], csr);
+        graphs += text.count;
+        close_graph_file(&text);
+    }
+
+    // Index is known only now
+    header.length = ftello(file);
+    fseeko(file, 0, SEEK_SET);
+    write_bytes(file, &header, sizeof(header), temporary);
+    write_bytes(file, entries, names.count * sizeof(PackedSetEntry), temporary);
+    if (fclose(file) != 0 || rename(temporary, filename) != 0) {
+        fprintf(stderr, "Error: Unable to write file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    printf("%d sets with %ld graphs packed into %s (%.1f MB).\n", names.count, graphs, filename, header.length / 1e6);
+    free(entries);
+    free(names.nodes);
+}
+
+void write_packed_set(FILE *file, const GraphFile *text, const char *filename, PackedSetEntry *entry, const bool csr) {
+    const int n = entry->n;
+    const int m = SETWORDSNEEDED(n);
+    const size_t rows = (size_t)m * n * sizeof(setword);
+    entry->count = text->count;
+    entry->m = m;
+    entry->flags = csr ? PACKED_CSR : 0;
+    entry->stride = (rows + PACKED_ALIGNMENT - 1) / PACKED_ALIGNMENT * PACKED_ALIGNMENT;
+
+    // Rows of every graph start at aligned offset
+    const uint64_t start = ftello(file);
+    entry->rows_offset = (start + PACKED_ALIGNMENT - 1) / PACKED_ALIGNMENT * PACKED_ALIGNMENT;
+    write_padding(file, entry->rows_offset - start, filename);
+    for (int i = 0; i < text->count; i++) {
+        if (graph_file_order(text, i) != n) {
+            fprintf(stderr, "Error: Graph %d of %s has %d vertices, not %d\n", i + 1, filename, graph_file_order(text, i), n);
+            exit(EXIT_FAILURE);
+        }
+        write_bytes(file, get_graph(text, i), rows, filename);
+        write_padding(file, entry->stride - rows, filename);
+    }
+    if (!csr) return;
+
+    // Offsets of CSR blocks are patched after blocks are written
+    uint64_t *blocks = malloc((text->count > 0 ? text->count : 1) * sizeof(uint64_t));
+    size_t *v = malloc(n * sizeof(size_t));
+    if (!blocks || !v) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    entry->csr_offset = ftello(file);
+    write_padding(file, text->count * sizeof(uint64_t), filename);
+    for (int i = 0; i < text->count; i++) {
+        blocks[i] = ftello(file);
+        sparsegraph *sg = get_sparse_graph(text, i);
+
+        // Neighbour lists are written contiguously, whatever gaps decoded graph had
+        uint64_t nde = 0;
+        for (int u = 0; u < n; u++) {
+            v[u] = nde;
+            nde += (sg->d)[u];
+        }
+        write_bytes(file, &nde, sizeof(nde), filename);
+        write_bytes(file, v, n * sizeof(size_t), filename);
+        write_bytes(file, sg->d, n * sizeof(int), filename);
+        for (int u = 0; u < n; u++)
+            write_bytes(file, sg->e + (sg->v)[u], (sg->d)[u] * sizeof(int), filename);
+        write_padding(file, (n + nde) * sizeof(int) % sizeof(uint64_t), filename);
+    }
+    const uint64_t end = ftello(file);
+    fseeko(file, entry->csr_offset, SEEK_SET);
+    write_bytes(file, blocks, text->count * sizeof(uint64_t), filename);
+    fseeko(file, end, SEEK_SET);
+    free(blocks);
+    free(v);
+}
+
+void write_padding(FILE *file, const size_t length, const char *filename) {
+    static const char zeros[PACKED_ALIGNMENT];
+    for (size_t written = 0; written < length; written += PACKED_ALIGNMENT) {
+        const size_t chunk = length - written < PACKED_ALIGNMENT ? length - written : PACKED_ALIGNMENT;
+        write_bytes(file, zeros, chunk, filename);
+    }
+}
+
+void write_bytes(FILE *file, const void *data, const size_t length, const char *filename) {
+    if (length > 0 && fwrite(data, 1, length, file) != length) {
+        fprintf(stderr, "Error: Unable to write file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+}
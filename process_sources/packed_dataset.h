@@ -0,0 +1,49 @@
+#ifndef PACKED_DATASET_H
+#define PACKED_DATASET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nauty.h"
+
+/* Binary container of all graph sets of one dataset directory, graphs are used directly from mapping without decoding.
+   Layout:
+       PackedHeader
+       PackedSetEntry of each set, ascending n
+       per set: adjacency rows of each graph, every graph starts at multiple of PACKED_ALIGNMENT bytes,
+                optional CSR section: offset of each graph block, then blocks of nde, v[n], d[n], e[nde]
+   Numbers are in native byte order and setwords of the nauty build which packed the file. */
+#define PACKED_DATASET_NAME "dataset.gpk"
+#define PACKED_MAGIC "GIPACK01"
+#define PACKED_ALIGNMENT 64
+
+// Flags of PackedSetEntry
+#define PACKED_CSR 1
+
+typedef struct {
+    char magic[8];
+    uint32_t wordsize;      // WORDSIZE of setwords in rows
+    uint32_t set_count;
+    uint64_t index_offset;  // Offset of first PackedSetEntry
+    uint64_t length;        // Length of whole file, truncated file is rejected
+    uint8_t reserved[32];
+} PackedHeader;
+
+typedef struct {
+    int32_t n;
+    int32_t count;          // Graphs in set
+    uint32_t m;             // Setwords per row
+    uint32_t flags;
+    uint64_t rows_offset;   // Rows of first graph
+    uint64_t stride;        // Bytes from rows of one graph to the next one
+    uint64_t csr_offset;    // Offsets of CSR blocks of graphs, 0 without CSR section
+} PackedSetEntry;
+
+bool packed_dataset_path(const char*, char*, const size_t);
+const PackedSetEntry* find_packed_set(const char*, const size_t, const int, const char*);
+int read_packed_orders(const char*, int**);
+void pack_dataset(const char*, const bool);
+
+#endif
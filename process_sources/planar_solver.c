@@ -0,0 +1,1380 @@
+#include "planar_solver.h"
+
+/* Darts: edge e has darts 2e and 2e+1, dart d goes from ends[d] to ends[d ^ 1] */
+
+typedef struct {
+    int low;    // Edges, -1 if interval is empty
+    int high;
+} Interval;
+
+typedef struct {
+    Interval left;
+    Interval right;
+} ConflictPair;
+
+/* State of left-right planarity test of Brandes, "The Left-Right Planarity Test" (2009) */
+typedef struct {
+    int n;
+    int m;
+    const int *ends;
+    int *adjacency_start;   // Darts leaving each vertex
+    int *adjacency;
+    int *height;            // Height of vertex in DFS tree, -1 if not visited
+    int *parent_edge;
+    int *tail;              // Tail of edge in DFS orientation, -1 if not oriented
+    int *lowpt;
+    int *lowpt2;
+    int *nesting;           // Nesting depth, signed by side after testing
+    int *ref;
+    int *side;
+    int *lowpt_edge;
+    int *stack_bottom;      // Size of conflict stack when edge was reached
+    int *out_start;         // Oriented edges leaving each vertex, sorted by nesting depth
+    int *out_edges;
+    ConflictPair *stack;
+    int stack_size;
+} LRState;
+
+typedef struct {
+    int key;
+    int edge;
+} EdgeKey;
+
+typedef struct {
+    int low;    // Smaller endpoint in skeleton
+    int high;
+    int edge;
+} EdgeEnds;
+
+// Types of triconnected components
+enum {SKELETON_REMOVED = -1, SKELETON_UNKNOWN, SKELETON_BOND, SKELETON_POLYGON, SKELETON_RIGID, SKELETON_PAIR};
+
+/* Triconnected components of biconnected block, found by splitting at separation pairs. Edges are edges of graph
+   and pairs of virtual edges created by splits. Vertices are indices of vertices within block. */
+typedef struct {
+    int k;                  // Vertex count of block
+    IntBuffer ends;         // Endpoints of edge e are ends[2e] and ends[2e + 1]
+    IntBuffer twin;         // Virtual edge paired with e, -1 for edge of graph
+    IntBuffer owner;        // Skeleton containing e, -1 for virtual edges removed by merging
+    IntBuffer type;         // Type of each skeleton
+    IntBuffer *edges;       // Edges of each skeleton
+    int edges_capacity;
+    bool planar;            // Cleared when a skeleton is not planar
+} Decomposition;
+
+/* Skeleton of one node of SPQR tree, with its own vertex and edge numbering */
+typedef struct {
+    int type;
+    int vertex_count;
+    int edge_count;
+    int *vertices;      // Vertex of block for each vertex of skeleton
+    int *edges;         // Edge of decomposition for each edge of skeleton
+    int *ends;          // Endpoints of darts in vertices of skeleton
+    int *cw;            // Next dart around its tail in clockwise order, polygons and rigid skeletons only
+    int *ccw;
+    int *degree;
+    int parent_edge;    // Edge shared with parent node, -1 in root
+} Skeleton;
+
+int lr_head(const LRState*, const int);
+int lr_out_dart(const LRState*, const int);
+void lr_orientation(LRState*, const int, int*, int*, bool*);
+bool lr_testing(LRState*, const int, int*, int*, bool*);
+bool lr_add_constraints(LRState*, const int, const int);
+void lr_remove_back_edges(LRState*, const int);
+int lr_sign(LRState*, const int, int*);
+void lr_sort_out_edges(LRState*, EdgeKey*);
+void lr_embedding(LRState*, const int, int*, int*, int*, int*, int*, int*, int*);
+bool interval_empty(const Interval*);
+bool interval_conflicting(const LRState*, const Interval*, const int);
+int pair_lowest(const LRState*, const ConflictPair*);
+void insert_dart_cw(int*, int*, const int, const int);
+void insert_dart_ccw(int*, int*, int*, const int, const int, const int);
+int count_faces(const int, const int*);
+int compare_edge_keys(const void*, const void*);
+
+int new_skeleton(Decomposition*, const int);
+int new_edge(Decomposition*, const int, const int, const int);
+void new_virtual_pair(Decomposition*, const int, const int, const int, const int);
+bool decompose_block(Decomposition*);
+void split_skeleton(Decomposition*, const int, IntBuffer*, int*);
+int compare_edge_ends(const void*, const void*);
+bool split_chains(Decomposition*, const int, const int, const int*, const int*, const int*, const int*, int*);
+bool find_separation_pair(const int, const int, const int*, const int*, const int*, const int*, int*, int*);
+int merge_skeletons(Decomposition*);
+int find_skeleton(int*, int);
+void free_decomposition(Decomposition*);
+bool build_skeleton(const Decomposition*, const int*, const int, Skeleton*);
+bool skeleton_code(const Skeleton*, const int, const bool, const int*, const int*, IntBuffer*, const IntBuffer*, int*);
+void bond_code(const Skeleton*, const int, const int*, const int*, IntBuffer*);
+void node_code(const Skeleton*, const int, const bool, const int*, const int*, IntBuffer*, IntBuffer*, int*);
+bool code_less(const IntBuffer*, const IntBuffer*);
+
+/* Embedding of simple connected graph by left-right planarity test. Writes rotation system as next dart
+   around the tail of each dart in clockwise and counterclockwise order. Returns false if graph is not planar.
+   Rotation system is checked by Euler's formula, so a returned embedding is always planar. */
+bool planar_embedding(const int n, const int m, const int *ends, int *cw, int *ccw) {
+    if (n >= 3 && m > 3 * n - 6)
+        return false;
+
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    LRState state;
+    LRState *s = &state;
+    s->n = n;
+    s->m = m;
+    s->ends = ends;
+    s->adjacency_start = allocate_solver_array((size_t)n + 1);
+    s->adjacency = allocate_solver_array(2 * (size_t)m);
+    s->height = allocate_solver_array(n);
+    s->parent_edge = allocate_solver_array(n);
+    s->tail = allocate_solver_array(m);
+    s->lowpt = allocate_solver_array(m);
+    s->lowpt2 = allocate_solver_array(m);
+    s->nesting = allocate_solver_array(m);
+    s->ref = allocate_solver_array(m);
+    s->side = allocate_solver_array(m);
+    s->lowpt_edge = allocate_solver_array(m);
+    s->stack_bottom = allocate_solver_array(m);
+    s->out_start = allocate_solver_array((size_t)n + 1);
+    s->out_edges = allocate_solver_array(m);
+    s->stack = arena_alloc(arena, ((size_t)m + 1) * sizeof(ConflictPair));
+    s->stack_size = 0;
+    int *stack = allocate_solver_array(2 * (size_t)n + 2);
+    int *index = allocate_solver_array(n);
+    int *chain = allocate_solver_array(m);
+    bool *flags = arena_calloc(arena, 2 * (size_t)m + 1, sizeof(bool));
+    EdgeKey *keys = arena_alloc(arena, ((size_t)m + 1) * sizeof(EdgeKey));
+
+    for (int v = 0; v <= n; v++)
+        s->adjacency_start[v] = 0;
+    for (int d = 0; d < 2 * m; d++)
+        s->adjacency_start[ends[d] + 1]++;
+    for (int v = 0; v < n; v++)
+        s->adjacency_start[v + 1] += s->adjacency_start[v];
+    for (int v = 0; v < n; v++)
+        index[v] = s->adjacency_start[v];
+    for (int d = 0; d < 2 * m; d++)
+        s->adjacency[index[ends[d]]++] = d;
+    for (int v = 0; v < n; v++) {
+        s->height[v] = -1;
+        s->parent_edge[v] = -1;
+    }
+    for (int e = 0; e < m; e++) {
+        s->tail[e] = -1;
+        s->ref[e] = -1;
+        s->side[e] = 1;
+        s->lowpt_edge[e] = -1;
+    }
+
+    // Orientation, computes lowpoints and nesting depths
+    for (int v = 0; v < n; v++)
+        index[v] = s->adjacency_start[v];
+    for (int root = 0; root < n; root++) {
+        if (s->height[root] >= 0)
+            continue;
+        s->height[root] = 0;
+        lr_orientation(s, root, stack, index, flags);
+    }
+
+    // Testing, finds constraints on sides of edges
+    lr_sort_out_edges(s, keys);
+    memset(flags, 0, 2 * (size_t)m * sizeof(bool));
+    for (int v = 0; v < n; v++)
+        index[v] = s->out_start[v];
+    bool planar = true;
+    for (int root = 0; root < n && planar; root++)
+        if (s->parent_edge[root] < 0)
+            planar = lr_testing(s, root, stack, index, flags);
+
+    if (planar) {
+        // Embedding, edges are sorted by signed nesting depth
+        for (int e = 0; e < m; e++)
+            s->nesting[e] *= lr_sign(s, e, chain);
+        lr_sort_out_edges(s, keys);
+
+        int *first = allocate_solver_array(n);
+        int *left_ref = allocate_solver_array(n);
+        int *right_ref = allocate_solver_array(n);
+        for (int v = 0; v < n; v++) {
+            first[v] = -1;
+            int previous = -1;
+            for (int k = s->out_start[v]; k < s->out_start[v + 1]; k++) {
+                const int d = lr_out_dart(s, s->out_edges[k]);
+                if (previous < 0) {
+                    cw[d] = ccw[d] = d;
+                    first[v] = d;
+                } else {
+                    insert_dart_cw(cw, ccw, previous, d);
+                }
+                previous = d;
+            }
+        }
+        for (int v = 0; v < n; v++)
+            index[v] = s->out_start[v];
+        for (int root = 0; root < n; root++)
+            if (s->parent_edge[root] < 0)
+                lr_embedding(s, root, stack, index, first, left_ref, right_ref, cw, ccw);
+
+        // Euler's formula for connected plane graph
+        planar = n - m + count_faces(m, cw) == 2;
+    }
+
+    arena_release(arena, mark);
+    return planar;
+}
+
+int lr_head(const LRState *s, const int e) {
+    return s->ends[2 * e] == s->tail[e] ? s->ends[2 * e + 1] : s->ends[2 * e];
+}
+
+int lr_out_dart(const LRState *s, const int e) {
+    return s->ends[2 * e] == s->tail[e] ? 2 * e : 2 * e + 1;
+}
+
+/* DFS orienting edges, with explicit stack. Vertex is pushed again before its child, flag of the tree dart marks
+   that its child was already visited. */
+void lr_orientation(LRState *s, const int root, int *stack, int *index, bool *descended) {
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const int v = stack[--top];
+        const int e = s->parent_edge[v];
+        bool descend = false;
+        while (index[v] < s->adjacency_start[v + 1] && !descend) {
+            const int d = s->adjacency[index[v]];
+            const int edge = d >> 1;
+            const int w = s->ends[d ^ 1];
+            if (!descended[d]) {
+                if (s->tail[edge] >= 0) {
+                    index[v]++;
+                    continue;
+                }
+                s->tail[edge] = v;
+                s->lowpt[edge] = s->lowpt2[edge] = s->height[v];
+                if (s->height[w] < 0) {
+                    s->parent_edge[w] = edge;
+                    s->height[w] = s->height[v] + 1;
+                    stack[top++] = v;
+                    stack[top++] = w;
+                    descended[d] = true;
+                    descend = true;
+                    continue;
+                }
+                s->lowpt[edge] = s->height[w];
+            }
+
+            // Chordal edges are nested after others with the same lowpoint
+            s->nesting[edge] = 2 * s->lowpt[edge] + (s->lowpt2[edge] < s->height[v]);
+
+            // Update lowpoints of parent edge
+            if (e >= 0) {
+                if (s->lowpt[edge] < s->lowpt[e]) {
+                    s->lowpt2[e] = s->lowpt[e] < s->lowpt2[edge] ? s->lowpt[e] : s->lowpt2[edge];
+                    s->lowpt[e] = s->lowpt[edge];
+                } else if (s->lowpt[edge] > s->lowpt[e]) {
+                    if (s->lowpt[edge] < s->lowpt2[e]) s->lowpt2[e] = s->lowpt[edge];
+                } else {
+                    if (s->lowpt2[edge] < s->lowpt2[e]) s->lowpt2[e] = s->lowpt2[edge];
+                }
+            }
+            index[v]++;
+        }
+    }
+}
+
+bool lr_testing(LRState *s, const int root, int *stack, int *index, bool *tested) {
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const int v = stack[--top];
+        const int e = s->parent_edge[v];
+        bool descend = false;
+        while (index[v] < s->out_start[v + 1]) {
+            const int ei = s->out_edges[index[v]];
+            const int w = lr_head(s, ei);
+            if (!tested[ei]) {
+                s->stack_bottom[ei] = s->stack_size;
+                if (ei == s->parent_edge[w]) {
+                    stack[top++] = v;
+                    stack[top++] = w;
+                    tested[ei] = true;
+                    descend = true;
+                    break;
+                }
+                s->lowpt_edge[ei] = ei;
+                ConflictPair pair = {{-1, -1}, {ei, ei}};
+                s->stack[s->stack_size++] = pair;
+            }
+
+            // Integrate new return edges
+            if (s->lowpt[ei] < s->height[v]) {
+                if (index[v] == s->out_start[v])
+                    s->lowpt_edge[e] = s->lowpt_edge[ei];
+                else if (!lr_add_constraints(s, ei, e))
+                    return false;
+            }
+            index[v]++;
+        }
+
+        if (!descend && e >= 0)
+            lr_remove_back_edges(s, e);
+    }
+    return true;
+}
+
+bool lr_add_constraints(LRState *s, const int ei, const int e) {
+    ConflictPair p = {{-1, -1}, {-1, -1}};
+
+    // Merge return edges of ei into right interval
+    do {
+        ConflictPair q = s->stack[--(s->stack_size)];
+        if (!interval_empty(&q.left)) {
+            const Interval swap = q.left;
+            q.left = q.right;
+            q.right = swap;
+        }
+        if (!interval_empty(&q.left))
+            return false;
+        if (s->lowpt[q.right.low] > s->lowpt[e]) {
+            if (interval_empty(&p.right))
+                p.right.high = q.right.high;
+            else
+                s->ref[p.right.low] = q.right.high;
+            p.right.low = q.right.low;
+        } else {
+            s->ref[q.right.low] = s->lowpt_edge[e];
+        }
+    } while (s->stack_size != s->stack_bottom[ei]);
+
+    // Merge conflicting return edges of previous edges into left interval
+    while (s->stack_size > 0 && (interval_conflicting(s, &(s->stack[s->stack_size - 1].left), ei) ||
+                                 interval_conflicting(s, &(s->stack[s->stack_size - 1].right), ei))) {
+        ConflictPair q = s->stack[--(s->stack_size)];
+        if (interval_conflicting(s, &q.right, ei)) {
+            const Interval swap = q.left;
+            q.left = q.right;
+            q.right = swap;
+        }
+        if (interval_conflicting(s, &q.right, ei))
+            return false;
+        if (p.right.low >= 0)
+            s->ref[p.right.low] = q.right.high;
+        if (q.right.low >= 0)
+            p.right.low = q.right.low;
+        if (interval_empty(&p.left))
+            p.left.high = q.left.high;
+        else
+            s->ref[p.left.low] = q.left.high;
+        p.left.low = q.left.low;
+    }
+
+    if (!interval_empty(&p.left) || !interval_empty(&p.right))
+        s->stack[s->stack_size++] = p;
+    return true;
+}
+
+void lr_remove_back_edges(LRState *s, const int e) {
+    const int u = s->tail[e];
+
+    // Drop conflict pairs whose return edges all end at u
+    while (s->stack_size > 0 && pair_lowest(s, &(s->stack[s->stack_size - 1])) == s->height[u]) {
+        const ConflictPair p = s->stack[--(s->stack_size)];
+        if (p.left.low >= 0)
+            s->side[p.left.low] = -1;
+    }
+
+    // Trim the next one
+    if (s->stack_size > 0) {
+        ConflictPair p = s->stack[--(s->stack_size)];
+        while (p.left.high >= 0 && lr_head(s, p.left.high) == u)
+            p.left.high = s->ref[p.left.high];
+        if (p.left.high < 0 && p.left.low >= 0) {
+            s->ref[p.left.low] = p.right.low;
+            s->side[p.left.low] = -1;
+            p.left.low = -1;
+        }
+        while (p.right.high >= 0 && lr_head(s, p.right.high) == u)
+            p.right.high = s->ref[p.right.high];
+        if (p.right.high < 0 && p.right.low >= 0) {
+            s->ref[p.right.low] = p.left.low;
+            s->side[p.right.low] = -1;
+            p.right.low = -1;
+        }
+        s->stack[s->stack_size++] = p;
+    }
+
+    // Side of e is side of its highest return edge
+    if (s->lowpt[e] < s->height[u] && s->stack_size > 0) {
+        const int high_left = s->stack[s->stack_size - 1].left.high;
+        const int high_right = s->stack[s->stack_size - 1].right.high;
+        if (high_left >= 0 && (high_right < 0 || s->lowpt[high_left] > s->lowpt[high_right]))
+            s->ref[e] = high_left;
+        else
+            s->ref[e] = high_right;
+    }
+}
+
+/* Resolves side of edge relative to its reference chain, without recursion */
+int lr_sign(LRState *s, const int e, int *chain) {
+    int length = 0;
+    for (int x = e; s->ref[x] >= 0; x = s->ref[x])
+        chain[length++] = x;
+    for (int i = length - 1; i >= 0; i--) {
+        const int x = chain[i];
+        s->side[x] *= s->side[s->ref[x]];
+        s->ref[x] = -1;
+    }
+    return s->side[e];
+}
+
+void lr_sort_out_edges(LRState *s, EdgeKey *keys) {
+    for (int v = 0; v <= s->n; v++)
+        s->out_start[v] = 0;
+    for (int e = 0; e < s->m; e++)
+        s->out_start[s->tail[e] + 1]++;
+    for (int v = 0; v < s->n; v++)
+        s->out_start[v + 1] += s->out_start[v];
+    for (int e = 0; e < s->m; e++) {
+        EdgeKey key = {s->nesting[e], e};
+        keys[e] = key;
+    }
+    qsort(keys, s->m, sizeof(EdgeKey), compare_edge_keys);
+
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *fill = allocate_solver_array(s->n);
+    for (int v = 0; v < s->n; v++)
+        fill[v] = s->out_start[v];
+    for (int k = 0; k < s->m; k++)
+        s->out_edges[fill[s->tail[keys[k].edge]]++] = keys[k].edge;
+    arena_release(arena, mark);
+}
+
+/* Adds incoming darts to rotation system, tree edges first at child, back edges next to references */
+void lr_embedding(LRState *s, const int root, int *stack, int *index, int *first, int *left_ref, int *right_ref,
+                  int *cw, int *ccw) {
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const int v = stack[--top];
+        while (index[v] < s->out_start[v + 1]) {
+            const int ei = s->out_edges[index[v]++];
+            const int w = lr_head(s, ei);
+            const int out = lr_out_dart(s, ei);
+            const int in = out ^ 1;
+            if (ei == s->parent_edge[w]) {
+                if (first[w] < 0) {
+                    cw[in] = ccw[in] = in;
+                    first[w] = in;
+                } else {
+                    insert_dart_ccw(cw, ccw, first, w, first[w], in);
+                }
+                left_ref[v] = right_ref[v] = out;
+                stack[top++] = v;
+                stack[top++] = w;
+                break;
+            } else if (s->side[ei] == 1) {
+                insert_dart_cw(cw, ccw, right_ref[w], in);
+            } else {
+                insert_dart_ccw(cw, ccw, first, w, left_ref[w], in);
+                left_ref[w] = in;
+            }
+        }
+    }
+}
+
+bool interval_empty(const Interval *interval) {
+    return interval->low < 0 && interval->high < 0;
+}
+
+bool interval_conflicting(const LRState *s, const Interval *interval, const int e) {
+    return !interval_empty(interval) && s->lowpt[interval->high] > s->lowpt[e];
+}
+
+int pair_lowest(const LRState *s, const ConflictPair *pair) {
+    if (interval_empty(&(pair->left)))
+        return s->lowpt[pair->right.low];
+    if (interval_empty(&(pair->right)))
+        return s->lowpt[pair->left.low];
+    const int left = s->lowpt[pair->left.low];
+    const int right = s->lowpt[pair->right.low];
+    return left < right ? left : right;
+}
+
+/* Inserts dart clockwise next to reference */
+void insert_dart_cw(int *cw, int *ccw, const int reference, const int dart) {
+    const int next = cw[reference];
+    cw[reference] = dart;
+    ccw[dart] = reference;
+    cw[dart] = next;
+    ccw[next] = dart;
+}
+
+/* Inserts dart counterclockwise next to reference, it becomes the first dart of vertex instead of reference */
+void insert_dart_ccw(int *cw, int *ccw, int *first, const int vertex, const int reference, const int dart) {
+    insert_dart_cw(cw, ccw, ccw[reference], dart);
+    if (first[vertex] == reference)
+        first[vertex] = dart;
+}
+
+/* Face following dart d continues by the next dart clockwise after its reverse */
+int count_faces(const int m, const int *cw) {
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    bool *visited = arena_calloc(arena, 2 * (size_t)m + 1, sizeof(bool));
+    int faces = 0;
+    for (int d = 0; d < 2 * m; d++) {
+        if (visited[d])
+            continue;
+        faces++;
+        for (int x = d; !visited[x]; x = cw[x ^ 1])
+            visited[x] = true;
+    }
+    arena_release(arena, mark);
+    return faces;
+}
+
+int compare_edge_keys(const void *a, const void *b) {
+    const EdgeKey *k1 = a;
+    const EdgeKey *k2 = b;
+    if (k1->key != k2->key)
+        return (k1->key > k2->key) - (k1->key < k2->key);
+    return (k1->edge > k2->edge) - (k1->edge < k2->edge);
+}
+
+/* Block is encoded by the tree of its triconnected components (SPQR tree), as in Hopcroft and Tarjan's planar
+   isomorphism. Bonds are sorted lists of their edges, polygons and rigid skeletons are BFS codes of their
+   embeddings, which are unique up to mirror image for rigid skeletons (Whitney). Virtual edges carry labels
+   of child nodes in direction of their darts and vertices carry colours, which are labels of their vertex nodes
+   in block-cut tree. The tree is rooted in its center, or in the pair of virtual edges between two centers, and
+   encoded level by level from the deepest one as in encode_tree, each non-root node in both orientations of its
+   parent edge. Block is not encoded if one of its rigid skeletons is not planar. */
+bool encode_planar_block(const Blocks *blocks, const int block, const int parent, const int *label, int *scratch, IntBuffer *out) {
+    const int *block_vertices = blocks->vertices + blocks->start[block];
+    const int k = blocks->start[block + 1] - blocks->start[block];
+    const int *block_edges = blocks->edges + 2 * blocks->edge_start[block];
+    const int m = blocks->edge_start[block + 1] - blocks->edge_start[block];
+
+    // Vertices of block are numbered 0..k-1, parent vertex has no label
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *colour = allocate_solver_array(k);
+    for (int i = 0; i < k; i++) {
+        scratch[block_vertices[i]] = i;
+        colour[i] = block_vertices[i] == parent ? -1 : label[block_vertices[i]];
+    }
+    Decomposition decomposition;
+    memset(&decomposition, 0, sizeof(decomposition));
+    decomposition.k = k;
+    new_skeleton(&decomposition, SKELETON_UNKNOWN);
+    for (int e = 0; e < m; e++) {
+        const int edge = new_edge(&decomposition, scratch[block_edges[2 * e]], scratch[block_edges[2 * e + 1]], 0);
+        push_int(&(decomposition.edges[0]), edge);
+    }
+    for (int i = 0; i < k; i++)
+        scratch[block_vertices[i]] = -1;
+
+    const bool decomposed = decompose_block(&decomposition);
+    const int node_count = decomposed ? merge_skeletons(&decomposition) : 0;
+
+    // Nodes of SPQR tree, edges of decomposition are mapped to node and edge of its skeleton
+    const int edge_total = decomposition.owner.length;
+    Skeleton *nodes = arena_calloc(arena, node_count, sizeof(Skeleton));
+    int *edge_node = allocate_solver_array(edge_total);
+    int *edge_index = allocate_solver_array(edge_total);
+    int *node_of = allocate_solver_array(decomposition.type.length);
+    int node_fill = 0;
+    bool planar = decomposed;
+    for (int t = 0; t < (int)decomposition.type.length; t++) {
+        node_of[t] = -1;
+        if (decomposed && decomposition.type.items[t] != SKELETON_REMOVED && decomposition.edges[t].length > 0)
+            node_of[t] = node_fill++;
+    }
+    for (int t = 0; t < (int)decomposition.type.length; t++) {
+        if (node_of[t] < 0)
+            continue;
+        Skeleton *node = &nodes[node_of[t]];
+        planar = build_skeleton(&decomposition, decomposition.edges[t].items, decomposition.edges[t].length, node) && planar;
+        node->type = decomposition.type.items[t];
+        for (int j = 0; j < node->edge_count; j++) {
+            edge_node[node->edges[j]] = node_of[t];
+            edge_index[node->edges[j]] = j;
+        }
+    }
+
+    if (planar) {
+        // Centers in the middle of the longest path, found by two BFS
+        int *distance = allocate_solver_array(node_count);
+        int *tree_parent = allocate_solver_array(node_count);
+        int *order = allocate_solver_array(node_count);
+        int *level_start = allocate_solver_array((size_t)node_count + 2);
+        int a = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            for (int x = 0; x < node_count; x++)
+                distance[x] = -1;
+            int head = 0, tail = 0;
+            order[tail++] = a;
+            distance[a] = 0;
+            tree_parent[a] = -1;
+            while (head < tail) {
+                const int x = order[head++];
+                const Skeleton *node = &nodes[x];
+                for (int j = 0; j < node->edge_count; j++) {
+                    const int twin = decomposition.twin.items[node->edges[j]];
+                    if (twin < 0 || decomposition.owner.items[twin] < 0)
+                        continue;
+                    const int y = edge_node[twin];
+                    if (distance[y] < 0) {
+                        distance[y] = distance[x] + 1;
+                        tree_parent[y] = x;
+                        order[tail++] = y;
+                    }
+                }
+            }
+            a = order[tail - 1];
+        }
+        int center = a;
+        for (int step = distance[a] / 2; step > 0; step--)
+            center = tree_parent[center];
+        const int other_center = distance[a] % 2 == 1 ? tree_parent[center] : -1;
+
+        // BFS from root, two centers form the first level and are parents of each other
+        int head = 0, tail = 0, level_count = 0;
+        for (int x = 0; x < node_count; x++) {
+            distance[x] = -1;
+            nodes[x].parent_edge = -1;
+        }
+        order[tail++] = center;
+        distance[center] = 0;
+        if (other_center >= 0) {
+            order[tail++] = other_center;
+            distance[other_center] = 0;
+            for (int j = 0; j < nodes[center].edge_count; j++) {
+                const int twin = decomposition.twin.items[nodes[center].edges[j]];
+                if (twin >= 0 && decomposition.owner.items[twin] >= 0 && edge_node[twin] == other_center) {
+                    nodes[center].parent_edge = j;
+                    nodes[other_center].parent_edge = edge_index[twin];
+                }
+            }
+        }
+        while (head < tail) {
+            level_start[level_count++] = head;
+            const int level_end = tail;
+            while (head < level_end) {
+                const int x = order[head++];
+                for (int j = 0; j < nodes[x].edge_count; j++) {
+                    const int twin = decomposition.twin.items[nodes[x].edges[j]];
+                    if (twin < 0 || decomposition.owner.items[twin] < 0)
+                        continue;
+                    const int y = edge_node[twin];
+                    if (distance[y] < 0) {
+                        distance[y] = distance[x] + 1;
+                        nodes[y].parent_edge = edge_index[twin];
+                        order[tail++] = y;
+                    }
+                }
+            }
+        }
+        level_start[level_count] = tail;
+
+        // Labels of child nodes in both orientations of virtual edge, forward is from smaller vertex of block
+        int *rank_forward = allocate_solver_array(edge_total);
+        int *rank_backward = allocate_solver_array(edge_total);
+        int *dart_label = allocate_solver_array(2 * (size_t)edge_total);
+        int *work = allocate_solver_array(3 * (size_t)k + 3);
+        int *offsets = allocate_solver_array(2 * (size_t)node_count + 2);
+        int *lengths = allocate_solver_array(2 * (size_t)node_count + 2);
+        int *ranks = allocate_solver_array(2 * (size_t)node_count + 2);
+        IntBuffer tuples = {NULL, 0, 0};
+        IntBuffer best = {NULL, 0, 0};
+        IntBuffer candidate = {NULL, 0, 0};
+
+        push_int(out, PLANAR_BLOCK_NODE);
+        for (int level = level_count - 1; level >= 0; level--) {
+            const int *level_nodes = order + level_start[level];
+            const int size = level_start[level + 1] - level_start[level];
+            if (level == 0 && other_center < 0) {
+                // Root node, all virtual edges lead to children
+                const Skeleton *root = &nodes[center];
+                for (int j = 0; j < root->edge_count; j++) {
+                    const int edge = root->edges[j];
+                    const int twin = decomposition.twin.items[edge];
+                    const bool forward = root->vertices[root->ends[2 * j]] < root->vertices[root->ends[2 * j + 1]];
+                    const bool child = twin >= 0 && decomposition.owner.items[twin] >= 0;
+                    dart_label[2 * j] = child ? 2 + (forward ? rank_forward[edge] : rank_backward[edge]) : 0;
+                    dart_label[2 * j + 1] = child ? 2 + (forward ? rank_backward[edge] : rank_forward[edge]) : 0;
+                }
+                node_code(root, -1, false, colour, dart_label, &best, &candidate, work);
+                tuples.length = 0;
+                offsets[0] = 0;
+                for (size_t i = 0; i < best.length; i++)
+                    push_int(&tuples, best.items[i]);
+                lengths[0] = tuples.length;
+                rank_tuples(&tuples, offsets, lengths, 1, ranks, out);
+                break;
+            }
+
+            tuples.length = 0;
+            for (int i = 0; i < size; i++) {
+                const Skeleton *node = &nodes[level_nodes[i]];
+                for (int j = 0; j < node->edge_count; j++) {
+                    const int edge = node->edges[j];
+                    const int twin = decomposition.twin.items[edge];
+                    const bool forward = node->vertices[node->ends[2 * j]] < node->vertices[node->ends[2 * j + 1]];
+                    const bool child = j != node->parent_edge && twin >= 0 && decomposition.owner.items[twin] >= 0;
+                    const int value_forward = j == node->parent_edge ? 1 : child ? 2 + rank_forward[edge] : 0;
+                    const int value_backward = j == node->parent_edge ? 1 : child ? 2 + rank_backward[edge] : 0;
+                    dart_label[2 * j] = forward ? value_forward : value_backward;
+                    dart_label[2 * j + 1] = forward ? value_backward : value_forward;
+                }
+
+                // Parent edge oriented from smaller and from larger vertex of block
+                for (int orientation = 0; orientation < 2; orientation++) {
+                    const int j = node->parent_edge;
+                    const bool forward = node->vertices[node->ends[2 * j]] < node->vertices[node->ends[2 * j + 1]];
+                    const int dart = 2 * j + (forward == (orientation == 0) ? 0 : 1);
+                    node_code(node, dart, node->type == SKELETON_RIGID, colour, dart_label, &best, &candidate, work);
+                    offsets[2 * i + orientation] = tuples.length;
+                    for (size_t c = 0; c < best.length; c++)
+                        push_int(&tuples, best.items[c]);
+                    lengths[2 * i + orientation] = best.length;
+                }
+            }
+            rank_tuples(&tuples, offsets, lengths, 2 * size, ranks, out);
+
+            // Ranks are labels of parent's virtual edge
+            for (int i = 0; i < size; i++) {
+                const Skeleton *node = &nodes[level_nodes[i]];
+                const int twin = decomposition.twin.items[node->edges[node->parent_edge]];
+                rank_forward[twin] = ranks[2 * i];
+                rank_backward[twin] = ranks[2 * i + 1];
+            }
+
+            // Two centers are joined by their shared virtual edge
+            if (level == 0) {
+                const int first = decomposition.twin.items[nodes[center].edges[nodes[center].parent_edge]];
+                const int second = decomposition.twin.items[nodes[other_center].edges[nodes[other_center].parent_edge]];
+                tuples.length = 0;
+                offsets[0] = 0;
+                int pair[2][2];
+                for (int orientation = 0; orientation < 2; orientation++) {
+                    const int r1 = orientation == 0 ? rank_forward[first] : rank_backward[first];
+                    const int r2 = orientation == 0 ? rank_forward[second] : rank_backward[second];
+                    pair[orientation][0] = r1 < r2 ? r1 : r2;
+                    pair[orientation][1] = r1 < r2 ? r2 : r1;
+                }
+                const int chosen = pair[1][0] < pair[0][0] || (pair[1][0] == pair[0][0] && pair[1][1] < pair[0][1]);
+                push_int(&tuples, SKELETON_PAIR);
+                push_int(&tuples, pair[chosen][0]);
+                push_int(&tuples, pair[chosen][1]);
+                lengths[0] = tuples.length;
+                rank_tuples(&tuples, offsets, lengths, 1, ranks, out);
+            }
+        }
+
+        free_int_buffer(&tuples);
+        free_int_buffer(&best);
+        free_int_buffer(&candidate);
+    }
+
+    // Skeletons and work arrays are in arena
+    arena_release(arena, mark);
+    free_decomposition(&decomposition);
+    return planar;
+}
+
+int new_skeleton(Decomposition *decomposition, const int type) {
+    const int id = decomposition->type.length;
+    if (id == decomposition->edges_capacity) {
+        decomposition->edges_capacity = id > 0 ? 2 * id : 16;
+        decomposition->edges = realloc(decomposition->edges, decomposition->edges_capacity * sizeof(IntBuffer));
+        if (!(decomposition->edges)) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    IntBuffer empty = {NULL, 0, 0};
+    decomposition->edges[id] = empty;
+    push_int(&(decomposition->type), type);
+    return id;
+}
+
+/* Edge is not added to edge list of its skeleton */
+int new_edge(Decomposition *decomposition, const int u, const int v, const int owner) {
+    const int id = decomposition->owner.length;
+    push_int(&(decomposition->ends), u);
+    push_int(&(decomposition->ends), v);
+    push_int(&(decomposition->twin), -1);
+    push_int(&(decomposition->owner), owner);
+    return id;
+}
+
+void new_virtual_pair(Decomposition *decomposition, const int u, const int v, const int first, const int second) {
+    const int e1 = new_edge(decomposition, u, v, first);
+    const int e2 = new_edge(decomposition, u, v, second);
+    decomposition->twin.items[e1] = e2;
+    decomposition->twin.items[e2] = e1;
+    push_int(&(decomposition->edges[first]), e1);
+    push_int(&(decomposition->edges[second]), e2);
+}
+
+/* Splits skeletons until each one is a bond, a polygon or 3-connected. Returns false if block is not planar. */
+bool decompose_block(Decomposition *decomposition) {
+    const int k = decomposition->k;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *local = allocate_solver_array(k);
+    for (int v = 0; v < k; v++)
+        local[v] = -1;
+
+    IntBuffer work = {NULL, 0, 0};
+    push_int(&work, 0);
+    decomposition->planar = true;
+    while (work.length > 0 && decomposition->planar) {
+        const int s = work.items[--work.length];
+        split_skeleton(decomposition, s, &work, local);
+    }
+
+    free_int_buffer(&work);
+    arena_release(arena, mark);
+    return decomposition->planar;
+}
+
+int compare_edge_ends(const void *a, const void *b) {
+    const EdgeEnds *e1 = a;
+    const EdgeEnds *e2 = b;
+    if (e1->low != e2->low) return (e1->low > e2->low) - (e1->low < e2->low);
+    if (e1->high != e2->high) return (e1->high > e2->high) - (e1->high < e2->high);
+    return (e1->edge > e2->edge) - (e1->edge < e2->edge);
+}
+
+/* Classifies skeleton, or splits it. Multiple edges are split off into bonds first, then paths through vertices
+   of degree 2 into polygons. Other separation pairs are found on faces of embedding of skeleton. */
+void split_skeleton(Decomposition *decomposition, const int s, IntBuffer *work, int *local) {
+    int *ends = decomposition->ends.items;
+
+    // Vertices of skeleton
+    IntBuffer vertices = {NULL, 0, 0};
+    for (size_t i = 0; i < decomposition->edges[s].length; i++) {
+        const int e = decomposition->edges[s].items[i];
+        for (int end = 0; end < 2; end++) {
+            const int v = ends[2 * e + end];
+            if (local[v] < 0) {
+                local[v] = vertices.length;
+                push_int(&vertices, v);
+            }
+        }
+    }
+    const int nv = vertices.length;
+    if (nv == 2) {
+        decomposition->type.items[s] = SKELETON_BOND;
+        for (int i = 0; i < nv; i++)
+            local[vertices.items[i]] = -1;
+        free_int_buffer(&vertices);
+        return;
+    }
+
+    // Groups of multiple edges are replaced by virtual edge to new bond
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    const int count = decomposition->edges[s].length;
+    EdgeEnds *sorted = arena_alloc(arena, count * sizeof(EdgeEnds));
+    for (int i = 0; i < count; i++) {
+        const int e = decomposition->edges[s].items[i];
+        const int u = local[ends[2 * e]];
+        const int v = local[ends[2 * e + 1]];
+        EdgeEnds entry = {u < v ? u : v, u < v ? v : u, e};
+        sorted[i] = entry;
+    }
+    qsort(sorted, count, sizeof(EdgeEnds), compare_edge_ends);
+    decomposition->edges[s].length = 0;
+    for (int i = 0; i < count; ) {
+        int j = i;
+        while (j < count && sorted[j].low == sorted[i].low && sorted[j].high == sorted[i].high)
+            j++;
+        if (j - i == 1) {
+            push_int(&(decomposition->edges[s]), sorted[i].edge);
+        } else {
+            const int bond = new_skeleton(decomposition, SKELETON_BOND);
+            for (int g = i; g < j; g++) {
+                decomposition->owner.items[sorted[g].edge] = bond;
+                push_int(&(decomposition->edges[bond]), sorted[g].edge);
+            }
+            new_virtual_pair(decomposition, vertices.items[sorted[i].low], vertices.items[sorted[i].high], s, bond);
+        }
+        i = j;
+    }
+    ends = decomposition->ends.items;
+
+    // Adjacency of simple skeleton
+    const IntBuffer *edges = &(decomposition->edges[s]);
+    const int m = edges->length;
+    int *start = allocate_solver_array((size_t)nv + 1);
+    int *neighbours = allocate_solver_array(2 * (size_t)m);
+    int *incident = allocate_solver_array(2 * (size_t)m);     // Position of edge in edge list of skeleton
+    int *skeleton_ends = allocate_solver_array(2 * (size_t)m);
+    for (int v = 0; v <= nv; v++)
+        start[v] = 0;
+    for (int i = 0; i < m; i++) {
+        start[local[ends[2 * edges->items[i]]] + 1]++;
+        start[local[ends[2 * edges->items[i] + 1]] + 1]++;
+    }
+    for (int v = 0; v < nv; v++)
+        start[v + 1] += start[v];
+    int *fill = allocate_solver_array((size_t)nv * 5 + m + 5);     // Also work space of splits
+    for (int v = 0; v < nv; v++)
+        fill[v] = start[v];
+    for (int i = 0; i < m; i++) {
+        const int u = local[ends[2 * edges->items[i]]];
+        const int v = local[ends[2 * edges->items[i] + 1]];
+        skeleton_ends[2 * i] = u;
+        skeleton_ends[2 * i + 1] = v;
+        incident[fill[u]] = incident[fill[v]] = i;
+        neighbours[fill[u]++] = v;
+        neighbours[fill[v]++] = u;
+    }
+
+    bool cycle = true;
+    int x = -1, w = -1;
+    for (int v = 0; v < nv; v++)
+        cycle = cycle && start[v + 1] - start[v] == 2;
+    const bool chains = !cycle && split_chains(decomposition, s, nv, start, neighbours, incident, vertices.items, fill);
+    if (chains) {
+        // Skeleton without its chains is split again
+        push_int(work, s);
+    } else if (!cycle) {
+        decomposition->planar = find_separation_pair(nv, m, start, neighbours, incident, skeleton_ends, &x, &w);
+    }
+
+    if (cycle) {
+        decomposition->type.items[s] = SKELETON_POLYGON;
+    } else if (!chains && x < 0 && decomposition->planar) {
+        decomposition->type.items[s] = SKELETON_RIGID;
+    } else if (x >= 0) {
+        // Components of skeleton without separation pair, each one with its edges becomes a split component
+        int *component = fill;
+        int *queue = fill + nv;
+        for (int v = 0; v < nv; v++)
+            component[v] = -1;
+        component[x] = component[w] = -2;
+        int component_count = 0;
+        for (int v = 0; v < nv; v++) {
+            if (component[v] != -1)
+                continue;
+            int head = 0, tail = 0;
+            queue[tail++] = v;
+            component[v] = component_count;
+            while (head < tail) {
+                const int u = queue[head++];
+                for (int i = start[u]; i < start[u + 1]; i++)
+                    if (component[neighbours[i]] == -1) {
+                        component[neighbours[i]] = component_count;
+                        queue[tail++] = neighbours[i];
+                    }
+            }
+            component_count++;
+        }
+
+        const int first_class = decomposition->type.length;
+        for (int c = 0; c < component_count; c++)
+            new_skeleton(decomposition, SKELETON_UNKNOWN);
+        int direct = -1;
+        IntBuffer old_edges = decomposition->edges[s];
+        IntBuffer empty = {NULL, 0, 0};
+        decomposition->edges[s] = empty;
+        for (size_t i = 0; i < old_edges.length; i++) {
+            const int e = old_edges.items[i];
+            const int u = local[ends[2 * e]];
+            const int v = local[ends[2 * e + 1]];
+            const int c = component[u] >= 0 ? component[u] : component[v];
+            if (c < 0) {
+                direct = e;
+                continue;
+            }
+            decomposition->owner.items[e] = first_class + c;
+            push_int(&(decomposition->edges[first_class + c]), e);
+        }
+        free_int_buffer(&old_edges);
+
+        // More than two parts are joined by a bond, two parts directly
+        const int sx = vertices.items[x];
+        const int sw = vertices.items[w];
+        if (component_count + (direct >= 0) >= 3) {
+            const int bond = new_skeleton(decomposition, SKELETON_BOND);
+            for (int c = 0; c < component_count; c++)
+                new_virtual_pair(decomposition, sx, sw, first_class + c, bond);
+            if (direct >= 0) {
+                decomposition->owner.items[direct] = bond;
+                push_int(&(decomposition->edges[bond]), direct);
+            }
+        } else {
+            new_virtual_pair(decomposition, sx, sw, first_class, first_class + 1);
+        }
+
+        decomposition->type.items[s] = SKELETON_REMOVED;
+        for (int c = 0; c < component_count; c++)
+            push_int(work, first_class + c);
+    }
+
+    for (int v = 0; v < nv; v++)
+        local[vertices.items[v]] = -1;
+    free_int_buffer(&vertices);
+    arena_release(arena, mark);
+}
+
+/* Maximal paths through vertices of degree 2 are split off as polygons at once, each one is replaced by virtual
+   edge between its ends. Skeleton is biconnected and not a cycle, so ends of each path are distinct vertices
+   of degree at least 3. Returns false if there is no vertex of degree 2. */
+bool split_chains(Decomposition *decomposition, const int s, const int nv, const int *start, const int *neighbours,
+                  const int *incident, const int *vertices, int *work) {
+    IntBuffer old_edges = decomposition->edges[s];
+    const int m = old_edges.length;
+    int *visited = work;        // Vertices of degree 2 already in a chain
+    int *removed = work + nv;   // Edges of skeleton moved to polygons, indexed by position in edge list
+    for (int v = 0; v < nv; v++)
+        visited[v] = 0;
+    for (int i = 0; i < m; i++)
+        removed[i] = 0;
+
+    IntBuffer chains = {NULL, 0, 0};    // Triples of polygon and ends of its virtual edge
+    for (int v = 0; v < nv; v++) {
+        if (visited[v] || start[v + 1] - start[v] != 2)
+            continue;
+        visited[v] = 1;
+        const int polygon = new_skeleton(decomposition, SKELETON_POLYGON);
+        int ends[2];
+        for (int direction = 0; direction < 2; direction++) {
+            int previous = v;
+            int position = start[v] + direction;
+            for (;;) {
+                const int i = incident[position];
+                const int current = neighbours[position];
+                removed[i] = 1;
+                decomposition->owner.items[old_edges.items[i]] = polygon;
+                push_int(&(decomposition->edges[polygon]), old_edges.items[i]);
+                if (start[current + 1] - start[current] != 2) {
+                    ends[direction] = current;
+                    break;
+                }
+                visited[current] = 1;
+                position = neighbours[start[current]] == previous ? start[current] + 1 : start[current];
+                previous = current;
+            }
+        }
+        push_int(&chains, polygon);
+        push_int(&chains, vertices[ends[0]]);
+        push_int(&chains, vertices[ends[1]]);
+    }
+
+    const bool found = chains.length > 0;
+    if (found) {
+        IntBuffer kept = {NULL, 0, 0};
+        for (int i = 0; i < m; i++)
+            if (!removed[i])
+                push_int(&kept, old_edges.items[i]);
+        free_int_buffer(&(decomposition->edges[s]));
+        decomposition->edges[s] = kept;
+        for (size_t c = 0; c < chains.length; c += 3)
+            new_virtual_pair(decomposition, chains.items[c + 1], chains.items[c + 2], s, chains.items[c]);
+    }
+    free_int_buffer(&chains);
+    return found;
+}
+
+/* Separation pair of simple biconnected skeleton, from its embedding. Faces are cycles, so {u, v} separates
+   the skeleton iff u and v lie on two common faces other than the two faces beside edge uv. Faces around each
+   vertex are scanned, which takes sum of squares of face lengths. Returns false if skeleton is not planar,
+   otherwise x and w are the pair, or -1 if skeleton is 3-connected. */
+bool find_separation_pair(const int nv, const int m, const int *start, const int *neighbours, const int *incident,
+                          const int *ends, int *x, int *w) {
+    *x = *w = -1;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *cw = allocate_solver_array(2 * (size_t)m);
+    int *ccw = allocate_solver_array(2 * (size_t)m);
+    if (!planar_embedding(nv, m, ends, cw, ccw)) {
+        arena_release(arena, mark);
+        return false;
+    }
+
+    // Faces as lists of tails of their darts
+    int *face = allocate_solver_array(2 * (size_t)m);
+    int *face_start = allocate_solver_array(2 * (size_t)m + 1);
+    int *face_vertices = allocate_solver_array(2 * (size_t)m);
+    int faces = 0, length = 0;
+    for (int d = 0; d < 2 * m; d++)
+        face[d] = -1;
+    for (int d = 0; d < 2 * m; d++) {
+        if (face[d] >= 0)
+            continue;
+        face_start[faces] = length;
+        for (int e = d; face[e] < 0; e = cw[e ^ 1]) {
+            face[e] = faces;
+            face_vertices[length++] = ends[e];
+        }
+        faces++;
+    }
+    face_start[faces] = length;
+
+    // Common faces of u and other vertices are counted, stamps avoid resetting counters
+    int *adjacent = allocate_solver_array(nv);
+    int *seen = allocate_solver_array(nv);
+    int *count = allocate_solver_array(nv);
+    for (int v = 0; v < nv; v++)
+        adjacent[v] = seen[v] = -1;
+    for (int u = 0; u < nv && *x < 0; u++) {
+        for (int i = start[u]; i < start[u + 1]; i++)
+            adjacent[neighbours[i]] = u;
+        for (int i = start[u]; i < start[u + 1] && *x < 0; i++) {
+            const int e = incident[i];
+            const int f = face[ends[2 * e] == u ? 2 * e : 2 * e + 1];
+            for (int j = face_start[f]; j < face_start[f + 1]; j++) {
+                const int v = face_vertices[j];
+                if (v == u)
+                    continue;
+                if (seen[v] != u) {
+                    seen[v] = u;
+                    count[v] = 0;
+                }
+                count[v]++;
+                if (count[v] >= 3 || (count[v] == 2 && adjacent[v] != u)) {
+                    *x = u;
+                    *w = v;
+                    break;
+                }
+            }
+        }
+    }
+
+    arena_release(arena, mark);
+    return true;
+}
+
+/* Adjacent bonds and adjacent polygons are merged, which makes triconnected components unique.
+   Returns number of skeletons left. */
+int merge_skeletons(Decomposition *decomposition) {
+    const int count = decomposition->type.length;
+    const int edge_count = decomposition->owner.length;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *set = allocate_solver_array(count);
+    for (int t = 0; t < count; t++)
+        set[t] = t;
+
+    int *owner = decomposition->owner.items;
+    const int *twin = decomposition->twin.items;
+    const int *type = decomposition->type.items;
+    for (int e = 0; e < edge_count; e++) {
+        if (twin[e] < e || owner[e] < 0)
+            continue;
+        const int a = find_skeleton(set, owner[e]);
+        const int b = find_skeleton(set, owner[twin[e]]);
+        if (a != b && type[a] == type[b] && (type[a] == SKELETON_BOND || type[a] == SKELETON_POLYGON)) {
+            set[b] = a;
+            owner[e] = owner[twin[e]] = -1;
+        }
+    }
+
+    // Edge lists are rebuilt from owners
+    for (int t = 0; t < count; t++)
+        decomposition->edges[t].length = 0;
+    for (int e = 0; e < edge_count; e++) {
+        if (owner[e] < 0)
+            continue;
+        owner[e] = find_skeleton(set, owner[e]);
+        push_int(&(decomposition->edges[owner[e]]), e);
+    }
+    int remaining = 0;
+    for (int t = 0; t < count; t++) {
+        if (set[t] != t)
+            decomposition->type.items[t] = SKELETON_REMOVED;
+        if (decomposition->type.items[t] != SKELETON_REMOVED && decomposition->edges[t].length > 0)
+            remaining++;
+    }
+    arena_release(arena, mark);
+    return remaining;
+}
+
+int find_skeleton(int *set, int t) {
+    while (set[t] != t) {
+        set[t] = set[set[t]];
+        t = set[t];
+    }
+    return t;
+}
+
+void free_decomposition(Decomposition *decomposition) {
+    for (int t = 0; t < (int)decomposition->type.length; t++)
+        free_int_buffer(&(decomposition->edges[t]));
+    free(decomposition->edges);
+    free_int_buffer(&(decomposition->ends));
+    free_int_buffer(&(decomposition->twin));
+    free_int_buffer(&(decomposition->owner));
+    free_int_buffer(&(decomposition->type));
+}
+
+/* Numbers vertices of skeleton and builds its rotation system. Polygon has the only one, rigid skeleton is
+   embedded by planarity test. Returns false if rigid skeleton is not planar.
+   Arrays of skeleton stay in arena of thread, work arrays are released before them. */
+bool build_skeleton(const Decomposition *decomposition, const int *edges, const int edge_count, Skeleton *node) {
+    const int *ends = decomposition->ends.items;
+    const int k = decomposition->k;
+    node->edge_count = edge_count;
+    node->edges = allocate_solver_array(edge_count);
+    node->ends = allocate_solver_array(2 * (size_t)edge_count);
+    node->vertices = allocate_solver_array(2 * (size_t)edge_count);
+    node->cw = allocate_solver_array(2 * (size_t)edge_count);
+    node->ccw = allocate_solver_array(2 * (size_t)edge_count);
+
+    Arena *arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *local = allocate_solver_array(k);
+    for (int i = 0; i < edge_count; i++)
+        local[ends[2 * edges[i]]] = local[ends[2 * edges[i] + 1]] = -1;
+
+    node->vertex_count = 0;
+    for (int i = 0; i < edge_count; i++) {
+        node->edges[i] = edges[i];
+        for (int end = 0; end < 2; end++) {
+            const int v = ends[2 * edges[i] + end];
+            if (local[v] < 0) {
+                local[v] = node->vertex_count;
+                node->vertices[node->vertex_count++] = v;
+            }
+            node->ends[2 * i + end] = local[v];
+        }
+    }
+    arena_release(arena, mark);
+
+    node->degree = arena_calloc(arena, node->vertex_count, sizeof(int));
+    for (int d = 0; d < 2 * edge_count; d++)
+        node->degree[node->ends[d]]++;
+
+    const int type = decomposition->type.items[decomposition->owner.items[edges[0]]];
+    if (type == SKELETON_POLYGON) {
+        mark = arena_mark(arena);
+        int *other = allocate_solver_array(node->vertex_count);
+        for (int v = 0; v < node->vertex_count; v++)
+            other[v] = -1;
+        for (int d = 0; d < 2 * edge_count; d++) {
+            const int v = node->ends[d];
+            if (other[v] < 0) {
+                other[v] = d;
+            } else {
+                node->cw[d] = node->ccw[d] = other[v];
+                node->cw[other[v]] = node->ccw[other[v]] = d;
+            }
+        }
+        arena_release(arena, mark);
+    } else if (type == SKELETON_RIGID) {
+        return planar_embedding(node->vertex_count, edge_count, node->ends, node->cw, node->ccw);
+    }
+    return true;
+}
+
+/* Best code of node, starting from given dart of parent edge, or from every dart in root (start < 0).
+   Rigid skeletons are also read in mirror image. */
+void node_code(const Skeleton *node, const int start, const bool mirror, const int *colour, const int *dart_label,
+               IntBuffer *best, IntBuffer *candidate, int *work) {
+    best->length = 0;
+    if (node->type == SKELETON_BOND) {
+        bond_code(node, start >= 0 ? node->ends[start] : 0, colour, dart_label, best);
+        if (start < 0) {
+            bond_code(node, 1, colour, dart_label, candidate);
+            if (code_less(candidate, best)) {
+                IntBuffer swap = *best;
+                *best = *candidate;
+                *candidate = swap;
+            }
+        }
+        return;
+    }
+
+    const int first_dart = start >= 0 ? start : 0;
+    const int last_dart = start >= 0 ? start : 2 * node->edge_count - 1;
+    const bool both = start >= 0 ? mirror : node->type == SKELETON_RIGID;
+    bool has_best = false;
+    for (int d = first_dart; d <= last_dart; d++) {
+        for (int direction = 0; direction < (both ? 2 : 1); direction++) {
+            if (skeleton_code(node, d, direction == 1, colour, dart_label, candidate, has_best ? best : NULL, work)) {
+                IntBuffer swap = *best;
+                *best = *candidate;
+                *candidate = swap;
+                has_best = true;
+            }
+        }
+    }
+}
+
+/* Lexicographic order of codes */
+bool code_less(const IntBuffer *code1, const IntBuffer *code2) {
+    for (size_t i = 0; i < code1->length && i < code2->length; i++)
+        if (code1->items[i] != code2->items[i])
+            return code1->items[i] < code2->items[i];
+    return code1->length < code2->length;
+}
+
+/* Bond is its colours and sorted labels of darts from its first vertex */
+void bond_code(const Skeleton *node, const int first, const int *colour, const int *dart_label, IntBuffer *code) {
+    code->length = 0;
+    push_int(code, SKELETON_BOND);
+    push_int(code, colour[node->vertices[first]]);
+    push_int(code, colour[node->vertices[1 - first]]);
+    const size_t labels = code->length;
+    for (int j = 0; j < node->edge_count; j++)
+        push_int(code, dart_label[2 * j + (node->ends[2 * j] == first ? 0 : 1)]);
+    qsort(code->items + labels, code->length - labels, sizeof(int), compare_labels);
+}
+
+/* BFS code of embedded skeleton from start dart. Neighbours of each vertex are read in rotation order starting
+   from the dart by which it was reached, and numbered when seen first. Each vertex writes its colour and degree,
+   then number of neighbour and label of dart for each of its darts. Code is compared with best while it is
+   written and abandoned as soon as it is greater. Returns true if code is smaller than best, or best is NULL. */
+bool skeleton_code(const Skeleton *node, const int start, const bool counterclockwise, const int *colour,
+                   const int *dart_label, IntBuffer *code, const IntBuffer *best, int *work) {
+    const int nv = node->vertex_count;
+    int *number = work;
+    int *reference = work + nv;
+    int *queue = work + 2 * nv;
+    const int *rotation = counterclockwise ? node->ccw : node->cw;
+    int state = best ? 0 : -1;      // 0 while equal to prefix of best, -1 when smaller
+
+    #define EMIT(value) do { \
+        const int emitted = (value); \
+        if (state == 0) { \
+            if (code->length >= best->length || emitted > best->items[code->length]) return false; \
+            if (emitted < best->items[code->length]) state = -1; \
+        } \
+        push_int(code, emitted); \
+    } while (0)
+
+    code->length = 0;
+    for (int v = 0; v < nv; v++)
+        number[v] = -1;
+    EMIT(node->type);
+    int head = 0, tail = 0, next = 1;
+    number[node->ends[start]] = 0;
+    reference[node->ends[start]] = start;
+    queue[tail++] = node->ends[start];
+    while (head < tail) {
+        const int x = queue[head++];
+        EMIT(colour[node->vertices[x]]);
+        EMIT(node->degree[x]);
+        int d = reference[x];
+        for (int i = 0; i < node->degree[x]; i++) {
+            const int y = node->ends[d ^ 1];
+            if (number[y] < 0) {
+                number[y] = next++;
+                reference[y] = d ^ 1;
+                queue[tail++] = y;
+            }
+            EMIT(number[y]);
+            EMIT(dart_label[d]);
+            d = rotation[d];
+        }
+    }
+    #undef EMIT
+
+    return state < 0 || code->length < best->length;
+}
@@ -0,0 +1,13 @@
+#ifndef PLANAR_SOLVER_H
+#define PLANAR_SOLVER_H
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "special_solvers.h"
+
+bool planar_embedding(const int, const int, const int*, int*, int*);
+bool encode_planar_block(const Blocks*, const int, const int, const int*, int*, IntBuffer*);
+
+#endif
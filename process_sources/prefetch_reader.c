@@ -0,0 +1,113 @@
+#include "prefetch_reader.h"
+
+void* prefetch_files(void*);
+
+void start_prefetch_reader(PrefetchReader *reader, const char *path, const bool is_isomorphic, const Result *result, const Options *options) {
+    reader->path = path;
+    reader->result = result;
+    reader->options = options;
+    reader->is_isomorphic = is_isomorphic;
+    reader->slot_count = options->prefetch + 1;
+    reader->head = 0;
+    reader->loaded = 0;
+    memset(&(reader->counters), 0, sizeof(PrefetchCounters));
+    reader->slots = calloc(reader->slot_count, sizeof(PrefetchSlot));
+    if (!reader->slots) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&(reader->lock), NULL);
+    pthread_cond_init(&(reader->changed), NULL);
+    reader->start = monotonic_time();
+    if (pthread_create(&(reader->thread), NULL, prefetch_files, reader) != 0) {
+        fprintf(stderr, "Error: Unable to create reader thread\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void* prefetch_files(void *data) {
+    PrefetchReader *reader = data;
+    for (int i = 0; i < reader->result->count; i++) {
+        // Wait for free buffer
+        pthread_mutex_lock(&(reader->lock));
+        if (reader->loaded >= reader->slot_count) {
+            const double start = monotonic_time();
+            reader->counters.reader_stalls++;
+            while (reader->loaded >= reader->slot_count)
+                pthread_cond_wait(&(reader->changed), &(reader->lock));
+            reader->counters.reader_stall += monotonic_time() - start;
+        }
+        PrefetchSlot *slot = &(reader->slots)[(reader->head + reader->loaded) % reader->slot_count];
+        pthread_mutex_unlock(&(reader->lock));
+
+        // Slot is not visible to compute stage until it is counted as loaded. Indexing reads every page of text file,
+        // rows of packed set are read ahead by kernel.
+        const double start = monotonic_time();
+        const int n = (reader->result->nodes)[i];
+        const Checkpoint *checkpoint = reader->options->checkpoint;
+        FileIdentity identity;
+        if (checkpoint) graph_set_identity(reader->path, n, &identity);
+        slot->loaded = !checkpoint || !find_checkpoint_record(checkpoint, reader->is_isomorphic, n, &identity);
+        if (slot->loaded)
+            reopen_graph_set(reader->path, n, &(slot->graphs));
+        const double busy = monotonic_time() - start;
+
+        pthread_mutex_lock(&(reader->lock));
+        reader->counters.reader_busy += busy;
+        reader->loaded++;
+        pthread_cond_broadcast(&(reader->changed));
+        pthread_mutex_unlock(&(reader->lock));
+    }
+    return NULL;
+}
+
+/* Waits for next file in order of result. Returns NULL for file restored from checkpoint. */
+GraphFile* take_prefetched_file(PrefetchReader *reader) {
+    pthread_mutex_lock(&(reader->lock));
+    if (reader->loaded == 0) {
+        const double start = monotonic_time();
+        reader->counters.compute_stalls++;
+        while (reader->loaded == 0)
+            pthread_cond_wait(&(reader->changed), &(reader->lock));
+        reader->counters.compute_stall += monotonic_time() - start;
+    }
+    reader->counters.takes++;
+    reader->counters.occupancy += reader->loaded;
+    PrefetchSlot *slot = &(reader->slots)[reader->head];
+    pthread_mutex_unlock(&(reader->lock));
+    return slot->loaded ? &(slot->graphs) : NULL;
+}
+
+/* Returns buffer of taken file to reader, file is unmapped but its offset array is kept */
+void release_prefetched_file(PrefetchReader *reader) {
+    pthread_mutex_lock(&(reader->lock));
+    PrefetchSlot *slot = &(reader->slots)[reader->head];
+    if (slot->loaded) unmap_graph_file(&(slot->graphs));
+    reader->head = (reader->head + 1) % reader->slot_count;
+    reader->loaded--;
+    pthread_cond_broadcast(&(reader->changed));
+    pthread_mutex_unlock(&(reader->lock));
+}
+
+/* All files have to be taken and released before */
+void stop_prefetch_reader(PrefetchReader *reader) {
+    pthread_join(reader->thread, NULL);
+    reader->counters.elapsed = monotonic_time() - reader->start;
+    for (int s = 0; s < reader->slot_count; s++)
+        close_graph_file(&((reader->slots)[s].graphs));
+    free(reader->slots);
+    pthread_mutex_destroy(&(reader->lock));
+    pthread_cond_destroy(&(reader->changed));
+}
+
+void print_prefetch_counters(const PrefetchCounters *counters, const int depth, const bool is_isomorphic) {
+    const double utilisation = counters->elapsed > 0 ? 100.0 * counters->reader_busy / counters->elapsed : 0.0;
+    const double occupancy = counters->takes > 0 ? (double)counters->occupancy / counters->takes : 0.0;
+    // Stage which was busy longer limits the run
+    const double compute_busy = counters->elapsed - counters->compute_stall;
+    printf("Prefetch (%s): reader busy %f s (%.1f%%), stalled %ld times for %f s on full buffers; "
+           "compute stalled %ld times for %f s on empty buffers; mean occupancy %.2f of %d, %s.\n",
+           is_isomorphic ? "isomorphic" : "non-isomorphic", counters->reader_busy, utilisation, counters->reader_stalls,
+           counters->reader_stall, counters->compute_stalls, counters->compute_stall, occupancy, depth + 1,
+           counters->reader_busy > compute_busy ? "I/O-bound" : "compute-bound");
+}
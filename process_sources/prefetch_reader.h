@@ -0,0 +1,57 @@
+#ifndef PREFETCH_READER_H
+#define PREFETCH_READER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph_reader.h"
+#include "result_struct.h"
+#include "options.h"
+#include "timer.h"
+
+/* Buffer of reader stage, its file struct and offset array are reused for following files */
+typedef struct {
+    GraphFile graphs;
+    bool loaded;        // False for files restored from checkpoint, which are not read
+} PrefetchSlot;
+
+/* Where the two stages waited for each other. If the reader mostly waits for free buffers, run is compute-bound,
+   if the compute stage mostly waits for files, it is I/O-bound. */
+typedef struct {
+    double reader_busy;     // Mapping, reading and indexing of files
+    double reader_stall;    // Reader waited for free buffer
+    double compute_stall;   // Compute stage waited for next file
+    long reader_stalls;
+    long compute_stalls;
+    long takes;             // Files taken by compute stage
+    long occupancy;         // Sum of loaded buffers seen by compute stage at each take
+    double elapsed;         // Wall-clock time from start to stop of reader
+} PrefetchCounters;
+
+/* Reader thread which maps and indexes next files of directory while compute stage processes current one.
+   Files are taken in order of result, at most depth of them are read ahead. */
+typedef struct {
+    const char *path;
+    const Result *result;
+    const Options *options;
+    bool is_isomorphic;
+    PrefetchSlot *slots;
+    int slot_count;     // Buffers read ahead and the one held by compute stage
+    int head;           // Slot of next file of compute stage
+    int loaded;         // Slots loaded and not released, from head
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    PrefetchCounters counters;
+    double start;
+} PrefetchReader;
+
+void start_prefetch_reader(PrefetchReader*, const char*, const bool, const Result*, const Options*);
+GraphFile* take_prefetched_file(PrefetchReader*);
+void release_prefetched_file(PrefetchReader*);
+void stop_prefetch_reader(PrefetchReader*);
+void print_prefetch_counters(const PrefetchCounters*, const int, const bool);
+
+#endif
@@ -0,0 +1,57 @@
+#include "random.h"
+
+uint64_t splitmix64(uint64_t*);
+uint64_t rotate_left(const uint64_t, const int);
+
+uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void seed_random(Random *random, uint64_t seed) {
+    for (int k = 0; k < 4; k++)
+        random->state[k] = splitmix64(&seed);
+}
+
+uint64_t rotate_left(const uint64_t x, const int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t random_next(Random *random) {
+    uint64_t *s = random->state;
+    const uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotate_left(s[3], 45);
+    return result;
+}
+
+/* Uniform integer from [0, bound), bound must be positive */
+uint64_t random_below(Random *random, const uint64_t bound) {
+    const uint64_t limit = -bound % bound;  // 2^64 mod bound, values below it would bias result
+    uint64_t x;
+    do {
+        x = random_next(random);
+    } while (x < limit);
+    return x % bound;
+}
+
+/* Uniform double from [0, 1) */
+double random_double(Random *random) {
+    return (random_next(random) >> 11) * 0x1.0p-53;
+}
+
+void random_shuffle(Random *random, int *items, const int count) {
+    for (int i = count - 1; i > 0; i--) {
+        const int j = (int)random_below(random, i + 1);
+        const int item = items[i];
+        items[i] = items[j];
+        items[j] = item;
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+/* xoshiro256** generator seeded by splitmix64 */
+typedef struct {
+    uint64_t state[4];
+} Random;
+
+void seed_random(Random*, uint64_t);
+uint64_t random_next(Random*);
+uint64_t random_below(Random*, const uint64_t);
+double random_double(Random*);
+void random_shuffle(Random*, int*, const int);
+
+#endif
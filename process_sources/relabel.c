@@ -0,0 +1,83 @@
+#include "relabel.h"
+
+/* Uniformly random permutation of 0..n-1 */
+void random_permutation(Random *random, int *permutation, const int n) {
+    for (int v = 0; v < n; v++)
+        permutation[v] = v;
+    random_shuffle(random, permutation, n);
+}
+
+/* Writes g with vertex v renamed to permutation[v] into h. Row v of g becomes row permutation[v] of h and only its set
+   bits are visited, so cost is O(n * m) for clearing h plus O(edges). */
+void permute_graph(graph *g, graph *h, const int *permutation, const int m, const int n) {
+    EMPTYGRAPH(h, m, n);
+    for (int v = 0; v < n; v++) {
+        const set *row = GRAPHROW(g, v, m);
+        set *image = GRAPHROW(h, permutation[v], m);
+        for (int k = 0; k < m; k++) {
+            setword word = row[k];
+            while (word) {
+                int position;
+                TAKEBIT(position, word);
+                ADDELEMENT(image, permutation[TIMESWORDSIZE(k) + position]);
+            }
+        }
+    }
+}
+
+/* Builds in-memory packed set of first graph of base followed by count random relabellings of it, so isomorphic
+   benchmark needs only one graph per size. Permutations depend only on seed and n, not on order of sets or threads.
+   Relabellings are dense rows even if base is sparse6. Set is released by close_relabelled_set. */
+void relabel_graph_set(const GraphFile *base, const int n, const int count, const uint64_t seed, GraphFile *file) {
+    if (base->count < 1 || graph_file_order(base, 0) != n) {
+        fprintf(stderr, "Error: Set with %d nodes has no base graph of that size to relabel\n", n);
+        exit(EXIT_FAILURE);
+    }
+
+    const int m = SETWORDSNEEDED(n);
+    const size_t rows = (size_t)n * m * sizeof(setword);
+    const size_t rows_offset = (sizeof(PackedSetEntry) + PACKED_ALIGNMENT - 1) / PACKED_ALIGNMENT * PACKED_ALIGNMENT;
+    const size_t stride = (rows + PACKED_ALIGNMENT - 1) / PACKED_ALIGNMENT * PACKED_ALIGNMENT;
+    const size_t length = rows_offset + (size_t)(count + 1) * stride;
+    char *data = aligned_alloc(PACKED_ALIGNMENT, length);
+    int *permutation = malloc(n * sizeof(int));
+    if (!data || !permutation) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PackedSetEntry *entry = (PackedSetEntry*)data;
+    memset(entry, 0, rows_offset);
+    entry->n = n;
+    entry->count = count + 1;
+    entry->m = m;
+    entry->rows_offset = rows_offset;
+    entry->stride = stride;
+
+    // Base graph is decoded into per-thread buffer, it is copied before anything else decodes
+    graph *g = (graph*)(data + rows_offset);
+    memcpy(g, get_graph(base, 0), rows);
+
+    Random random;
+    seed_random(&random, seed + (uint64_t)n);
+    for (int i = 1; i <= count; i++) {
+        random_permutation(&random, permutation, n);
+        permute_graph(g, (graph*)(data + rows_offset + i * stride), permutation, m, n);
+    }
+    free(permutation);
+
+    file->data = data;
+    file->length = length;
+    file->mapped = false;
+    file->packed = entry;
+    file->offsets = NULL;
+    file->capacity = 0;
+    file->tail = NULL;
+    file->count = count + 1;
+}
+
+void close_relabelled_set(GraphFile *file) {
+    char *data = file->data;
+    close_graph_file(file);
+    free(data);
+}
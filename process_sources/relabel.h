@@ -0,0 +1,17 @@
+#ifndef RELABEL_H
+#define RELABEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nauty.h"
+#include "random.h"
+#include "graph_reader.h"
+
+void random_permutation(Random*, int*, const int);
+void permute_graph(graph*, graph*, const int*, const int, const int);
+void relabel_graph_set(const GraphFile*, const int, const int, const uint64_t, GraphFile*);
+void close_relabelled_set(GraphFile*);
+
+#endif
@@ -1,10 +1,30 @@
 #ifndef RESULT_STRUCT_H
 #define RESULT_STRUCT_H
 
+#include "statistics.h"
+#include "invariant_filter.h"
+#include "instrumentation.h"
+#include "special_solvers.h"
+#include "arena.h"
+
+/* Additional data gathered while processing one graph set */
+typedef struct {
+    int engines;            // Bitmask (1 << Engine) of engines used
+    FilterStats filter;     // Pairs resolved by invariant prefilter
+    long censored;          // Checks which exceeded budget, their time is a lower bound
+    Invariant invariant;    // Vertex invariant used by dense engine
+    double invariant_time;  // Part of time per check spent in vertex invariant
+    Instrumentation instrumentation;    // Filled only with --instrument
+    long solved[SOLVER_COUNT];          // Checks decided by each special solver
+    ArenaStats arena;                   // Scratch memory of solvers, prefilter and vf2pp taken from arena
+} SetReport;
+
 typedef struct {
     int count;
     int *nodes;
     double *time;
+    Statistics *stats;
+    SetReport *reports;
 } Result;
 
 #endif
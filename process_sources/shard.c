@@ -0,0 +1,349 @@
+#include "shard.h"
+#include "file_processor.h"
+#include "graph_reader.h"
+
+/* Average time per check of one set of previous run */
+typedef struct {
+    int n;
+    bool is_isomorphic;
+    double time;
+} CostSample;
+
+/* Line of CSV file with its sort key */
+typedef struct {
+    char *line;
+    int n;
+    bool is_isomorphic;
+    const char *source;
+} MergedRow;
+
+int read_cost_samples(const char*, CostSample**);
+double estimate_check_time(const CostSample*, const int, const double, const double, const int, const bool);
+int compare_shard_costs(const void*, const void*);
+int compare_merged_rows(const void*, const void*);
+int csv_column(const char*, const char*, const char*);
+bool csv_field(const char*, const int, char*, const size_t);
+char* read_csv_line(FILE*, const char*);
+
+/* Parses "i/N" with shards numbered from 1 */
+void parse_shard(const char *value, int *index, int *count) {
+    if (sscanf(value, "%d/%d", index, count) != 2 || *count < 1 || *index < 1 || *index > *count) {
+        fprintf(stderr, "Error: --shard expects i/N with 1 <= i <= N, got %s\n", value);
+        exit(EXIT_FAILURE);
+    }
+    (*index)--;
+}
+
+/* Files are assigned greedily from the most expensive one to the shard with the least load so far */
+void plan_shards(const char *dataset_path, const char *costs_file, const int index, const int count, ShardPlan *plan) {
+    plan->index = index;
+    plan->count = count;
+    plan->files = NULL;
+    plan->file_count = 0;
+    plan->loads = calloc(count, sizeof(double));
+    if (!(plan->loads)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Time per check of previous run, sizes which were not run are extrapolated by power law fitted in log-log scale
+    CostSample *samples = NULL;
+    const int sample_count = costs_file ? read_cost_samples(costs_file, &samples) : 0;
+    double mean_x = 0.0, mean_y = 0.0, sxx = 0.0, sxy = 0.0;
+    int fitted = 0;
+    for (int s = 0; s < sample_count; s++) {
+        if (samples[s].n < 2 || samples[s].time <= 0) continue;
+        mean_x += log(samples[s].n);
+        mean_y += log(samples[s].time);
+        fitted++;
+    }
+    if (fitted > 0) {
+        mean_x /= fitted;
+        mean_y /= fitted;
+    }
+    for (int s = 0; s < sample_count; s++) {
+        if (samples[s].n < 2 || samples[s].time <= 0) continue;
+        sxx += (log(samples[s].n) - mean_x) * (log(samples[s].n) - mean_x);
+        sxy += (log(samples[s].n) - mean_x) * (log(samples[s].time) - mean_y);
+    }
+    // Without spread of sizes time is assumed to grow quadratically, as decoding does
+    const double exponent = sxx > 0 ? sxy / sxx : 2.0;
+    const double intercept = fitted > 0 ? mean_y - exponent * mean_x : 0.0;
+    plan->timed = fitted > 0;
+
+    // Files of both directories in order of read_filenames
+    for (int kind = 1; kind >= 0; kind--) {
+        char path[1024];
+        if (!dataset_directory(dataset_path, kind, path, sizeof(path))) continue;
+        Result names;
+        read_filenames(path, &names);
+        plan->files = realloc(plan->files, (plan->file_count + names.count) * sizeof(ShardFile));
+        if (!(plan->files) && plan->file_count + names.count > 0) {
+            fprintf(stderr, "Error: Memory reallocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < names.count; i++) {
+            GraphFile graphs;
+            open_graph_set(path, (names.nodes)[i], &graphs);
+            ShardFile *file = &(plan->files)[plan->file_count++];
+            file->n = (names.nodes)[i];
+            file->is_isomorphic = kind;
+            file->graphs = graphs.count;
+            file->shard = -1;
+            const double pairs = (double)graphs.count * (graphs.count - 1) / 2;
+            file->cost = pairs * estimate_check_time(samples, sample_count, exponent, intercept, file->n, kind);
+            close_graph_file(&graphs);
+        }
+        free(names.nodes);
+    }
+    free(samples);
+
+    // Longest processing time first, ties are broken by kind and n, so every machine gets the same plan
+    ShardFile **order = malloc(plan->file_count * sizeof(ShardFile*));
+    if (!order && plan->file_count > 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < plan->file_count; i++)
+        order[i] = &(plan->files)[i];
+    qsort(order, plan->file_count, sizeof(ShardFile*), compare_shard_costs);
+    for (int i = 0; i < plan->file_count; i++) {
+        int lightest = 0;
+        for (int s = 1; s < count; s++) {
+            if ((plan->loads)[s] < (plan->loads)[lightest]) lightest = s;
+        }
+        order[i]->shard = lightest;
+        (plan->loads)[lightest] += order[i]->cost;
+    }
+    free(order);
+}
+
+/* Time of one check with n vertices, measured if previous run had the same set */
+double estimate_check_time(const CostSample *samples, const int sample_count, const double exponent, const double intercept,
+                           const int n, const bool is_isomorphic) {
+    for (int s = 0; s < sample_count; s++) {
+        if (samples[s].n == n && samples[s].is_isomorphic == is_isomorphic && samples[s].time > 0)
+            return samples[s].time;
+    }
+    return exp(intercept + exponent * log(n > 1 ? n : 2));
+}
+
+void print_shard_plan(const ShardPlan *plan) {
+    int files = 0;
+    double total = 0.0;
+    for (int i = 0; i < plan->file_count; i++) {
+        if ((plan->files)[i].shard == plan->index) files++;
+    }
+    for (int s = 0; s < plan->count; s++)
+        total += (plan->loads)[s];
+    printf("Shard %d/%d: %d of %d files, estimated cost %g of %g%s.\n", plan->index + 1, plan->count, files,
+           plan->file_count, (plan->loads)[plan->index], total, plan->timed ? " s" : " (by n only)");
+}
+
+/* Removes files of other shards from result filled by read_filenames */
+void filter_shard_files(const ShardPlan *plan, const bool is_isomorphic, Result *result) {
+    int kept = 0;
+    for (int i = 0; i < result->count; i++) {
+        bool own = false;
+        for (int f = 0; f < plan->file_count; f++) {
+            const ShardFile *file = &(plan->files)[f];
+            if (file->n == (result->nodes)[i] && file->is_isomorphic == is_isomorphic) {
+                own = file->shard == plan->index;
+                break;
+            }
+        }
+        if (own) (result->nodes)[kept++] = (result->nodes)[i];
+    }
+    result->count = kept;
+}
+
+void free_shard_plan(ShardPlan *plan) {
+    free(plan->files);
+    free(plan->loads);
+}
+
+/* Descending cost, isomorphic before non-isomorphic, ascending n */
+int compare_shard_costs(const void *a, const void *b) {
+    const ShardFile *file1 = *(ShardFile* const*)a;
+    const ShardFile *file2 = *(ShardFile* const*)b;
+    if (file1->cost != file2->cost) return file1->cost < file2->cost ? 1 : -1;
+    if (file1->is_isomorphic != file2->is_isomorphic) return file1->is_isomorphic ? -1 : 1;
+    return (file1->n > file2->n) - (file1->n < file2->n);
+}
+
+/* Reads node_count, is_isomorphic and average_time of processed CSV */
+int read_cost_samples(const char *filename, CostSample **samples) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Unable to open file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    char *header = read_csv_line(file, filename);
+    if (!header) {
+        fprintf(stderr, "Error: File %s is empty\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    const int n_column = csv_column(header, "node_count", filename);
+    const int kind_column = csv_column(header, "is_isomorphic", filename);
+    const int time_column = csv_column(header, "average_time", filename);
+    free(header);
+
+    int count = 0, capacity = 64;
+    *samples = malloc(capacity * sizeof(CostSample));
+    if (!(*samples)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    char *line;
+    while ((line = read_csv_line(file, filename)) != NULL) {
+        char n[32], kind[32], time[64];
+        if (csv_field(line, n_column, n, sizeof(n)) && csv_field(line, kind_column, kind, sizeof(kind)) &&
+            csv_field(line, time_column, time, sizeof(time))) {
+            if (count >= capacity) {
+                capacity *= 2;
+                *samples = realloc(*samples, capacity * sizeof(CostSample));
+                if (!(*samples)) {
+                    fprintf(stderr, "Error: Memory reallocation failed\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (*samples)[count].n = atoi(n);
+            (*samples)[count].is_isomorphic = strcmp(kind, "true") == 0;
+            (*samples)[count].time = atof(time);
+            count++;
+        }
+        free(line);
+    }
+    fclose(file);
+    return count;
+}
+
+/* Merges CSV files of shards into one file ordered as write_to_csv orders it, isomorphic sets first, then by n.
+   Works for result and instrumentation CSV, files have to have the same header and must not share a set. */
+void merge_shard_results(const char *result_file, char **shard_files, const int shard_count) {
+    char *header = NULL;
+    int n_column = -1, kind_column = -1;
+    MergedRow *rows = NULL;
+    int count = 0, capacity = 0;
+
+    for (int k = 0; k < shard_count; k++) {
+        FILE *file = fopen(shard_files[k], "r");
+        if (!file) {
+            fprintf(stderr, "Error: Unable to open file %s\n", shard_files[k]);
+            exit(EXIT_FAILURE);
+        }
+        char *shard_header = read_csv_line(file, shard_files[k]);
+        if (!shard_header) {
+            fprintf(stderr, "Error: File %s is empty\n", shard_files[k]);
+            exit(EXIT_FAILURE);
+        }
+        if (!header) {
+            header = shard_header;
+            n_column = csv_column(header, "node_count", shard_files[k]);
+            kind_column = csv_column(header, "is_isomorphic", shard_files[k]);
+        } else {
+            if (strcmp(header, shard_header) != 0) {
+                fprintf(stderr, "Error: Header of %s differs from header of %s\n", shard_files[k], shard_files[0]);
+                exit(EXIT_FAILURE);
+            }
+            free(shard_header);
+        }
+
+        char *line;
+        while ((line = read_csv_line(file, shard_files[k])) != NULL) {
+            char n[32], kind[32];
+            if (!csv_field(line, n_column, n, sizeof(n)) || !csv_field(line, kind_column, kind, sizeof(kind))) {
+                fprintf(stderr, "Error: Row of %s has too few columns\n", shard_files[k]);
+                exit(EXIT_FAILURE);
+            }
+            if (count >= capacity) {
+                capacity = capacity ? 2 * capacity : 64;
+                rows = realloc(rows, capacity * sizeof(MergedRow));
+                if (!rows) {
+                    fprintf(stderr, "Error: Memory reallocation failed\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            rows[count].line = line;
+            rows[count].n = atoi(n);
+            rows[count].is_isomorphic = strcmp(kind, "true") == 0;
+            rows[count].source = shard_files[k];
+            count++;
+        }
+        fclose(file);
+    }
+
+    if (!header) {
+        fprintf(stderr, "Error: No shard files to merge\n");
+        exit(EXIT_FAILURE);
+    }
+
+    qsort(rows, count, sizeof(MergedRow), compare_merged_rows);
+    for (int i = 1; i < count; i++) {
+        if (rows[i].n == rows[i - 1].n && rows[i].is_isomorphic == rows[i - 1].is_isomorphic) {
+            fprintf(stderr, "Error: %s set with %d vertices is both in %s and %s\n",
+                    rows[i].is_isomorphic ? "Isomorphic" : "Non-isomorphic", rows[i].n, rows[i - 1].source, rows[i].source);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    FILE *file = open_output_file(result_file);
+    if (!file) exit(EXIT_FAILURE);
+    fprintf(file, "%s\n", header);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s\n", rows[i].line);
+        free(rows[i].line);
+    }
+    fclose(file);
+    printf("%d rows of %d shards merged into %s successfully.\n", count, shard_count, result_file);
+    free(rows);
+    free(header);
+}
+
+int compare_merged_rows(const void *a, const void *b) {
+    const MergedRow *row1 = a;
+    const MergedRow *row2 = b;
+    if (row1->is_isomorphic != row2->is_isomorphic) return row1->is_isomorphic ? -1 : 1;
+    return (row1->n > row2->n) - (row1->n < row2->n);
+}
+
+int csv_column(const char *header, const char *name, const char *filename) {
+    char field[128];
+    for (int column = 0; csv_field(header, column, field, sizeof(field)); column++) {
+        if (strcmp(field, name) == 0) return column;
+    }
+    fprintf(stderr, "Error: File %s has no column %s\n", filename, name);
+    exit(EXIT_FAILURE);
+}
+
+/* Copies field of comma separated line, fields of processed files are never quoted */
+bool csv_field(const char *line, const int column, char *field, const size_t size) {
+    for (int c = 0; c < column; c++) {
+        line = strchr(line, ',');
+        if (!line) return false;
+        line++;
+    }
+    const size_t length = strcspn(line, ",");
+    if (length >= size) return false;
+    memcpy(field, line, length);
+    field[length] = '\0';
+    return true;
+}
+
+/* Next non-empty line without newline, NULL at end of file */
+char* read_csv_line(FILE *file, const char *filename) {
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t read;
+    while ((read = getline(&line, &size, file)) != -1) {
+        while (read > 0 && (line[read - 1] == '\n' || line[read - 1] == '\r'))
+            line[--read] = '\0';
+        if (read > 0) return line;
+    }
+    if (ferror(file)) {
+        fprintf(stderr, "Error: Unable to read file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    free(line);
+    return NULL;
+}
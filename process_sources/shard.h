@@ -0,0 +1,38 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "result_struct.h"
+
+/* One <n>.g6 file of dataset with its estimated processing cost */
+typedef struct {
+    int n;
+    bool is_isomorphic;
+    int graphs;         // Graphs in file
+    double cost;        // Estimated time of all checks of file, in seconds if previous timings are known
+    int shard;          // Shard which processes file
+} ShardFile;
+
+/* Deterministic partition of dataset files over machines of a sweep. Every machine computes the same plan
+   from the same dataset and cost file and processes only files of its own shard. */
+typedef struct {
+    int index;          // Shard of this run, from 0
+    int count;
+    ShardFile *files;   // Files of both isomorphic and non-isomorphic directory, ordered by kind and n
+    int file_count;
+    double *loads;      // Estimated cost of each shard
+    bool timed;         // Costs are based on timings of previous run, otherwise only on n
+} ShardPlan;
+
+void parse_shard(const char*, int*, int*);
+void plan_shards(const char*, const char*, const int, const int, ShardPlan*);
+void print_shard_plan(const ShardPlan*);
+void filter_shard_files(const ShardPlan*, const bool, Result*);
+void free_shard_plan(ShardPlan*);
+void merge_shard_results(const char*, char**, const int);
+
+#endif
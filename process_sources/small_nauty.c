@@ -0,0 +1,22 @@
+#include "small_nauty.h"
+
+#ifndef SMALL_M
+#error "small_nauty.c is compiled only for process_small.exe, with SMALL_M and MAXN"
+#endif
+
+/* Compiled once for every SMALL_M in 1, 2, 4 with MAXN = 64 * SMALL_M, together with its own copy of nauty.
+   Working arrays are static and with MAXN == WORDSIZE nauty takes its one-setword code paths. */
+
+#define SMALL_NAME(name, m) SMALL_NAME_EXPAND(name, m)
+#define SMALL_NAME_EXPAND(name, m) name##_m##m
+
+/* Same labelling as densenauty of generic build without hooks, graph layout is equal because WORDSIZE is 64 in both */
+void SMALL_NAME(canonical_form_small, SMALL_M)(graph *g, graph *canon, const int n, statsblk *stats) {
+    static TLS_ATTR int lab[MAXN];
+    static TLS_ATTR int ptn[MAXN];
+    static TLS_ATTR int orbits[MAXN];
+    DEFAULTOPTIONS_GRAPH(options);
+    options.getcanon = TRUE;
+
+    densenauty(g,lab,ptn,orbits,&options,stats,SETWORDSNEEDED(n),n,canon);
+}
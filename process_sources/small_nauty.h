@@ -0,0 +1,17 @@
+#ifndef SMALL_NAUTY_H
+#define SMALL_NAUTY_H
+
+#include "nauty.h"
+
+// Largest graphs canonicalised by nauty builds with fixed MAXN of 1, 2 and 4 setwords
+#define SMALL_NAUTY_MAXN 256
+
+#if WORDSIZE != 64
+#error "Nauty builds with fixed MAXN are linked only with nauty built with WORDSIZE=64"
+#endif
+
+void canonical_form_small_m1(graph*, graph*, const int, statsblk*);
+void canonical_form_small_m2(graph*, graph*, const int, statsblk*);
+void canonical_form_small_m4(graph*, graph*, const int, statsblk*);
+
+#endif
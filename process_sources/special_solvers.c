@@ -0,0 +1,774 @@
+#include "special_solvers.h"
+#include "planar_solver.h"
+#include "timer.h"
+
+static const char *solver_names[SOLVER_COUNT] = {"path", "cycle", "complete", "complete_bipartite", "union", "tree", "cactus", "planar"};
+
+typedef struct {
+    int type;   // SOLVER_PATH, SOLVER_CYCLE, SOLVER_COMPLETE or SOLVER_COMPLETE_BIPARTITE
+    int a;      // Vertex count, or size of smaller part of complete bipartite graph
+    int b;      // Size of larger part of complete bipartite graph, 0 otherwise
+} Component;
+
+typedef struct {
+    const int *items;
+    int length;
+    int node;
+} Tuple;
+
+typedef struct {
+    int vertex;
+    int neighbour;
+} BlockEdge;
+
+typedef bool (*Recogniser)(myGraph*, const int, Classification*);
+
+bool recognise_components(myGraph*, const int, Classification*);
+bool recognise_tree(myGraph*, const int, Classification*);
+bool recognise_cactus(myGraph*, const int, Classification*);
+bool recognise_planar(myGraph*, const int, Classification*);
+bool encode_cactus_block(const Blocks*, const int, const int, const int*, int*, IntBuffer*);
+int compare_components(const void*, const void*);
+int compare_tuples(const void*, const void*);
+int compare_block_edges(const void*, const void*);
+void order_cycle_block(int*, const int, const int*, const int, BlockEdge*);
+int least_rotation(const int*, const int, int*);
+bool rotation_less(const int*, const int, const int*, const int, const int);
+
+/* Recognisers in order of priority, each one may recognise several solvers.
+   Cheaper and more specific families go first, so trees which are paths are solved as paths and cacti are
+   not decomposed into triconnected components. */
+static const Recogniser recognisers[] = {recognise_components, recognise_tree, recognise_cactus, recognise_planar};
+
+/* Comma separated list of solver names, "all" enables every solver */
+int parse_solvers(const char *list) {
+    int solvers = 0;
+    char *copy = strdup(list);
+    if (!copy) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (char *name = strtok(copy, ","); name; name = strtok(NULL, ",")) {
+        if (strcmp(name, "all") == 0) {
+            solvers |= ALL_SOLVERS;
+            continue;
+        }
+        int s = 0;
+        while (s < SOLVER_COUNT && strcmp(name, solver_names[s]) != 0)
+            s++;
+        if (s == SOLVER_COUNT) {
+            fprintf(stderr, "Error: Unknown solver '%s', expected all or one of path, cycle, complete, "
+                            "complete_bipartite, union, tree, cactus, planar\n", name);
+            exit(EXIT_FAILURE);
+        }
+        solvers |= 1 << s;
+    }
+    free(copy);
+    return solvers;
+}
+
+const char* solver_name(const Solver solver) {
+    return solver < SOLVER_COUNT ? solver_names[solver] : "none";
+}
+
+/* First enabled solver which recognises graph classifies it */
+void classify_graph(myGraph *graph, const int solvers, Classification *classification) {
+    classification->solver = SOLVER_COUNT;
+    classification->certificate = NULL;
+    classification->length = 0;
+    if (!graph || graph->vertex_count == 0)
+        return;
+
+    for (size_t r = 0; r < sizeof(recognisers) / sizeof(recognisers[0]); r++)
+        if (recognisers[r](graph, solvers, classification))
+            return;
+}
+
+/* Splits graph into connected components by BFS and recognises each one by its vertex count, edge count,
+   degrees and 2-colouring in O(n+m). Complete graph is checked first, so K1, K2 and K3 are always complete.
+   Certificate is the sorted list of (type, a, b) triples of components. */
+bool recognise_components(myGraph *graph, const int solvers, Classification *classification) {
+    const int mask = (1 << SOLVER_PATH) | (1 << SOLVER_CYCLE) | (1 << SOLVER_COMPLETE) |
+                     (1 << SOLVER_COMPLETE_BIPARTITE) | (1 << SOLVER_UNION);
+    if (!(solvers & mask))
+        return false;
+
+    const int n = graph->vertex_count;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *colour = allocate_solver_array(n);
+    int *queue = allocate_solver_array(n);
+    Component *components = arena_alloc(arena, n * sizeof(Component));
+    for (int v = 0; v < n; v++)
+        colour[v] = -1;
+
+    int component_count = 0;
+    bool recognised = true;
+    for (int start = 0; start < n && recognised; start++) {
+        if (colour[start] >= 0)
+            continue;
+
+        int head = 0, tail = 0;
+        long degree_sum = 0;
+        int min_degree = n, max_degree = 0, first_part = 0;
+        bool bipartite = true;
+        queue[tail++] = start;
+        colour[start] = 0;
+        while (head < tail) {
+            const int v = queue[head++];
+            const int degree = mygraph_degree(graph, v);
+            const int *neighbours = mygraph_neighbours(graph, v);
+            degree_sum += degree;
+            if (degree < min_degree) min_degree = degree;
+            if (degree > max_degree) max_degree = degree;
+            if (colour[v] == 0) first_part++;
+            for (int i = 0; i < degree; i++) {
+                const int w = neighbours[i];
+                if (colour[w] < 0) {
+                    colour[w] = 1 - colour[v];
+                    queue[tail++] = w;
+                } else if (colour[w] == colour[v]) {
+                    bipartite = false;
+                }
+            }
+        }
+
+        const long vertices = tail;
+        const long edges = degree_sum / 2;
+        const int smaller = first_part < tail - first_part ? first_part : tail - first_part;
+        Component component = {0, tail, 0};
+        if (edges == vertices * (vertices - 1) / 2) {
+            component.type = SOLVER_COMPLETE;
+        } else if (edges == vertices - 1 && max_degree <= 2) {
+            component.type = SOLVER_PATH;
+        } else if (edges == vertices && min_degree == 2 && max_degree == 2) {
+            component.type = SOLVER_CYCLE;
+        } else if (bipartite && edges == (long)smaller * (tail - smaller)) {
+            component.type = SOLVER_COMPLETE_BIPARTITE;
+            component.a = smaller;
+            component.b = tail - smaller;
+        } else {
+            recognised = false;
+        }
+        components[component_count++] = component;
+    }
+
+    // Connected graph is solved by its own family, if enabled, otherwise it is a union of one component
+    Solver solver = SOLVER_UNION;
+    if (recognised && component_count == 1 && (solvers & (1 << components[0].type)))
+        solver = components[0].type;
+    recognised = recognised && (solvers & (1 << solver));
+
+    if (recognised) {
+        qsort(components, component_count, sizeof(Component), compare_components);
+        classification->solver = solver;
+        classification->length = 3 * component_count;
+        classification->certificate = malloc(classification->length * sizeof(int));
+        if (!(classification->certificate)) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int c = 0; c < component_count; c++) {
+            classification->certificate[3 * c] = components[c].type;
+            classification->certificate[3 * c + 1] = components[c].a;
+            classification->certificate[3 * c + 2] = components[c].b;
+        }
+    }
+
+    arena_release(arena, mark);
+    return recognised;
+}
+
+/* AHU encoding of tree optimization */
+bool recognise_tree(myGraph *graph, const int solvers, Classification *classification) {
+    if (!(solvers & (1 << SOLVER_TREE)) || !is_tree(graph))
+        return false;
+
+    classification->solver = SOLVER_TREE;
+    classification->certificate = encode_tree(graph, &(classification->length));
+    return true;
+}
+
+/* Cactus is encoded by AHU on its block-cut tree, every block has to be a bridge or a cycle */
+bool recognise_cactus(myGraph *graph, const int solvers, Classification *classification) {
+    const int n = graph->vertex_count;
+    const int m = graph->edge_count;
+
+    // Blocks are edges or cycles, so there are at most 3(n-1)/2 edges
+    if (!(solvers & (1 << SOLVER_CACTUS)) || n < 2 || 2L * m > 3L * (n - 1))
+        return false;
+
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    Blocks blocks;
+    find_blocks(graph, &blocks);
+
+    // Biconnected block with as many edges as vertices is a cycle
+    bool is_cactus = blocks.components == 1;
+    for (int b = 0; b < blocks.count && is_cactus; b++) {
+        const int size = blocks.start[b + 1] - blocks.start[b];
+        const int edges = blocks.edge_start[b + 1] - blocks.edge_start[b];
+        is_cactus = edges == 1 || edges == size;
+    }
+
+    IntBuffer encoding = {NULL, 0, 0};
+    is_cactus = is_cactus && encode_block_tree(graph, &blocks, encode_cactus_block, &encoding);
+    arena_release(arena, mark);
+    if (!is_cactus) {
+        free_int_buffer(&encoding);
+        return false;
+    }
+
+    classification->solver = SOLVER_CACTUS;
+    classification->certificate = encoding.items;
+    classification->length = encoding.length;
+    return true;
+}
+
+/* Planar graph is encoded by AHU on its block-cut tree, blocks are encoded by their triconnected components.
+   Graph is not recognised if any of its blocks is not planar. */
+bool recognise_planar(myGraph *graph, const int solvers, Classification *classification) {
+    const int n = graph->vertex_count;
+    const int m = graph->edge_count;
+
+    // Planar graph with at least 3 vertices has at most 3n-6 edges
+    if (!(solvers & (1 << SOLVER_PLANAR)) || (n >= 3 && m > 3L * n - 6))
+        return false;
+
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    Blocks blocks;
+    find_blocks(graph, &blocks);
+
+    IntBuffer encoding = {NULL, 0, 0};
+    const bool is_planar = encode_block_tree(graph, &blocks, encode_planar_block, &encoding);
+    arena_release(arena, mark);
+    if (!is_planar) {
+        free_int_buffer(&encoding);
+        return false;
+    }
+
+    classification->solver = SOLVER_PLANAR;
+    classification->certificate = encoding.items;
+    classification->length = encoding.length;
+    return true;
+}
+
+/* Bridge is label of its child, cycle is the sequence of labels of its children along the cycle starting after
+   parent vertex, read in the direction which gives lexicographically smaller sequence. Cycle in root has no parent,
+   so it is the least rotation of both directions. */
+bool encode_cactus_block(const Blocks *blocks, const int block, const int parent, const int *label, int *scratch, IntBuffer *out) {
+    (void)scratch;     // Cycles are ordered by their edges, vertices need no numbering
+    const int *vertices = blocks->vertices + blocks->start[block];
+    const int k = blocks->start[block + 1] - blocks->start[block];
+
+    if (k == 2) {
+        const int first = label[vertices[0]];
+        const int second = label[vertices[1]];
+        if (parent >= 0) {
+            push_int(out, BRIDGE_NODE);
+            push_int(out, vertices[0] == parent ? second : first);
+        } else {
+            push_int(out, ROOT_BRIDGE_NODE);
+            push_int(out, first < second ? first : second);
+            push_int(out, first < second ? second : first);
+        }
+        return true;
+    }
+
+    // Vertices in cyclic order
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *cycle = allocate_solver_array(k);
+    BlockEdge *buffer = arena_alloc(arena, 2 * k * sizeof(BlockEdge));
+    order_cycle_block(cycle, k, blocks->edges + 2 * blocks->edge_start[block], k, buffer);
+
+    int *sequence = allocate_solver_array(2 * (size_t)k);     // Labels in both directions
+    if (parent >= 0) {
+        int start = 0;
+        while (cycle[start] != parent)
+            start++;
+        for (int c = 1; c < k; c++) {
+            sequence[c - 1] = label[cycle[(start + c) % k]];
+            sequence[k - 1 + c - 1] = label[cycle[(start + k - c) % k]];
+        }
+        const int *chosen = rotation_less(sequence + k - 1, 0, sequence, 0, k - 1) ? sequence + k - 1 : sequence;
+        push_int(out, CYCLE_NODE);
+        for (int c = 0; c < k - 1; c++)
+            push_int(out, chosen[c]);
+    } else {
+        int *failure = allocate_solver_array(2 * (size_t)k);
+        for (int c = 0; c < k; c++) {
+            sequence[c] = label[cycle[c]];
+            sequence[k + c] = label[cycle[k - 1 - c]];
+        }
+        const int forward = least_rotation(sequence, k, failure);
+        const int backward = least_rotation(sequence + k, k, failure);
+        const bool reversed = rotation_less(sequence + k, backward, sequence, forward, k);
+        const int *chosen = reversed ? sequence + k : sequence;
+        const int shift = reversed ? backward : forward;
+        push_int(out, ROOT_CYCLE_NODE);
+        for (int c = 0; c < k; c++)
+            push_int(out, chosen[(shift + c) % k]);
+    }
+
+    arena_release(arena, mark);
+    return true;
+}
+
+/* Iterative Tarjan's algorithm started from every unvisited vertex. Edges are kept on stack until their block
+   is complete. Arrays of blocks are allocated from arena of thread, they are freed by releasing it. */
+void find_blocks(myGraph *graph, Blocks *blocks) {
+    const int n = graph->vertex_count;
+    const int m = graph->edge_count;
+
+    blocks->start = allocate_solver_array((size_t)m + 1);
+    blocks->vertices = allocate_solver_array((size_t)n + m);
+    blocks->edge_start = allocate_solver_array((size_t)m + 1);
+    blocks->edges = allocate_solver_array(2 * (size_t)m);
+
+    // Work arrays are allocated after blocks, so that they can be released
+    Arena *arena = thread_arena();
+    const ArenaMark arena_start = arena_mark(arena);
+    int *disc = allocate_solver_array(n);
+    int *low = allocate_solver_array(n);
+    int *parent = allocate_solver_array(n);
+    int *position = allocate_solver_array(n);
+    int *stack = allocate_solver_array(n);
+    int *mark = allocate_solver_array(n);
+    int *edge_stack = allocate_solver_array(2 * (size_t)m);
+    for (int v = 0; v < n; v++) {
+        disc[v] = -1;
+        mark[v] = -1;
+        position[v] = graph->offsets[v];
+    }
+
+    int time = 0, edge_top = 0;
+    int block_count = 0, vertex_fill = 0, edge_fill = 0;
+    blocks->components = 0;
+    for (int root = 0; root < n; root++) {
+        if (disc[root] >= 0)
+            continue;
+        blocks->components++;
+
+        int top = 0;
+        stack[top++] = root;
+        disc[root] = low[root] = time++;
+        parent[root] = -1;
+        while (top > 0) {
+            const int v = stack[top - 1];
+            if (position[v] < graph->offsets[v + 1]) {
+                const int w = graph->neighbours[position[v]++];
+                if (disc[w] < 0) {
+                    parent[w] = v;
+                    disc[w] = low[w] = time++;
+                    edge_stack[2 * edge_top] = v;
+                    edge_stack[2 * edge_top + 1] = w;
+                    edge_top++;
+                    stack[top++] = w;
+                } else if (w != parent[v] && disc[w] < disc[v]) {
+                    edge_stack[2 * edge_top] = v;
+                    edge_stack[2 * edge_top + 1] = w;
+                    edge_top++;
+                    if (disc[w] < low[v]) low[v] = disc[w];
+                }
+                continue;
+            }
+
+            top--;
+            const int p = parent[v];
+            if (p < 0)
+                continue;
+            if (low[v] < low[p]) low[p] = low[v];
+            if (low[v] < disc[p])
+                continue;
+
+            // Edges above (p, v) form a block
+            blocks->start[block_count] = vertex_fill;
+            blocks->edge_start[block_count] = edge_fill;
+            int a, b;
+            do {
+                edge_top--;
+                a = edge_stack[2 * edge_top];
+                b = edge_stack[2 * edge_top + 1];
+                blocks->edges[2 * edge_fill] = a;
+                blocks->edges[2 * edge_fill + 1] = b;
+                edge_fill++;
+                if (mark[a] != block_count) {
+                    mark[a] = block_count;
+                    blocks->vertices[vertex_fill++] = a;
+                }
+                if (mark[b] != block_count) {
+                    mark[b] = block_count;
+                    blocks->vertices[vertex_fill++] = b;
+                }
+            } while (a != p || b != v);
+            block_count++;
+        }
+    }
+    blocks->count = block_count;
+    blocks->start[block_count] = vertex_fill;
+    blocks->edge_start[block_count] = edge_fill;
+
+    arena_release(arena, arena_start);
+}
+
+/* AHU encoding of block-cut tree, computed level by level from the deepest one as in encode_tree. The tree has
+   a node for every vertex and every block, and a virtual root joining components if graph is disconnected.
+   Each component is rooted in the center of its tree, which is unique, as all leaves are vertex nodes.
+   Vertex node is the sorted tuple of labels of its child blocks, block node is the tuple written by encoder.
+   Encoding is a sequence of levels, each level is its size followed by (length, tuple) of its sorted nodes. */
+bool encode_block_tree(myGraph *graph, const Blocks *blocks, BlockEncoder encoder, IntBuffer *out) {
+    const int n = graph->vertex_count;
+    const int root = n + blocks->count;     // Virtual root
+    const int count = root + 1;
+
+    // Nodes 0..n-1 are vertices and n..n+count-1 are blocks, virtual root has no edges here
+    const int entries = blocks->start[blocks->count];
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *tree_offsets = allocate_solver_array((size_t)count + 1);
+    int *tree_neighbours = allocate_solver_array(2 * (size_t)entries);
+    int *fill = allocate_solver_array(count);
+    for (int x = 0; x <= count; x++)
+        tree_offsets[x] = 0;
+    for (int b = 0; b < blocks->count; b++) {
+        tree_offsets[n + b + 1] = blocks->start[b + 1] - blocks->start[b];
+        for (int k = blocks->start[b]; k < blocks->start[b + 1]; k++)
+            tree_offsets[blocks->vertices[k] + 1]++;
+    }
+    for (int x = 0; x < count; x++)
+        tree_offsets[x + 1] += tree_offsets[x];
+    for (int x = 0; x < count; x++)
+        fill[x] = tree_offsets[x];
+    for (int b = 0; b < blocks->count; b++) {
+        for (int k = blocks->start[b]; k < blocks->start[b + 1]; k++) {
+            const int v = blocks->vertices[k];
+            tree_neighbours[fill[v]++] = n + b;
+            tree_neighbours[fill[n + b]++] = v;
+        }
+    }
+
+    // Center of component is in the middle of path between the farthest node a from any node,
+    // and the farthest node from a
+    int *first = allocate_solver_array(count);
+    int *second = allocate_solver_array(count);
+    int *queue = allocate_solver_array(count);
+    int *tree_parent = fill;
+    int *centers = allocate_solver_array(blocks->components);
+    int center_count = 0;
+    for (int x = 0; x < count; x++)
+        first[x] = second[x] = -1;
+    for (int start = 0; start < n; start++) {
+        if (first[start] >= 0)
+            continue;
+        int head = 0, tail = 0;
+        queue[tail++] = start;
+        first[start] = 0;
+        while (head < tail) {
+            const int x = queue[head++];
+            for (int k = tree_offsets[x]; k < tree_offsets[x + 1]; k++)
+                if (first[tree_neighbours[k]] < 0) {
+                    first[tree_neighbours[k]] = first[x] + 1;
+                    queue[tail++] = tree_neighbours[k];
+                }
+        }
+
+        const int a = queue[tail - 1];
+        head = tail = 0;
+        queue[tail++] = a;
+        second[a] = 0;
+        tree_parent[a] = -1;
+        while (head < tail) {
+            const int x = queue[head++];
+            for (int k = tree_offsets[x]; k < tree_offsets[x + 1]; k++)
+                if (second[tree_neighbours[k]] < 0) {
+                    second[tree_neighbours[k]] = second[x] + 1;
+                    tree_parent[tree_neighbours[k]] = x;
+                    queue[tail++] = tree_neighbours[k];
+                }
+        }
+
+        int center = queue[tail - 1];
+        for (int step = second[center] / 2; step > 0; step--)
+            center = tree_parent[center];
+        centers[center_count++] = center;
+    }
+
+    // BFS from root groups nodes by levels
+    int *order = queue;
+    int *level_start = allocate_solver_array((size_t)count + 1);
+    int level_count = 0;
+    int head = 0, tail = 0;
+    const int top = center_count == 1 ? centers[0] : root;
+    order[tail++] = top;
+    tree_parent[top] = -1;
+    while (head < tail) {
+        level_start[level_count++] = head;
+        const int level_end = tail;
+        while (head < level_end) {
+            const int x = order[head++];
+            if (x == root) {
+                for (int c = 0; c < center_count; c++) {
+                    tree_parent[centers[c]] = root;
+                    order[tail++] = centers[c];
+                }
+                continue;
+            }
+            for (int k = tree_offsets[x]; k < tree_offsets[x + 1]; k++) {
+                const int y = tree_neighbours[k];
+                if (y != tree_parent[x]) {
+                    tree_parent[y] = x;
+                    order[tail++] = y;
+                }
+            }
+        }
+    }
+    level_start[level_count] = tail;
+
+    int *label = allocate_solver_array(count);
+    int *offsets = allocate_solver_array(count);
+    int *lengths = allocate_solver_array(count);
+    int *ranks = allocate_solver_array(count);
+    int *scratch = allocate_solver_array(n);
+    for (int v = 0; v < n; v++)
+        scratch[v] = -1;
+    IntBuffer tuples = {NULL, 0, 0};
+    bool encoded = true;
+
+    for (int level = level_count - 1; level >= 0 && encoded; level--) {
+        const int *nodes = order + level_start[level];
+        const int size = level_start[level + 1] - level_start[level];
+        tuples.length = 0;
+        for (int i = 0; i < size && encoded; i++) {
+            const int x = nodes[i];
+            offsets[i] = tuples.length;
+            if (x < n || x == root) {
+                push_int(&tuples, x == root ? ROOT_NODE : VERTEX_NODE);
+                if (x == root) {
+                    for (int c = 0; c < center_count; c++)
+                        push_int(&tuples, label[centers[c]]);
+                } else {
+                    for (int k = tree_offsets[x]; k < tree_offsets[x + 1]; k++)
+                        if (tree_neighbours[k] != tree_parent[x])
+                            push_int(&tuples, label[tree_neighbours[k]]);
+                }
+                qsort(tuples.items + offsets[i] + 1, tuples.length - offsets[i] - 1, sizeof(int), compare_labels);
+            } else {
+                const int parent = tree_parent[x] < n ? tree_parent[x] : -1;
+                encoded = encoder(blocks, x - n, parent, label, scratch, &tuples);
+            }
+            lengths[i] = tuples.length - offsets[i];
+        }
+        if (!encoded)
+            break;
+
+        rank_tuples(&tuples, offsets, lengths, size, ranks, out);
+        for (int i = 0; i < size; i++)
+            label[nodes[i]] = ranks[i];
+    }
+
+    arena_release(arena, mark);
+    free_int_buffer(&tuples);
+    return encoded;
+}
+
+/* Sorts tuples given by offsets and lengths in items, equal tuples get equal rank.
+   Appends their count followed by (length, tuple) of sorted tuples to out. */
+void rank_tuples(const IntBuffer *items, const int *offsets, const int *lengths, const int count, int *ranks, IntBuffer *out) {
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    Tuple *tuples = arena_alloc(arena, count * sizeof(Tuple));
+    for (int i = 0; i < count; i++) {
+        Tuple tuple = {items->items + offsets[i], lengths[i], i};
+        tuples[i] = tuple;
+    }
+    qsort(tuples, count, sizeof(Tuple), compare_tuples);
+
+    push_int(out, count);
+    int rank = 0;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && compare_tuples(&tuples[i - 1], &tuples[i]) != 0)
+            rank++;
+        ranks[tuples[i].node] = rank;
+        push_int(out, tuples[i].length);
+        for (int k = 0; k < tuples[i].length; k++)
+            push_int(out, tuples[i].items[k]);
+    }
+    arena_release(arena, mark);
+}
+
+void push_int(IntBuffer *buffer, const int value) {
+    if (buffer->length == buffer->capacity) {
+        buffer->capacity = buffer->capacity > 0 ? 2 * buffer->capacity : 64;
+        buffer->items = realloc(buffer->items, buffer->capacity * sizeof(int));
+        if (!(buffer->items)) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    buffer->items[buffer->length++] = value;
+}
+
+void free_int_buffer(IntBuffer *buffer) {
+    free(buffer->items);
+    buffer->items = NULL;
+    buffer->length = buffer->capacity = 0;
+}
+
+/* Walks cycle block along its edges. Edges are sorted by vertex, so both neighbours of a vertex are adjacent. */
+void order_cycle_block(int *vertices, const int size, const int *edges, const int edge_count, BlockEdge *buffer) {
+    for (int e = 0; e < edge_count; e++) {
+        BlockEdge forward = {edges[2 * e], edges[2 * e + 1]};
+        BlockEdge backward = {edges[2 * e + 1], edges[2 * e]};
+        buffer[2 * e] = forward;
+        buffer[2 * e + 1] = backward;
+    }
+    qsort(buffer, 2 * edge_count, sizeof(BlockEdge), compare_block_edges);
+
+    int previous = -1;
+    int current = buffer[0].vertex;
+    for (int i = 0; i < size; i++) {
+        vertices[i] = current;
+        int lo = 0, hi = 2 * edge_count;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (buffer[mid].vertex < current) lo = mid + 1;
+            else hi = mid;
+        }
+        const int next = buffer[lo].neighbour != previous ? buffer[lo].neighbour : buffer[lo + 1].neighbour;
+        previous = current;
+        current = next;
+    }
+}
+
+/* Booth's algorithm, start of lexicographically least rotation in O(k). Failure function needs 2k items. */
+int least_rotation(const int *s, const int k, int *failure) {
+    for (int j = 0; j < 2 * k; j++)
+        failure[j] = -1;
+    int least = 0;
+    for (int j = 1; j < 2 * k; j++) {
+        const int sj = s[j % k];
+        int i = failure[j - least - 1];
+        while (i != -1 && sj != s[(least + i + 1) % k]) {
+            if (sj < s[(least + i + 1) % k])
+                least = j - i - 1;
+            i = failure[i];
+        }
+        if (sj != s[(least + i + 1) % k]) {
+            if (sj < s[least % k])
+                least = j;
+            failure[j - least] = -1;
+        } else {
+            failure[j - least] = i + 1;
+        }
+    }
+    return least % k;
+}
+
+/* Compares rotation of a starting at shift_a with rotation of b starting at shift_b */
+bool rotation_less(const int *a, const int shift_a, const int *b, const int shift_b, const int k) {
+    for (int c = 0; c < k; c++) {
+        const int x = a[(shift_a + c) % k];
+        const int y = b[(shift_b + c) % k];
+        if (x != y)
+            return x < y;
+    }
+    return false;
+}
+
+void init_solver_cache(SolverCache *cache, const int count, const int n, const int solvers) {
+    cache->count = solvers ? count : 0;
+    cache->n = n;
+    cache->solvers = solvers;
+    cache->time = 0.0;
+    cache->entries = calloc(cache->count > 0 ? cache->count : 1, sizeof(Classification));
+    cache->classified = calloc(cache->count > 0 ? cache->count : 1, sizeof(bool));
+    if (!(cache->entries) || !(cache->classified)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    init_mygraph_cache(&(cache->graphs), cache->count, n);
+}
+
+/* Graph is classified once, its CSR form is not needed afterwards. All memory used by recognition except
+   the certificate is taken from arena of thread and released here. */
+const Classification* get_classification(SolverCache *cache, const GraphFile *graphs, const int index) {
+    if (!(cache->classified)[index]) {
+        Arena *arena = thread_arena();
+        const ArenaMark mark = arena_mark(arena);
+        myGraph *graph = get_mygraph(&(cache->graphs), graphs, index);
+
+        const double start = thread_cpu_time();
+        classify_graph(graph, cache->solvers, &(cache->entries)[index]);
+        cache->time += thread_cpu_time() - start;
+
+        (cache->classified)[index] = true;
+        release_mygraph(&(cache->graphs), index);
+        arena_release(arena, mark);
+    }
+    return &(cache->entries)[index];
+}
+
+/* Pair is decided if at least one graph was recognised. Graphs recognised by different solvers, or only one of them,
+   are not isomorphic. Solver which decided the pair is written to solver. */
+bool try_special_solvers(SolverCache *cache, const GraphFile *graphs, const int i, const int j, bool *is_isomorphic,
+                         Solver *solver, double *time) {
+    const Classification *first = get_classification(cache, graphs, i);
+    const Classification *second = get_classification(cache, graphs, j);
+    if (first->solver == SOLVER_COUNT && second->solver == SOLVER_COUNT)
+        return false;
+
+    const double start = thread_cpu_time();
+    *is_isomorphic = first->solver == second->solver && first->length == second->length &&
+                     memcmp(first->certificate, second->certificate, first->length * sizeof(int)) == 0;
+    *time += thread_cpu_time() - start;
+
+    *solver = first->solver != SOLVER_COUNT ? first->solver : second->solver;
+    return true;
+}
+
+void free_solver_cache(SolverCache *cache) {
+    for (int i = 0; i < cache->count; i++)
+        free((cache->entries)[i].certificate);
+    free(cache->entries);
+    free(cache->classified);
+    free_mygraph_cache(&(cache->graphs));
+}
+
+int compare_components(const void *a, const void *b) {
+    const Component *c1 = a;
+    const Component *c2 = b;
+    if (c1->type != c2->type) return (c1->type > c2->type) - (c1->type < c2->type);
+    if (c1->a != c2->a) return (c1->a > c2->a) - (c1->a < c2->a);
+    return (c1->b > c2->b) - (c1->b < c2->b);
+}
+
+/* Shorter tuples first, then lexicographically */
+int compare_tuples(const void *a, const void *b) {
+    const Tuple *t1 = a;
+    const Tuple *t2 = b;
+    if (t1->length != t2->length)
+        return (t1->length > t2->length) - (t1->length < t2->length);
+    for (int i = 0; i < t1->length; i++)
+        if (t1->items[i] != t2->items[i])
+            return (t1->items[i] > t2->items[i]) - (t1->items[i] < t2->items[i]);
+    return 0;
+}
+
+int compare_labels(const void *a, const void *b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int compare_block_edges(const void *a, const void *b) {
+    const BlockEdge *e1 = a;
+    const BlockEdge *e2 = b;
+    return (e1->vertex > e2->vertex) - (e1->vertex < e2->vertex);
+}
+
+/* Work array of solvers, allocated from arena of thread and freed by releasing it to an earlier mark */
+int* allocate_solver_array(const size_t count) {
+    return arena_alloc(thread_arena(), count * sizeof(int));
+}
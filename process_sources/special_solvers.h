@@ -0,0 +1,88 @@
+#ifndef SPECIAL_SOLVERS_H
+#define SPECIAL_SOLVERS_H
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "my_graph.h"
+#include "graph_reader.h"
+#include "tree_optimization.h"
+#include "arena.h"
+
+/* Families of graphs whose isomorphism is decided without canonical labelling */
+typedef enum {
+    SOLVER_PATH,
+    SOLVER_CYCLE,
+    SOLVER_COMPLETE,
+    SOLVER_COMPLETE_BIPARTITE,
+    SOLVER_UNION,       // Disjoint union of paths, cycles, complete and complete bipartite graphs
+    SOLVER_TREE,
+    SOLVER_CACTUS,      // Connected graph whose blocks are edges or cycles
+    SOLVER_PLANAR,
+    SOLVER_COUNT
+} Solver;
+
+#define ALL_SOLVERS ((1 << SOLVER_COUNT) - 1)
+
+/* Result of recognition of one graph. Recognition is invariant under isomorphism and solvers are tried in fixed order,
+   so isomorphic graphs are recognised by the same solver and have equal certificates. */
+typedef struct {
+    Solver solver;      // SOLVER_COUNT if no enabled solver recognised graph
+    int *certificate;
+    int length;
+} Classification;
+
+typedef struct {
+    Classification *entries;
+    bool *classified;
+    double time;            // Time spent on recognition and encoding
+    myGraphCache graphs;    // CSR form of graphs, built once per graph
+    int count;
+    int n;
+    int solvers;            // Bitmask (1 << Solver) of enabled solvers
+} SolverCache;
+
+/* Growable array of integers in which certificates are built */
+typedef struct {
+    int *items;
+    size_t length;
+    size_t capacity;
+} IntBuffer;
+
+/* Biconnected components of graph. Isolated vertices belong to no block. */
+typedef struct {
+    int count;
+    int *start;         // Vertices of block b are vertices[start[b]] .. vertices[start[b + 1] - 1]
+    int *vertices;
+    int *edge_start;    // Edges of block b are pairs (edges[2k], edges[2k + 1]), edge_start[b] <= k < edge_start[b + 1]
+    int *edges;
+    int components;     // Number of connected components of graph
+} Blocks;
+
+// Kinds of nodes of block-cut tree, first item of their tuples
+enum {ROOT_NODE = -1, VERTEX_NODE, BRIDGE_NODE, ROOT_BRIDGE_NODE, CYCLE_NODE, ROOT_CYCLE_NODE, PLANAR_BLOCK_NODE};
+
+/* Appends tuple of a block node of block-cut tree to buffer. Arguments are blocks, block, its parent vertex
+   (-1 in root), labels of vertex nodes, which are set for all vertices of block except parent, and scratch array
+   of graph size filled with -1, which has to be left filled with -1. Returns false if block cannot be encoded. */
+typedef bool (*BlockEncoder)(const Blocks*, const int, const int, const int*, int*, IntBuffer*);
+
+int parse_solvers(const char*);
+const char* solver_name(const Solver);
+void classify_graph(myGraph*, const int, Classification*);
+
+void find_blocks(myGraph*, Blocks*);
+bool encode_block_tree(myGraph*, const Blocks*, BlockEncoder, IntBuffer*);
+void rank_tuples(const IntBuffer*, const int*, const int*, const int, int*, IntBuffer*);
+void push_int(IntBuffer*, const int);
+void free_int_buffer(IntBuffer*);
+int* allocate_solver_array(const size_t);
+int compare_labels(const void*, const void*);
+
+void init_solver_cache(SolverCache*, const int, const int, const int);
+const Classification* get_classification(SolverCache*, const GraphFile*, const int);
+bool try_special_solvers(SolverCache*, const GraphFile*, const int, const int, bool*, Solver*, double*);
+void free_solver_cache(SolverCache*);
+
+#endif
@@ -0,0 +1,88 @@
+#include "statistics.h"
+
+int compare_doubles(const void*, const void*);
+
+/* Fills statistics of CPU and wall-clock samples. Both arrays get sorted. */
+void compute_statistics(double *cpu_samples, double *wall_samples, const int count, Statistics *stats) {
+    stats->repetitions = count;
+    if (count == 0) {
+        stats->mean = stats->min = stats->median = stats->p90 = stats->p99 = stats->stddev = stats->median_wall = NAN;
+        return;
+    }
+
+    qsort(cpu_samples, count, sizeof(double), compare_doubles);
+    qsort(wall_samples, count, sizeof(double), compare_doubles);
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++)
+        sum += cpu_samples[i];
+    stats->mean = sum / count;
+
+    // Sample standard deviation
+    double squares = 0.0;
+    for (int i = 0; i < count; i++)
+        squares += (cpu_samples[i] - stats->mean) * (cpu_samples[i] - stats->mean);
+    stats->stddev = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+
+    stats->min = cpu_samples[0];
+    stats->median = percentile(cpu_samples, count, 50);
+    stats->p90 = percentile(cpu_samples, count, 90);
+    stats->p99 = percentile(cpu_samples, count, 99);
+    stats->median_wall = percentile(wall_samples, count, 50);
+}
+
+/* Percentile of sorted samples, median of even count is the mean of two middle samples, others use nearest rank */
+double percentile(const double *sorted, const int count, const double p) {
+    if (p == 50 && count % 2 == 0)
+        return (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+
+    int rank = (int)ceil(p / 100 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+int compare_doubles(const void *a, const void *b) {
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void record_latency(LatencyHistogram *histogram, const double seconds) {
+    const double microseconds = seconds * 1e6;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && microseconds >= (double)(1L << bucket))
+        bucket++;
+    histogram->counts[bucket]++;
+    histogram->count++;
+    histogram->total += seconds;
+    if (seconds > histogram->max) histogram->max = seconds;
+}
+
+/* Upper bound of bucket which contains given percentile, in seconds, so it overestimates by at most factor 2 */
+double histogram_percentile(const LatencyHistogram *histogram, const double p) {
+    if (histogram->count == 0) return NAN;
+    const double rank = p / 100.0 * histogram->count;
+    long seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS - 1; bucket++) {
+        seen += histogram->counts[bucket];
+        if (seen >= rank && seen > 0) {
+            const double bound = (double)(1L << bucket) * 1e-6;
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+/* Non-empty buckets as "upper_bound_us:count" pairs separated by commas, the last bucket is "inf" */
+void format_histogram(const LatencyHistogram *histogram, char *buffer, const size_t size) {
+    size_t length = 0;
+    buffer[0] = '\0';
+    for (int bucket = 0; bucket < LATENCY_BUCKETS && length < size; bucket++) {
+        if (histogram->counts[bucket] == 0) continue;
+        if (bucket < LATENCY_BUCKETS - 1)
+            length += snprintf(buffer + length, size - length, "%s%ld:%ld", length ? "," : "", 1L << bucket, histogram->counts[bucket]);
+        else
+            length += snprintf(buffer + length, size - length, "%sinf:%ld", length ? "," : "", histogram->counts[bucket]);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Buckets of latency histogram, bucket k counts latencies in [2^(k-1), 2^k) microseconds, the last one all above
+#define LATENCY_BUCKETS 32
+
+typedef struct {
+    int repetitions;        // Number of measured samples
+    double mean;
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double stddev;
+    double median_wall;     // Median of wall-clock samples
+} Statistics;
+
+/* Histogram with power of two buckets, constant memory for any number of samples */
+typedef struct {
+    long counts[LATENCY_BUCKETS];
+    long count;
+    double total;       // Sum of all latencies in seconds
+    double max;
+} LatencyHistogram;
+
+void compute_statistics(double*, double*, const int, Statistics*);
+double percentile(const double*, const int, const double);
+void record_latency(LatencyHistogram*, const double);
+double histogram_percentile(const LatencyHistogram*, const double);
+void format_histogram(const LatencyHistogram*, char*, const size_t);
+
+#endif
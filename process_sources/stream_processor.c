@@ -0,0 +1,225 @@
+#include "stream_processor.h"
+
+void* read_stream(void*);
+void parse_set_header(const char*, const char*, const long, StreamSet*);
+void append_stream_line(StreamSet*, const char*, const size_t);
+void queue_stream_set(StreamReader*, StreamSet*);
+StreamSet* take_stream_set(StreamReader*);
+void free_stream_set(StreamSet*);
+
+/* Processes graph sets from stream, input "-" is stdin, otherwise a FIFO or a file */
+void process_stream(const char *input, const char *result_file, const char *instrument_file, const Options *options) {
+    StreamReader reader;
+    reader.name = strcmp(input, "-") == 0 ? "stdin" : input;
+    reader.input = strcmp(input, "-") == 0 ? stdin : fopen(input, "r");
+    if (!reader.input) {
+        fprintf(stderr, "Error: Unable to open stream %s\n", input);
+        exit(EXIT_FAILURE);
+    }
+    reader.head = NULL;
+    reader.tail = NULL;
+    reader.queued = 0;
+    reader.finished = false;
+    pthread_mutex_init(&(reader.lock), NULL);
+    pthread_cond_init(&(reader.changed), NULL);
+
+    // Rows are appended and flushed one by one, so results of finished sets survive interrupted run
+    FILE *csv = open_output_file(result_file);
+    FILE *instrumentation = instrument_file ? open_output_file(instrument_file) : NULL;
+    if (!csv || (instrument_file && !instrumentation))
+        exit(EXIT_FAILURE);
+    const bool jsonl = instrument_file && is_jsonl_file(instrument_file);
+    write_csv_header(csv);
+    fflush(csv);
+    if (instrumentation) {
+        write_instrumentation_header(instrumentation, jsonl);
+        fflush(instrumentation);
+    }
+
+    ThreadPool pool;
+    if (options->threads > 1)
+        init_thread_pool(&pool, options->threads, options->pin);
+
+    if (pthread_create(&(reader.thread), NULL, read_stream, &reader) != 0) {
+        fprintf(stderr, "Error: Unable to create reader thread\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int processed = 0;
+    StreamSet *set;
+    while ((set = take_stream_set(&reader)) != NULL) {
+        // The same as one file of dataset directory
+        GraphFile graphs;
+        open_graph_buffer(set->data, set->length, &graphs);
+        int n = set->n;
+        double time;
+        Statistics stats;
+        SetReport report;
+        memset(&stats, 0, sizeof(stats));
+        memset(&report, 0, sizeof(report));
+        Result row = {1, &n, &time, &stats, &report};
+
+        if (options->instrument)
+            reset_peak_rss();
+        benchmark_graph_set(&graphs, graphs.count, n, set->is_isomorphic, options,
+                            options->threads > 1 ? &pool : NULL, &report, &stats);
+        time = stats.mean;
+        if (options->instrument)
+            report.instrumentation.peak_rss_kb = peak_rss_kb();
+        close_graph_file(&graphs);
+
+        write_csv_row(csv, &row, 0, set->is_isomorphic);
+        fflush(csv);
+        if (instrumentation) {
+            write_instrumentation_row(instrumentation, &row, 0, set->is_isomorphic, jsonl);
+            fflush(instrumentation);
+        }
+        if (options->store)
+            sync_certificate_store(options->store);
+
+        printf("%s set of %d graphs with %d vertices is processed.\n",
+               set->is_isomorphic ? "Isomorphic" : "Non-isomorphic", set->count, n);
+        processed++;
+        free_stream_set(set);
+    }
+
+    pthread_join(reader.thread, NULL);
+    if (options->threads > 1)
+        free_thread_pool(&pool);
+    if (reader.input != stdin)
+        fclose(reader.input);
+    pthread_mutex_destroy(&(reader.lock));
+    pthread_cond_destroy(&(reader.changed));
+
+    fclose(csv);
+    printf("%d sets from %s are processed, data written to %s successfully.\n", processed, reader.name, result_file);
+    if (instrumentation) {
+        fclose(instrumentation);
+        printf("Instrumentation written to %s successfully.\n", instrument_file);
+    }
+}
+
+void* read_stream(void *data) {
+    StreamReader *reader = data;
+    StreamSet *set = NULL;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t read;
+    long line_number = 0;
+
+    while ((read = getline(&line, &size, reader->input)) != -1) {
+        line_number++;
+        while (read > 0 && (line[read - 1] == '\n' || line[read - 1] == '\r'))
+            line[--read] = '\0';
+        if (read == 0) continue;
+
+        if (strncmp(line, "#set", 4) == 0) {
+            if (set) {
+                fprintf(stderr, "Warning: Set with %d vertices in %s is not terminated by #end, it is skipped\n",
+                        set->n, reader->name);
+                free_stream_set(set);
+            }
+            set = calloc(1, sizeof(StreamSet));
+            if (!set) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            parse_set_header(line, reader->name, line_number, set);
+        } else if (strcmp(line, "#end") == 0) {
+            if (!set) {
+                fprintf(stderr, "Error: #end without #set on line %ld of %s\n", line_number, reader->name);
+                exit(EXIT_FAILURE);
+            }
+            // Set of one graph has no pairs to check
+            if (set->count < 2) {
+                fprintf(stderr, "Warning: Set with %d vertices in %s has fewer than two graphs, it is skipped\n",
+                        set->n, reader->name);
+                free_stream_set(set);
+            } else {
+                queue_stream_set(reader, set);
+            }
+            set = NULL;
+        } else if (set && valid_graph_line(line, read, set->n) && graphsize(line) == set->n) {
+            append_stream_line(set, line, read);
+        } else {
+            fprintf(stderr, "Error: Line %ld of %s is neither a set tag nor a graph of current set\n",
+                    line_number, reader->name);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (set) {
+        fprintf(stderr, "Warning: Stream %s ended inside set with %d vertices, it is skipped\n", reader->name, set->n);
+        free_stream_set(set);
+    }
+    free(line);
+
+    pthread_mutex_lock(&(reader->lock));
+    reader->finished = true;
+    pthread_cond_broadcast(&(reader->changed));
+    pthread_mutex_unlock(&(reader->lock));
+    return NULL;
+}
+
+void parse_set_header(const char *line, const char *name, const long line_number, StreamSet *set) {
+    char kind[32];
+    if (sscanf(line, "#set %d %31s", &(set->n), kind) != 2 || set->n < 1 ||
+        (strcmp(kind, "isomorphic") != 0 && strcmp(kind, "non_isomorphic") != 0)) {
+        fprintf(stderr, "Error: Invalid set tag on line %ld of %s, expected #set <n> isomorphic|non_isomorphic\n",
+                line_number, name);
+        exit(EXIT_FAILURE);
+    }
+    set->is_isomorphic = strcmp(kind, "isomorphic") == 0;
+}
+
+/* Decoders of graph lines need terminating newline */
+void append_stream_line(StreamSet *set, const char *line, const size_t length) {
+    if (set->length + length + 1 > set->capacity) {
+        size_t capacity = set->capacity ? set->capacity : 4096;
+        while (set->length + length + 1 > capacity)
+            capacity *= 2;
+        set->data = realloc(set->data, capacity);
+        if (!set->data) {
+            fprintf(stderr, "Error: Memory reallocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        set->capacity = capacity;
+    }
+    memcpy(set->data + set->length, line, length);
+    set->data[set->length + length] = '\n';
+    set->length += length + 1;
+    set->count++;
+}
+
+void queue_stream_set(StreamReader *reader, StreamSet *set) {
+    pthread_mutex_lock(&(reader->lock));
+    while (reader->queued >= STREAM_QUEUE_SETS)
+        pthread_cond_wait(&(reader->changed), &(reader->lock));
+    if (reader->tail) reader->tail->next = set;
+    else reader->head = set;
+    reader->tail = set;
+    reader->queued++;
+    pthread_cond_broadcast(&(reader->changed));
+    pthread_mutex_unlock(&(reader->lock));
+}
+
+/* Waits for next set, NULL when stream is finished */
+StreamSet* take_stream_set(StreamReader *reader) {
+    pthread_mutex_lock(&(reader->lock));
+    while (!reader->head && !reader->finished)
+        pthread_cond_wait(&(reader->changed), &(reader->lock));
+    StreamSet *set = reader->head;
+    if (set) {
+        reader->head = set->next;
+        if (!reader->head) reader->tail = NULL;
+        reader->queued--;
+        pthread_cond_broadcast(&(reader->changed));
+    }
+    pthread_mutex_unlock(&(reader->lock));
+    return set;
+}
+
+void free_stream_set(StreamSet *set) {
+    free(set->data);
+    free(set);
+}
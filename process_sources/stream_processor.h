@@ -0,0 +1,52 @@
+#ifndef STREAM_PROCESSOR_H
+#define STREAM_PROCESSOR_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "result_struct.h"
+#include "options.h"
+#include "graph_processor.h"
+#include "graph_reader.h"
+#include "file_processor.h"
+#include "thread_pool.h"
+#include "instrumentation.h"
+
+/* Input of --stream mode is a sequence of graph sets tagged with order and kind, as written by generation.py --stream:
+       #set <n> isomorphic|non_isomorphic
+       <graph6 or sparse6 line>
+       ...
+       #end
+   Sets are processed in order of arrival, row of each set is appended to result file as soon as it is finished. */
+
+// Sets received ahead of processing, beyond that reader stops and writer blocks on full pipe
+#define STREAM_QUEUE_SETS 4
+
+typedef struct StreamSet {
+    char *data;         // Graph lines of set, each terminated by newline
+    size_t length;
+    size_t capacity;
+    int n;
+    bool is_isomorphic;
+    int count;          // Number of graph lines
+    struct StreamSet *next;
+} StreamSet;
+
+/* Reader thread receives sets while previous ones are processed */
+typedef struct {
+    FILE *input;
+    const char *name;
+    StreamSet *head;
+    StreamSet *tail;
+    int queued;
+    bool finished;      // Input is closed, no more sets will be queued
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} StreamReader;
+
+void process_stream(const char*, const char*, const char*, const Options*);
+
+#endif
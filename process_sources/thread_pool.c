@@ -0,0 +1,207 @@
+#include "thread_pool.h"
+
+static __thread int worker_index = -1;
+
+typedef struct {
+    ThreadPool *pool;
+    int index;
+} WorkerArgument;
+
+void* worker_loop(void*);
+bool find_task(ThreadPool*, const int, bool, Task*);
+void init_queue(TaskQueue*);
+void push_tail(TaskQueue*, Task);
+bool pop_tail(TaskQueue*, Task*);
+bool pop_head(TaskQueue*, Task*);
+void notify_workers(ThreadPool*);
+
+void init_thread_pool(ThreadPool *pool, const int thread_count, bool pin) {
+    pool->thread_count = thread_count;
+    pool->pin = pin;
+    pool->threads = malloc(thread_count * sizeof(pthread_t));
+    pool->queues = malloc(thread_count * sizeof(TaskQueue));
+    if (!(pool->threads) || !(pool->queues)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < thread_count; i++)
+        init_queue(&(pool->queues)[i]);
+    init_queue(&(pool->injection));
+    atomic_init(&(pool->queued), 0);
+    atomic_init(&(pool->stop), false);
+    pthread_mutex_init(&(pool->lock), NULL);
+    pthread_cond_init(&(pool->wakeup), NULL);
+
+    // Calling thread becomes worker 0, others are started here
+    worker_index = 0;
+    pool->threads[0] = pthread_self();
+    if (pin)
+        pin_current_thread(0);
+    for (int i = 1; i < thread_count; i++) {
+        WorkerArgument *argument = malloc(sizeof(WorkerArgument));
+        if (!argument) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        argument->pool = pool;
+        argument->index = i;
+        if (pthread_create(&(pool->threads)[i], NULL, worker_loop, argument) != 0) {
+            perror("pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/* Adds task to shared FIFO queue. Used for top-level tasks whose order matters. */
+void inject_task(ThreadPool *pool, TaskFunction function, void *argument) {
+    Task task = {function, argument};
+    push_tail(&(pool->injection), task);
+    notify_workers(pool);
+}
+
+/* Adds task to own queue of calling worker, where idle workers can steal it. */
+void submit_task(ThreadPool *pool, TaskFunction function, void *argument) {
+    Task task = {function, argument};
+    push_tail(&(pool->queues)[worker_index < 0 ? 0 : worker_index], task);
+    notify_workers(pool);
+}
+
+/* Executes tasks until counter drops to zero. Nested waits should not take top-level tasks from injection queue. */
+void wait_for_tasks(ThreadPool *pool, atomic_int *counter, bool take_injected) {
+    Task task;
+    while (atomic_load(counter) > 0) {
+        if (find_task(pool, worker_index, take_injected, &task)) {
+            task.function(task.argument);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+int current_worker(void) {
+    return worker_index;
+}
+
+void free_thread_pool(ThreadPool *pool) {
+    pthread_mutex_lock(&(pool->lock));
+    atomic_store(&(pool->stop), true);
+    pthread_cond_broadcast(&(pool->wakeup));
+    pthread_mutex_unlock(&(pool->lock));
+
+    for (int i = 1; i < pool->thread_count; i++)
+        pthread_join((pool->threads)[i], NULL);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+        free((pool->queues)[i].tasks);
+        pthread_mutex_destroy(&(pool->queues)[i].lock);
+    }
+    free(pool->injection.tasks);
+    pthread_mutex_destroy(&(pool->injection.lock));
+    pthread_mutex_destroy(&(pool->lock));
+    pthread_cond_destroy(&(pool->wakeup));
+    free(pool->queues);
+    free(pool->threads);
+    worker_index = -1;
+}
+
+void* worker_loop(void *data) {
+    WorkerArgument *argument = data;
+    ThreadPool *pool = argument->pool;
+    worker_index = argument->index;
+    free(argument);
+    if (pool->pin)
+        pin_current_thread(worker_index);
+
+    Task task;
+    while (!atomic_load(&(pool->stop))) {
+        if (find_task(pool, worker_index, true, &task)) {
+            task.function(task.argument);
+            continue;
+        }
+
+        // Sleep until some task is queued
+        pthread_mutex_lock(&(pool->lock));
+        while (atomic_load(&(pool->queued)) == 0 && !atomic_load(&(pool->stop)))
+            pthread_cond_wait(&(pool->wakeup), &(pool->lock));
+        pthread_mutex_unlock(&(pool->lock));
+    }
+
+    return NULL;
+}
+
+/* Own queue first (newest task), then injection queue (oldest task), then steal oldest task of other workers */
+bool find_task(ThreadPool *pool, const int index, bool take_injected, Task *task) {
+    bool found = pop_tail(&(pool->queues)[index], task);
+    if (!found && take_injected)
+        found = pop_head(&(pool->injection), task);
+    for (int i = 1; !found && i < pool->thread_count; i++)
+        found = pop_head(&(pool->queues)[(index + i) % pool->thread_count], task);
+
+    if (found)
+        atomic_fetch_sub(&(pool->queued), 1);
+    return found;
+}
+
+void notify_workers(ThreadPool *pool) {
+    pthread_mutex_lock(&(pool->lock));
+    atomic_fetch_add(&(pool->queued), 1);
+    pthread_cond_signal(&(pool->wakeup));
+    pthread_mutex_unlock(&(pool->lock));
+}
+
+void init_queue(TaskQueue *queue) {
+    queue->capacity = 16;
+    queue->head = 0;
+    queue->size = 0;
+    queue->tasks = malloc(queue->capacity * sizeof(Task));
+    if (!(queue->tasks)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&(queue->lock), NULL);
+}
+
+void push_tail(TaskQueue *queue, Task task) {
+    pthread_mutex_lock(&(queue->lock));
+    if (queue->size == queue->capacity) {
+        // Unroll circular buffer into bigger array
+        Task *tasks = malloc(2 * queue->capacity * sizeof(Task));
+        if (!tasks) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < queue->size; i++)
+            tasks[i] = (queue->tasks)[(queue->head + i) % queue->capacity];
+        free(queue->tasks);
+        queue->tasks = tasks;
+        queue->head = 0;
+        queue->capacity *= 2;
+    }
+    (queue->tasks)[(queue->head + queue->size) % queue->capacity] = task;
+    queue->size++;
+    pthread_mutex_unlock(&(queue->lock));
+}
+
+bool pop_tail(TaskQueue *queue, Task *task) {
+    pthread_mutex_lock(&(queue->lock));
+    bool found = queue->size > 0;
+    if (found) {
+        queue->size--;
+        *task = (queue->tasks)[(queue->head + queue->size) % queue->capacity];
+    }
+    pthread_mutex_unlock(&(queue->lock));
+    return found;
+}
+
+bool pop_head(TaskQueue *queue, Task *task) {
+    pthread_mutex_lock(&(queue->lock));
+    bool found = queue->size > 0;
+    if (found) {
+        *task = (queue->tasks)[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->size--;
+    }
+    pthread_mutex_unlock(&(queue->lock));
+    return found;
+}
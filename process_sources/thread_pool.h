@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timer.h"
+
+typedef void (*TaskFunction)(void*);
+
+typedef struct {
+    TaskFunction function;
+    void *argument;
+} Task;
+
+/* Circular double-ended queue. Owner pushes and pops at tail, thieves take from head. */
+typedef struct {
+    Task *tasks;
+    int capacity;
+    int head;
+    int size;
+    pthread_mutex_t lock;
+} TaskQueue;
+
+typedef struct {
+    int thread_count;
+    pthread_t *threads;         // Worker threads, worker 0 is the thread which created the pool
+    TaskQueue *queues;          // Own queue of each worker
+    TaskQueue injection;        // Tasks submitted with inject_task, taken in FIFO order
+    atomic_int queued;          // Number of tasks in all queues
+    atomic_bool stop;
+    bool pin;                   // Pin worker i to CPU i
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+} ThreadPool;
+
+void init_thread_pool(ThreadPool*, const int, bool);
+void inject_task(ThreadPool*, TaskFunction, void*);
+void submit_task(ThreadPool*, TaskFunction, void*);
+void wait_for_tasks(ThreadPool*, atomic_int*, bool);
+int current_worker(void);
+void free_thread_pool(ThreadPool*);
+
+#endif
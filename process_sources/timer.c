@@ -0,0 +1,27 @@
+// cpu_set_t and pthread_setaffinity_np are GNU extensions
+#define _GNU_SOURCE
+#include "timer.h"
+
+/* CPU time consumed by calling thread in seconds. Unlike clock(), it is not affected by other threads. */
+double thread_cpu_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Wall-clock time in seconds, not affected by NTP adjustments */
+double monotonic_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Pins calling thread to CPU with given index (modulo number of online CPUs) */
+void pin_current_thread(const int index) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % (cpu_count > 0 ? cpu_count : 1), &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        fprintf(stderr, "Warning: Unable to pin thread to CPU %d\n", index);
+}
@@ -0,0 +1,14 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+double thread_cpu_time(void);
+double monotonic_time(void);
+void pin_current_thread(const int);
+
+#endif
@@ -1,35 +1,53 @@
 #include "tree_optimization.h"
 
-bool dfs_find_cycle(myGraph*, int, int, bool*);
+typedef struct {
+    int count;          // Number of vertices in the rooted tree, virtual root included
+    int root;
+    int *order;         // BFS order, vertices are grouped by levels
+    int *level_start;   // Index in order where each level starts, level_count + 1 items
+    int level_count;
+    int *parent;
+    int *child_count;
+} RootedTree;
+
 int* find_tree_centers(myGraph*, int*);
-char* encode_tree(myGraph*, int, int);
+void root_tree(myGraph*, const int*, const int, RootedTree*);
+void sort_tuples(const int, const int*, const int*, const int*, const int, int*);
+void* allocate_memory(const size_t);
 
+/* Tree has n-1 edges and is connected. Connectivity is checked by BFS with explicit queue. */
 bool is_tree(myGraph *graph) {
     if (!graph || graph->vertex_count == 0)
         return false;
 
-    bool *visited = calloc(graph->vertex_count, sizeof(bool));
-    if (!visited) {
-        perror("calloc");
+    const int n = graph->vertex_count;
+    if (graph->edge_count != n - 1)
         return false;
-    }
 
-    // Start DFS from vertex 0
-    if (!dfs_find_cycle(graph, 0, -1, visited)) {
-        free(visited);
-        return false;  // Found a cycle
-    }
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    bool *visited = arena_calloc(arena, n, sizeof(bool));
+    int *queue = arena_alloc(arena, n * sizeof(int));
 
-    // Check if all vertices were visited (graph is connected)
-    for (int i = 0; i < graph->vertex_count; ++i) {
-        if (!visited[i]) {
-            free(visited);
-            return false;  // Graph is disconnected
+    int head = 0, tail = 0;
+    queue[tail++] = 0;
+    visited[0] = true;
+    while (head < tail) {
+        const int v = queue[head++];
+        const int *neighbours = mygraph_neighbours(graph, v);
+        for (int i = 0; i < mygraph_degree(graph, v); i++) {
+            const int neighbour = neighbours[i];
+            if (!visited[neighbour]) {
+                visited[neighbour] = true;
+                queue[tail++] = neighbour;
+            }
         }
     }
 
-    free(visited);
-    return true;
+    arena_release(arena, mark);
+
+    // With n-1 edges, the graph is a tree iff it is connected
+    return tail == n;
 }
 
 bool check_isomorphism_tree(myGraph *g1, myGraph *g2) {
@@ -37,74 +55,117 @@ bool check_isomorphism_tree(myGraph *g1, myGraph *g2) {
         return false;
     }
 
-    // Find centers
-    int center_count1, center_count2;
-    int *centers1 = find_tree_centers(g1, &center_count1);
-    int *centers2 = find_tree_centers(g2, &center_count2);
-
-    // Prepare memory for encodings for centers2
-    char **encodings2 = malloc(center_count2 * sizeof(char*));
-
-    // Create encodings for centers1 and compare to encodings for centers2
-    for (int i = 0; i < center_count1; i++) {
-        char *encoding1 = encode_tree(g1, centers1[i], -1);
-        for (int j = 0; j < center_count2; j++) {
-            // Create only once
-            if (i == 0) encodings2[j] = encode_tree(g2, centers2[j], -1);
-            // If encoding are the same, then trees are isomorphic
-            if (strcmp(encoding1, encodings2[j]) == 0) {
-                // Free memory
-                for (int k = 0; k < center_count1; k++) {
-                    free(encodings2[k]);
-                }
-                free(encodings2);
-                free(encoding1);
-                free(centers1);
-                free(centers2);
-                return true;
-            }
-        }
-        free(encoding1);
-    }
+    int length1, length2;
+    int *encoding1 = encode_tree(g1, &length1);
+    int *encoding2 = encode_tree(g2, &length2);
 
-    // Free memory
-    for (int i = 0; i < center_count1; i++) {
-        free(encodings2[i]);
-    }
-    free(encodings2);
-    free(centers1);
-    free(centers2);
-    return false;
+    bool result = length1 == length2 && memcmp(encoding1, encoding2, length1 * sizeof(int)) == 0;
+
+    free(encoding1);
+    free(encoding2);
+    return result;
 }
 
-bool dfs_find_cycle(myGraph *graph, int current, int parent, bool *visited) {
-    visited[current] = true;
+/* AHU encoding with integer labels, computed level by level from the deepest one without recursion.
+   Tree is rooted in its center, or in a virtual root between two centers. In each level, children labels
+   of every vertex form a sorted tuple, tuples are sorted lexicographically and equal tuples get equal label.
+   Encoding is a sequence of levels, each level is its size followed by (child count, tuple) of its sorted vertices.
+   Two trees are isomorphic iff their encodings are equal. Total time is O(n).
+   Encoding is allocated by malloc, work memory comes from arena of thread and is released before return. */
+int* encode_tree(myGraph *graph, int *length) {
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int center_count;
+    int *centers = find_tree_centers(graph, &center_count);
+
+    RootedTree tree;
+    root_tree(graph, centers, center_count, &tree);
 
-    myVertex v = graph->vertices[current];
-    for (int i = 0; i < v.neighbour_count; i++) {
-        int neighbor = v.neighbours[i];
+    const int count = tree.count;
+    int *label = arena_alloc(arena, count * sizeof(int));
+    int *tuple_offset = arena_alloc(arena, count * sizeof(int));
+    int *filled = arena_alloc(arena, count * sizeof(int));
+    int *tuples = arena_alloc(arena, count * sizeof(int));        // Children labels of one level, sum of child counts < count
+    int *offsets = arena_alloc(arena, count * sizeof(int));       // Offsets and lengths of tuples indexed by position in level
+    int *lengths = arena_alloc(arena, count * sizeof(int));
+    int *sorted = arena_alloc(arena, count * sizeof(int));        // Positions in level sorted by tuple
+    int *sorted_vertices = arena_alloc(arena, count * sizeof(int));
+    int *previous_sorted = arena_alloc(arena, count * sizeof(int));
+    int previous_size = 0;
 
-        if (!visited[neighbor]) {
-            if (!dfs_find_cycle(graph, neighbor, current, visited))
-                return false;
-        } else if (neighbor != parent) {
-            // Found a cycle
-            return false;
+    // Each vertex contributes its child count and its label in tuple of parent, each level its size
+    int *encoding = allocate_memory((2 * count + tree.level_count) * sizeof(int));
+    int pos = 0;
+
+    for (int level = tree.level_count - 1; level >= 0; level--) {
+        const int *vertices = tree.order + tree.level_start[level];
+        const int size = tree.level_start[level + 1] - tree.level_start[level];
+
+        // Reserve space for children labels of each vertex
+        int tuple_size = 0;
+        for (int i = 0; i < size; i++) {
+            const int v = vertices[i];
+            tuple_offset[v] = tuple_size;
+            filled[v] = 0;
+            offsets[i] = tuple_size;
+            lengths[i] = tree.child_count[v];
+            tuple_size += tree.child_count[v];
+        }
+
+        // Children visited in order of their labels, so each tuple is sorted without comparisons
+        for (int i = 0; i < previous_size; i++) {
+            const int child = previous_sorted[i];
+            const int p = tree.parent[child];
+            tuples[tuple_offset[p] + filled[p]++] = label[child];
+        }
+
+        // Alphabet of this level are labels of the previous level, which are smaller than its size
+        sort_tuples(size, offsets, lengths, tuples, previous_size > 0 ? previous_size : 1, sorted);
+
+        // Equal tuples get equal labels
+        encoding[pos++] = size;
+        int current_label = 0;
+        for (int i = 0; i < size; i++) {
+            const int index = sorted[i];
+            if (i > 0) {
+                const int prev = sorted[i - 1];
+                if (lengths[prev] != lengths[index] ||
+                    memcmp(tuples + offsets[prev], tuples + offsets[index], lengths[index] * sizeof(int)) != 0)
+                    current_label++;
+            }
+            label[vertices[index]] = current_label;
+            sorted_vertices[i] = vertices[index];
+
+            encoding[pos++] = lengths[index];
+            memcpy(encoding + pos, tuples + offsets[index], lengths[index] * sizeof(int));
+            pos += lengths[index];
         }
+
+        int *swap = previous_sorted;
+        previous_sorted = sorted_vertices;
+        sorted_vertices = swap;
+        previous_size = size;
     }
-    return true;
+
+    arena_release(arena, mark);
+
+    *length = pos;
+    return encoding;
 }
 
-/* Iteratively removes leaves of graph, so in the end only the center will remain  */
+/* Iteratively removes leaves of graph, so in the end only the center will remain. Centers and work arrays are
+   allocated from arena of thread. */
 int* find_tree_centers(myGraph *graph, int *center_count) {
+    Arena *arena = thread_arena();
     int n = graph->vertex_count;
-    int *degree = malloc(n * sizeof(int));
-    int *leaves = malloc(n * sizeof(int));
+    int *degree = arena_alloc(arena, n * sizeof(int));
+    int *leaves = arena_alloc(arena, n * sizeof(int));
+    int *new_leaves = arena_alloc(arena, n * sizeof(int));
     int leaf_count = 0;
 
     // Initiate degree list and origin leaves list
     for (int i = 0; i < n; i++) {
-        degree[i] = graph->vertices[i].neighbour_count;
+        degree[i] = mygraph_degree(graph, i);
         if (degree[i] <= 1) {
             leaves[leaf_count++] = i;
         }
@@ -113,16 +174,15 @@ int* find_tree_centers(myGraph *graph, int *center_count) {
     int processed = leaf_count;
     // Repeat until all nodes are processed (removed as leaves)
     while (processed < n) {
-        // List for new leaves
-        int new_leaves[graph->vertex_count];
         int new_leaf_count = 0;
 
         // Iterate through each current leaf and "remove" it (just decrement degree of neighbors)
         for (int i = 0; i < leaf_count; i++) {
             int leaf = leaves[i];
             // Iterate through neighbors of leaf and decrement degree
-            for (int j = 0; j < graph->vertices[leaf].neighbour_count; j++) {
-                int neighbor = graph->vertices[leaf].neighbours[j];
+            const int *neighbours = mygraph_neighbours(graph, leaf);
+            for (int j = 0; j < mygraph_degree(graph, leaf); j++) {
+                int neighbor = neighbours[j];
                 degree[neighbor]--;
                 // If degree becomes 1, new leaf has appeared
                 if (degree[neighbor] == 1) {
@@ -132,65 +192,196 @@ int* find_tree_centers(myGraph *graph, int *center_count) {
         }
 
         // New leaves are now old leaves
-        memcpy(leaves, new_leaves, new_leaf_count * sizeof(int));
+        int *swap = leaves;
+        leaves = new_leaves;
+        new_leaves = swap;
         leaf_count = new_leaf_count;
 
         processed += new_leaf_count;
     }
 
     // One or two last leaves are center(s)
-    int *centers = malloc(leaf_count * sizeof(int));
-    memcpy(centers, leaves, leaf_count * sizeof(int));
     *center_count = leaf_count;
-
-    // Free memory
-    free(degree);
-    free(leaves);
-
-    return centers;
+    return leaves;
 }
 
-/* AHU encoding for tree isomorphism detection algorithm with linear complexity. */
-char* encode_tree(myGraph *graph, int root, int parent) {
-    int child_count = 0;
-    char **child_encodings = malloc(graph->vertex_count * sizeof(char*));
+/* BFS from center. Two centers become children of virtual root with index n, edge between them is ignored.
+   Arrays of tree are allocated from arena of thread. */
+void root_tree(myGraph *graph, const int *centers, const int center_count, RootedTree *tree) {
+    Arena *arena = thread_arena();
+    const int n = graph->vertex_count;
+    const int count = center_count == 2 ? n + 1 : n;
 
-    // Recursive step
-    for (int i = 0; i < graph->vertices[root].neighbour_count; i++) {
-        int neighbor = graph->vertices[root].neighbours[i];
-        if (neighbor != parent) {
-            child_encodings[child_count++] = encode_tree(graph, neighbor, root);
+    tree->count = count;
+    tree->order = arena_alloc(arena, count * sizeof(int));
+    tree->parent = arena_alloc(arena, count * sizeof(int));
+    tree->child_count = arena_calloc(arena, count, sizeof(int));
+    int *level = arena_alloc(arena, count * sizeof(int));
+
+    int head = 0, tail = 0;
+    if (center_count == 2) {
+        tree->root = n;
+        tree->order[tail++] = n;
+        tree->parent[n] = -1;
+        level[n] = 0;
+        tree->child_count[n] = 2;
+        for (int i = 0; i < 2; i++) {
+            tree->order[tail++] = centers[i];
+            tree->parent[centers[i]] = n;
+            level[centers[i]] = 1;
         }
+        head = 1;
+    } else {
+        tree->root = centers[0];
+        tree->order[tail++] = centers[0];
+        tree->parent[centers[0]] = -1;
+        level[centers[0]] = 0;
     }
 
-    // Sort the child encodings
-    for (int i = 0; i < child_count - 1; i++) {
-        for (int j = i + 1; j < child_count; j++) {
-            if (strcmp(child_encodings[i], child_encodings[j]) > 0) {
-                char *temp = child_encodings[i];
-                child_encodings[i] = child_encodings[j];
-                child_encodings[j] = temp;
-            }
+    while (head < tail) {
+        const int v = tree->order[head++];
+        if (v == n) continue;
+        const int *neighbours = mygraph_neighbours(graph, v);
+        for (int i = 0; i < mygraph_degree(graph, v); i++) {
+            const int neighbour = neighbours[i];
+            if (neighbour == tree->parent[v]) continue;
+            if (center_count == 2 && (v == centers[0] || v == centers[1]) &&
+                (neighbour == centers[0] || neighbour == centers[1])) continue;
+            tree->parent[neighbour] = v;
+            level[neighbour] = level[v] + 1;
+            tree->child_count[v]++;
+            tree->order[tail++] = neighbour;
         }
     }
 
-    // Concatenate the encodings
-    int total_length = 2; // for the parentheses
-    for (int i = 0; i < child_count; i++) {
-        total_length += strlen(child_encodings[i]);
+    // BFS order is sorted by level
+    tree->level_count = level[tree->order[count - 1]] + 1;
+    tree->level_start = arena_alloc(arena, (tree->level_count + 1) * sizeof(int));
+    int current = -1;
+    for (int i = 0; i < count; i++) {
+        while (current < level[tree->order[i]])
+            tree->level_start[++current] = i;
     }
+    tree->level_start[tree->level_count] = count;
+}
 
-    char *encoding = malloc((total_length + 1) * sizeof(char));
-    encoding[0] = '(';
-    int pos = 1;
-    for (int i = 0; i < child_count; i++) {
-        strcpy(encoding + pos, child_encodings[i]);
-        pos += strlen(child_encodings[i]);
-        free(child_encodings[i]);
+/* Lexicographic sort of variable-length tuples over alphabet 0..alphabet-1 in O(total length + alphabet),
+   as described by Aho, Hopcroft and Ullman. Writes indices of tuples in sorted order. */
+void sort_tuples(const int count, const int *offsets, const int *lengths, const int *tuples, const int alphabet, int *sorted) {
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int max_length = 0;
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        if (lengths[i] > max_length) max_length = lengths[i];
+        total += lengths[i];
     }
-    encoding[pos++] = ')';
-    encoding[pos] = '\0';
 
-    free(child_encodings);
-    return encoding;
+    // Group tuples by length (counting sort)
+    int *length_start = arena_calloc(arena, max_length + 2, sizeof(int));
+    int *by_length = arena_alloc(arena, (count > 0 ? count : 1) * sizeof(int));
+    for (int i = 0; i < count; i++)
+        length_start[lengths[i] + 1]++;
+    for (int l = 0; l <= max_length; l++)
+        length_start[l + 1] += length_start[l];
+    int *fill = arena_alloc(arena, (max_length + 1) * sizeof(int));
+    memcpy(fill, length_start, (max_length + 1) * sizeof(int));
+    for (int i = 0; i < count; i++)
+        by_length[fill[lengths[i]]++] = i;
+
+    // Distinct symbols occurring at each position, in increasing order.
+    // Pairs (position, symbol) are sorted by symbol and then stably by position.
+    int *symbol_start = arena_calloc(arena, alphabet + 1, sizeof(int));
+    int *position_start = arena_calloc(arena, max_length + 1, sizeof(int));
+    int *pair_by_symbol = arena_alloc(arena, (total > 0 ? total : 1) * sizeof(int));
+    int *pair_position = arena_alloc(arena, (total > 0 ? total : 1) * sizeof(int));
+    int *pair_symbol = arena_alloc(arena, (total > 0 ? total : 1) * sizeof(int));
+    for (int i = 0; i < count; i++)
+        for (int p = 0; p < lengths[i]; p++)
+            symbol_start[tuples[offsets[i] + p] + 1]++;
+    for (int s = 0; s < alphabet; s++)
+        symbol_start[s + 1] += symbol_start[s];
+    int k = 0;
+    for (int i = 0; i < count; i++) {
+        for (int p = 0; p < lengths[i]; p++) {
+            pair_position[k] = p;
+            pair_symbol[k] = tuples[offsets[i] + p];
+            k++;
+        }
+    }
+    for (int j = 0; j < total; j++)
+        pair_by_symbol[symbol_start[pair_symbol[j]]++] = j;
+    for (int j = 0; j < total; j++)
+        position_start[pair_position[j]]++;
+    for (int p = 0, sum = 0; p < max_length; p++) {
+        const int c = position_start[p];
+        position_start[p] = sum;
+        sum += c;
+    }
+    position_start[max_length] = total;
+    int *distinct = arena_alloc(arena, (total > 0 ? total : 1) * sizeof(int));
+    int *distinct_count = arena_calloc(arena, max_length > 0 ? max_length : 1, sizeof(int));
+    for (int j = 0; j < total; j++) {
+        const int pair = pair_by_symbol[j];
+        const int p = pair_position[pair];
+        const int symbol = pair_symbol[pair];
+        int *symbols = distinct + position_start[p];
+        if (distinct_count[p] == 0 || symbols[distinct_count[p] - 1] != symbol)
+            symbols[distinct_count[p]++] = symbol;
+    }
+
+    // Radix sort from the last position. Tuples ending at current position are placed before longer ones.
+    int *bucket_head = arena_alloc(arena, alphabet * sizeof(int));
+    int *bucket_tail = arena_alloc(arena, alphabet * sizeof(int));
+    int *next = arena_alloc(arena, (count > 0 ? count : 1) * sizeof(int));
+    int *queue = arena_alloc(arena, (count > 0 ? count : 1) * sizeof(int));
+    int *current = arena_alloc(arena, (count > 0 ? count : 1) * sizeof(int));
+    for (int s = 0; s < alphabet; s++)
+        bucket_head[s] = -1;
+    int queue_size = 0;
+
+    for (int p = max_length - 1; p >= 0; p--) {
+        int current_size = 0;
+        for (int j = length_start[p + 1]; j < length_start[p + 2]; j++)
+            current[current_size++] = by_length[j];
+        memcpy(current + current_size, queue, queue_size * sizeof(int));
+        current_size += queue_size;
+
+        // Stable distribution into buckets
+        for (int j = 0; j < current_size; j++) {
+            const int i = current[j];
+            const int symbol = tuples[offsets[i] + p];
+            next[i] = -1;
+            if (bucket_head[symbol] < 0) bucket_head[symbol] = i;
+            else next[bucket_tail[symbol]] = i;
+            bucket_tail[symbol] = i;
+        }
+
+        // Collect only non-empty buckets
+        queue_size = 0;
+        const int *symbols = distinct + position_start[p];
+        for (int j = 0; j < distinct_count[p]; j++) {
+            const int symbol = symbols[j];
+            for (int i = bucket_head[symbol]; i >= 0; i = next[i])
+                queue[queue_size++] = i;
+            bucket_head[symbol] = -1;
+        }
+    }
+
+    // Empty tuples are the smallest
+    int sorted_size = 0;
+    for (int j = length_start[0]; j < length_start[1]; j++)
+        sorted[sorted_size++] = by_length[j];
+    memcpy(sorted + sorted_size, queue, queue_size * sizeof(int));
+
+    arena_release(arena, mark);
+}
+
+void* allocate_memory(const size_t size) {
+    void *memory = malloc(size > 0 ? size : 1);
+    if (!memory) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
 }
@@ -4,9 +4,12 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include "my_graph.h"
+#include "arena.h"
 
 bool is_tree(myGraph*);
 bool check_isomorphism_tree(myGraph*, myGraph*);
+int* encode_tree(myGraph*, int*);
 
 #endif
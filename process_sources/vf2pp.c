@@ -0,0 +1,381 @@
+#include "vf2pp.h"
+
+void prepare_match_entry(MatchEntry*, graph*, const int);
+int refine_match_colours(MatchEntry*, const int*);
+int count_colours(const uint64_t*, uint64_t*, const int);
+int colour_class_size(const uint64_t*, const int, const uint64_t);
+void compute_match_order(MatchEntry*, const int*, const uint64_t*);
+bool search_mapping(const MatchEntry*, const MatchEntry*, const Budget*, bool*, SearchStats*);
+int next_candidate(const MatchEntry*, const MatchEntry*, const int*, const set*, const int, const int);
+bool feasible_pair(const MatchEntry*, const MatchEntry*, const int*, const set*, const set*, const int, const int);
+
+void init_match_cache(MatchCache *cache, const int count, const Budget *budget) {
+    cache->count = count;
+    cache->budget = *budget;
+    init_instrumentation(&(cache->search));
+    cache->entries = calloc(count > 0 ? count : 1, sizeof(MatchEntry));
+    if (!cache->entries) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Returns graphs[index] prepared for matching, preparing it only on the first request */
+MatchEntry* get_match_entry(MatchCache *cache, const GraphFile *graphs, const int index) {
+    MatchEntry *entry = &(cache->entries)[index];
+    if (!entry->g)
+        prepare_match_entry(entry, get_graph(graphs, index), graph_file_order(graphs, index));
+    return entry;
+}
+
+/* Decides isomorphism of graphs[i] and graphs[j] by searching for a mapping between them, without canonical forms.
+   Pair is censored if search exceeded budget, then result is unknown. Returns time of search, preparation of
+   graphs is amortised by match_cache_time. */
+double match_graphs(MatchCache *cache, const GraphFile *graphs, const int i, const int j, bool *isomorphic, bool *censored) {
+    const MatchEntry *entry1 = get_match_entry(cache, graphs, i);
+    const MatchEntry *entry2 = get_match_entry(cache, graphs, j);
+    const bool budgeted = cache->budget.time > 0 || cache->budget.nodes > 0;
+
+    const double start = thread_cpu_time();
+    SearchStats search;
+    memset(&search, 0, sizeof(search));
+    *censored = false;
+    *isomorphic = entry1->n == entry2->n && entry1->hash == entry2->hash &&
+                  search_mapping(entry1, entry2, budgeted ? &(cache->budget) : NULL, censored, &search);
+    const double end = thread_cpu_time();
+
+    add_search_stats(&(cache->search), &search);
+    return end - start;
+}
+
+double match_cache_time(const MatchCache *cache) {
+    double time = 0.0;
+    for (int i = 0; i < cache->count; i++)
+        time += (cache->entries)[i].time;
+    return time;
+}
+
+/* Each matched pair counts as one labelling, dead ends of its search as bad leaves */
+void match_cache_instrumentation(const MatchCache *cache, Instrumentation *instrumentation) {
+    const Instrumentation *search = &(cache->search);
+    instrumentation->labellings += search->labellings;
+    instrumentation->nodes += search->nodes;
+    if (search->max_nodes > instrumentation->max_nodes) instrumentation->max_nodes = search->max_nodes;
+    instrumentation->bad_leaves += search->bad_leaves;
+    if (search->max_level > instrumentation->max_level) instrumentation->max_level = search->max_level;
+}
+
+/* Arrays of entries are in arena, they are released when set ends */
+void free_match_cache(MatchCache *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->count = 0;
+}
+
+/* Copies graph, because decoded graph lives in per-thread buffer, then refines colours and orders vertices.
+   Entry is allocated from arena of thread before work arrays, which are released when it is prepared. */
+void prepare_match_entry(MatchEntry *entry, graph *g, const int n) {
+    const int m = SETWORDSNEEDED(n);
+    Arena *arena = thread_arena();
+    entry->n = n;
+    entry->m = m;
+    entry->g = arena_alloc(arena, (n > 0 ? n : 1) * (size_t)m * sizeof(setword));
+    entry->colours = arena_alloc(arena, n * sizeof(uint64_t));
+    entry->order = arena_alloc(arena, n * sizeof(int));
+    entry->parent = arena_alloc(arena, n * sizeof(int));
+
+    const ArenaMark mark = arena_mark(arena);
+    int *degrees = arena_calloc(arena, n, sizeof(int));
+    uint64_t *sorted = arena_alloc(arena, n * sizeof(uint64_t));
+    memcpy(entry->g, g, n * (size_t)m * sizeof(setword));
+
+    const double start = thread_cpu_time();
+    for (int v = 0; v < n; v++) {
+        const set *row = GRAPHROW(entry->g, v, m);
+        for (int k = 0; k < m; k++)
+            degrees[v] += POPCOUNT(row[k]);
+    }
+
+    // Rounds are part of hash, isomorphic graphs become stable after the same number of rounds
+    const int rounds = refine_match_colours(entry, degrees);
+    count_colours(entry->colours, sorted, n);
+    uint64_t hash = mix_colour((uint64_t)rounds);
+    for (int v = 0; v < n; v++)
+        hash = mix_colour(hash ^ sorted[v]);
+    entry->hash = hash;
+
+    compute_match_order(entry, degrees, sorted);
+    entry->time = thread_cpu_time() - start;
+
+    arena_release(arena, mark);
+}
+
+/* 1-WL colour refinement from degrees, the same mixing as in prefilter. Stops when a round splits no colour class.
+   Returns number of rounds. */
+int refine_match_colours(MatchEntry *entry, const int *degrees) {
+    const int n = entry->n;
+    const int m = entry->m;
+    uint64_t *colours = entry->colours;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    uint64_t *next = arena_alloc(arena, n * sizeof(uint64_t));
+    uint64_t *sorted = arena_alloc(arena, n * sizeof(uint64_t));
+
+    for (int v = 0; v < n; v++)
+        colours[v] = (uint64_t)degrees[v];
+    int classes = count_colours(colours, sorted, n);
+
+    int rounds = 0;
+    while (rounds < MATCH_REFINE_ROUNDS && classes < n) {
+        for (int v = 0; v < n; v++) {
+            const set *row = GRAPHROW(entry->g, v, m);
+            uint64_t sum = 0;
+            for (int k = 0; k < m; k++) {
+                setword word = row[k];
+                while (word) {
+                    int bit_index;
+                    TAKEBIT(bit_index, word);
+                    sum += mix_colour(colours[TIMESWORDSIZE(k) + bit_index]);
+                }
+            }
+            next[v] = mix_colour(colours[v] ^ (sum * 0x9e3779b97f4a7c15ULL));
+        }
+        memcpy(colours, next, n * sizeof(uint64_t));
+        rounds++;
+
+        const int refined = count_colours(colours, sorted, n);
+        if (refined == classes) break;
+        classes = refined;
+    }
+
+    arena_release(arena, mark);
+    return rounds;
+}
+
+/* Sorts copy of colours into sorted and returns number of distinct colours */
+int count_colours(const uint64_t *colours, uint64_t *sorted, const int n) {
+    memcpy(sorted, colours, n * sizeof(uint64_t));
+    qsort(sorted, n, sizeof(uint64_t), compare_colours);
+    int classes = 0;
+    for (int v = 0; v < n; v++) {
+        if (v == 0 || sorted[v] != sorted[v - 1]) classes++;
+    }
+    return classes;
+}
+
+/* Number of vertices with given colour, found by binary search for both ends of its run in sorted colours */
+int colour_class_size(const uint64_t *sorted, const int n, const uint64_t colour) {
+    int low = 0, high = n;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (sorted[middle] < colour) low = middle + 1;
+        else high = middle;
+    }
+    const int first = low;
+    high = n;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (sorted[middle] <= colour) low = middle + 1;
+        else high = middle;
+    }
+    return low - first;
+}
+
+/* VF2++ order: breadth-first search from vertex of the rarest colour with the highest degree. Inside each level vertex
+   with most already ordered neighbours goes first, then the one with higher degree, then the one of rarer colour.
+   Such vertices have fewest candidates, so mismatches are found near the root of search. */
+void compute_match_order(MatchEntry *entry, const int *degrees, const uint64_t *sorted) {
+    const int n = entry->n;
+    const int m = entry->m;
+    Arena *arena = thread_arena();
+    const ArenaMark mark = arena_mark(arena);
+    int *rarity = arena_alloc(arena, n * sizeof(int));
+    int *connections = arena_calloc(arena, n, sizeof(int));
+    int *link = arena_alloc(arena, n * sizeof(int));
+    int *level = arena_alloc(arena, n * sizeof(int));
+    int *next_level = arena_alloc(arena, n * sizeof(int));
+    bool *visited = arena_calloc(arena, n, sizeof(bool));
+    for (int v = 0; v < n; v++) {
+        rarity[v] = colour_class_size(sorted, n, entry->colours[v]);
+        link[v] = -1;
+    }
+
+    int ordered = 0;
+    while (ordered < n) {
+        // Root of next component
+        int root = -1;
+        for (int v = 0; v < n; v++) {
+            if (visited[v]) continue;
+            if (root < 0 || rarity[v] < rarity[root] || (rarity[v] == rarity[root] && degrees[v] > degrees[root]))
+                root = v;
+        }
+        visited[root] = true;
+        level[0] = root;
+        int level_count = 1;
+
+        while (level_count > 0) {
+            for (int t = 0; t < level_count; t++) {
+                int best = t;
+                for (int u = t + 1; u < level_count; u++) {
+                    const int v = level[u], b = level[best];
+                    if (connections[v] != connections[b]) {
+                        if (connections[v] > connections[b]) best = u;
+                    } else if (degrees[v] != degrees[b]) {
+                        if (degrees[v] > degrees[b]) best = u;
+                    } else if (rarity[v] < rarity[b]) {
+                        best = u;
+                    }
+                }
+                const int v = level[best];
+                level[best] = level[t];
+                level[t] = v;
+
+                entry->order[ordered] = v;
+                entry->parent[ordered] = link[v];
+                ordered++;
+                const set *row = GRAPHROW(entry->g, v, m);
+                for (int k = 0; k < m; k++) {
+                    setword word = row[k];
+                    while (word) {
+                        int bit_index;
+                        TAKEBIT(bit_index, word);
+                        const int w = TIMESWORDSIZE(k) + bit_index;
+                        connections[w]++;
+                        if (link[w] < 0) link[w] = v;
+                    }
+                }
+            }
+
+            int next_count = 0;
+            for (int t = 0; t < level_count; t++) {
+                const set *row = GRAPHROW(entry->g, level[t], m);
+                for (int k = 0; k < m; k++) {
+                    setword word = row[k];
+                    while (word) {
+                        int bit_index;
+                        TAKEBIT(bit_index, word);
+                        const int w = TIMESWORDSIZE(k) + bit_index;
+                        if (visited[w]) continue;
+                        visited[w] = true;
+                        next_level[next_count++] = w;
+                    }
+                }
+            }
+            int *swap = level;
+            level = next_level;
+            next_level = swap;
+            level_count = next_count;
+        }
+    }
+
+    arena_release(arena, mark);
+}
+
+/* Depth-first search of mapping of entry1 onto entry2, vertex order[d] of entry1 is matched at depth d.
+   Candidates are unmatched neighbours of image of parent with the same colour, matched neighbourhoods
+   are compared by bitset intersections. Search stops at the first complete mapping. */
+bool search_mapping(const MatchEntry *entry1, const MatchEntry *entry2, const Budget *budget, bool *censored, SearchStats *search) {
+    DYNALLSTAT(int,core,core_sz);
+    DYNALLSTAT(int,tried,tried_sz);
+    DYNALLSTAT(set,matched1,matched1_sz);
+    DYNALLSTAT(set,matched2,matched2_sz);
+
+    const int n = entry1->n;
+    const int m = entry1->m;
+    if (n == 0) return true;
+    DYNALLOC1(int,core,core_sz,n,"search_mapping");
+    DYNALLOC1(int,tried,tried_sz,n,"search_mapping");
+    DYNALLOC1(set,matched1,matched1_sz,m,"search_mapping");
+    DYNALLOC1(set,matched2,matched2_sz,m,"search_mapping");
+    EMPTYSET(matched1, m);
+    EMPTYSET(matched2, m);
+
+    long nodes_left = budget && budget->nodes > 0 ? budget->nodes : -1;
+    const double deadline = budget && budget->time > 0 ? monotonic_time() + budget->time : -1.0;
+
+    int depth = 0;
+    tried[0] = -1;
+    while (depth < n) {
+        const int v = entry1->order[depth];
+        int w = next_candidate(entry1, entry2, core, matched2, depth, tried[depth] + 1);
+        while (w >= 0 && !feasible_pair(entry1, entry2, core, matched1, matched2, v, w))
+            w = next_candidate(entry1, entry2, core, matched2, depth, w + 1);
+
+        // Dead end, previous vertex tries its next candidate
+        if (w < 0) {
+            search->bad_leaves++;
+            if (--depth < 0) return false;
+            const int u = entry1->order[depth];
+            DELELEMENT(matched1, u);
+            DELELEMENT(matched2, core[u]);
+            continue;
+        }
+
+        tried[depth] = w;
+        core[v] = w;
+        ADDELEMENT(matched1, v);
+        ADDELEMENT(matched2, w);
+        search->nodes++;
+        if (depth + 1 > search->max_level) search->max_level = depth + 1;
+        if (nodes_left > 0 && --nodes_left == 0) {
+            *censored = true;
+            return false;
+        }
+        if (deadline > 0 && search->nodes % MATCH_BUDGET_PERIOD == 0 && monotonic_time() > deadline) {
+            *censored = true;
+            return false;
+        }
+
+        if (++depth < n) tried[depth] = -1;
+    }
+    return true;
+}
+
+/* First unmatched vertex w >= from of entry2 with colour of order[depth], which is adjacent to image of parent */
+int next_candidate(const MatchEntry *entry1, const MatchEntry *entry2, const int *core, const set *matched2,
+                   const int depth, const int from) {
+    const int n = entry1->n;
+    const int m = entry1->m;
+    const uint64_t colour = entry1->colours[entry1->order[depth]];
+    const int parent = entry1->parent[depth];
+    const set *row = parent >= 0 ? GRAPHROW(entry2->g, core[parent], m) : NULL;
+
+    for (int k = SETWD(from); k < m; k++) {
+        setword word = row ? row[k] : ~(setword)0;
+        word &= ~matched2[k];
+        if (k == SETWD(from)) word &= ~ALLMASK(SETBT(from));
+        if (k == m - 1 && n - TIMESWORDSIZE(k) < WORDSIZE) word &= ALLMASK(n - TIMESWORDSIZE(k));
+        while (word) {
+            int bit_index;
+            TAKEBIT(bit_index, word);
+            const int w = TIMESWORDSIZE(k) + bit_index;
+            if (entry2->colours[w] == colour) return w;
+        }
+    }
+    return -1;
+}
+
+/* Matched neighbours of v have to be mapped exactly onto matched neighbours of w */
+bool feasible_pair(const MatchEntry *entry1, const MatchEntry *entry2, const int *core, const set *matched1,
+                   const set *matched2, const int v, const int w) {
+    const int m = entry1->m;
+    const set *row1 = GRAPHROW(entry1->g, v, m);
+    const set *row2 = GRAPHROW(entry2->g, w, m);
+
+    int count1 = 0, count2 = 0;
+    for (int k = 0; k < m; k++) {
+        count1 += POPCOUNT(row1[k] & matched1[k]);
+        count2 += POPCOUNT(row2[k] & matched2[k]);
+    }
+    if (count1 != count2) return false;
+
+    for (int k = 0; k < m; k++) {
+        setword word = row1[k] & matched1[k];
+        while (word) {
+            int bit_index;
+            TAKEBIT(bit_index, word);
+            if (!ISELEMENT(row2, core[TIMESWORDSIZE(k) + bit_index])) return false;
+        }
+    }
+    return true;
+}
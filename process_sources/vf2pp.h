@@ -0,0 +1,48 @@
+#ifndef VF2PP_H
+#define VF2PP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nauty.h"
+#include "nauty_isomorphism.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "invariant_filter.h"
+#include "timer.h"
+#include "arena.h"
+
+// Most rounds of colour refinement before matching, refinement usually becomes stable much sooner
+#define MATCH_REFINE_ROUNDS 16
+// Search checks time budget once per this many nodes
+#define MATCH_BUDGET_PERIOD 1024
+
+/* Graph prepared for direct matching, the part of VF2++ which does not depend on the other graph of pair.
+   Its arrays are allocated from arena of thread and stay there until the set is processed. */
+typedef struct {
+    graph *g;               // Copy of adjacency rows, NULL until first requested
+    int n;
+    int m;
+    uint64_t *colours;      // Refined colour of each vertex, equal colours of isomorphic graphs match each other
+    uint64_t hash;          // Hash of colour histogram and refinement rounds, differs for non-isomorphic graphs
+    int *order;             // Matching order of vertices
+    int *parent;            // Neighbour of order[d] which precedes it in order, -1 for first vertex of component
+    double time;            // Time spent on preparation
+} MatchEntry;
+
+typedef struct {
+    MatchEntry *entries;
+    int count;
+    Budget budget;
+    Instrumentation search; // Search statistics of pairs, summed
+} MatchCache;
+
+void init_match_cache(MatchCache*, const int, const Budget*);
+MatchEntry* get_match_entry(MatchCache*, const GraphFile*, const int);
+double match_graphs(MatchCache*, const GraphFile*, const int, const int, bool*, bool*);
+double match_cache_time(const MatchCache*);
+void match_cache_instrumentation(const MatchCache*, Instrumentation*);
+void free_match_cache(MatchCache*);
+
+#endif
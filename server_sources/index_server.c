@@ -0,0 +1,378 @@
+#include "index_server.h"
+
+// Clients with more unwritten responses are not read until they catch up
+#define MAX_PENDING_OUTPUT (1 << 20)
+#define READ_CHUNK 65536
+
+static volatile sig_atomic_t stop_requested = 0;
+
+void handle_stop_signal(int);
+void warm_start_file(IndexServer*, const char*, const Options*, long*);
+void accept_clients(IndexServer*);
+bool read_client(IndexServer*, Client*);
+bool write_client(Client*);
+void handle_line(IndexServer*, Client*, char*, size_t);
+void answer_query(IndexServer*, Client*, char*, size_t);
+void append_output(Client*, const char*, ...);
+void close_client(IndexServer*, const int);
+void set_nonblocking(const int);
+
+void init_index_server(IndexServer *server, const Options *options, const int max_n) {
+    memset(server, 0, sizeof(IndexServer));
+    server->listen_fd = -1;
+    server->engine = options->engine;
+    server->budget = options->budget;
+    const bool budgeted = options->budget.time > 0 || options->budget.nodes > 0;
+
+    // Traces has no hook to abort search, budget would be silently ignored
+    if (budgeted && options->engine == ENGINE_TRACES) {
+        fprintf(stderr, "Error: --budget_time and --budget_nodes cannot be combined with --engine traces\n");
+        exit(EXIT_FAILURE);
+    }
+    server->settings.budget = budgeted ? &(server->budget) : NULL;
+    server->settings.invariant = options->invariant == INVARIANT_AUTO ? INVARIANT_NONE : options->invariant;
+    server->settings.invar_level = options->invar_level;
+    server->settings.invar_arg = options->invar_arg;
+    server->max_n = max_n;
+    init_certificate_index(&(server->index));
+}
+
+/* Indexes all .g6 and .s6 files of directory and its subdirectories, e.g. isomorphic/ and non_isomorphic/ of dataset */
+void warm_start(IndexServer *server, const char *path, const Options *options) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "Error: Unable to open directory %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    long graphs = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+        char child[1024];
+        snprintf(child, sizeof(child), "%s%s%s", path, path[strlen(path) - 1] == '/' ? "" : "/", name);
+
+        struct stat st;
+        if (stat(child, &st) != 0) continue;
+        const size_t length = strlen(name);
+        if (S_ISDIR(st.st_mode)) {
+            warm_start(server, child, options);
+        } else if (S_ISREG(st.st_mode) && length > 3 &&
+                   (strcmp(name + length - 3, ".g6") == 0 || strcmp(name + length - 3, ".s6") == 0)) {
+            warm_start_file(server, child, options, &graphs);
+        }
+    }
+    closedir(dir);
+
+    if (graphs > 0)
+        printf("Warm start: %ld graphs from %s, %d classes indexed.\n", graphs, path, server->index.count);
+}
+
+void warm_start_file(IndexServer *server, const char *filename, const Options *options, long *graphs) {
+    GraphFile file;
+    open_graph_file(filename, &file);
+
+    // Cache is initialised without invariant selection, so it labels graphs with the same settings as queries
+    CanonicalCache cache;
+    init_canonical_cache(&cache, file.count, file.count > 0 ? graph_file_order(&file, 0) : 0, options);
+    canonicalise_all(&cache, &file, options);
+    for (int i = 0; i < file.count; i++) {
+        const CanonicalEntry *entry = get_canonical_entry(&cache, &file, i);
+        if (entry->censored) continue;
+        bool seen;
+        index_certificate(&(server->index), entry, &seen);
+        (*graphs)++;
+    }
+
+    free_canonical_cache(&cache);
+    close_graph_file(&file);
+}
+
+void open_index_server(IndexServer *server, const char *socket_path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path %s is too long\n", socket_path);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(address.sun_path, socket_path);
+
+    // Socket left by a server which did not exit cleanly is replaced, other files are not
+    struct stat st;
+    if (stat(socket_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Error: %s exists and is not a socket\n", socket_path);
+            exit(EXIT_FAILURE);
+        }
+        unlink(socket_path);
+    }
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 || bind(server->listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server->listen_fd, SOMAXCONN) != 0) {
+        perror("Error: Unable to listen on socket");
+        exit(EXIT_FAILURE);
+    }
+    set_nonblocking(server->listen_fd);
+    server->socket_path = socket_path;
+
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void handle_stop_signal(int signal_number) {
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+/* Single-threaded event loop over all clients. Queries are answered in order of arrival, so responses of one
+   client keep order of its requests. Runs until SIGINT, SIGTERM or #shutdown. */
+void run_index_server(IndexServer *server) {
+    struct pollfd *fds = NULL;
+    int fds_capacity = 0;
+
+    while (!server->stop && !stop_requested) {
+        if (fds_capacity < server->client_count + 1) {
+            fds_capacity = 2 * (server->client_count + 1);
+            fds = realloc(fds, fds_capacity * sizeof(struct pollfd));
+            if (!fds) {
+                fprintf(stderr, "Error: Memory reallocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        fds[0].fd = server->listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < server->client_count; i++) {
+            const Client *client = &(server->clients)[i];
+            const size_t pending = client->output_length - client->output_offset;
+            fds[i + 1].fd = client->fd;
+            fds[i + 1].events = (client->closing || pending > MAX_PENDING_OUTPUT ? 0 : POLLIN) | (pending > 0 ? POLLOUT : 0);
+        }
+
+        const int client_count = server->client_count;
+        if (poll(fds, client_count + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Error: poll failed");
+            exit(EXIT_FAILURE);
+        }
+
+        // Clients are closed from the end, so indices of the remaining ones stay valid
+        for (int i = client_count - 1; i >= 0; i--) {
+            Client *client = &(server->clients)[i];
+            bool open = true;
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+                open = read_client(server, client);
+            if (open && client->output_length > client->output_offset)
+                open = write_client(client);
+            if (!open || (client->closing && client->output_length == client->output_offset))
+                close_client(server, i);
+        }
+        if (fds[0].revents & POLLIN)
+            accept_clients(server);
+    }
+
+    // Responses to requests before shutdown are still delivered, unless client stops reading
+    for (int i = server->client_count - 1; i >= 0; i--) {
+        Client *client = &(server->clients)[i];
+        const struct timeval timeout = {1, 0};
+        const int flags = fcntl(client->fd, F_GETFL);
+        fcntl(client->fd, F_SETFL, flags & ~O_NONBLOCK);
+        setsockopt(client->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        write_client(client);
+        close_client(server, i);
+    }
+    free(fds);
+}
+
+void accept_clients(IndexServer *server) {
+    while (true) {
+        const int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        set_nonblocking(fd);
+        if (server->client_count >= server->client_capacity) {
+            server->client_capacity = server->client_capacity ? 2 * server->client_capacity : 8;
+            server->clients = realloc(server->clients, server->client_capacity * sizeof(Client));
+            if (!server->clients) {
+                fprintf(stderr, "Error: Memory reallocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        Client client = {0};
+        client.fd = fd;
+        (server->clients)[server->client_count++] = client;
+    }
+}
+
+/* Reads available bytes and answers all complete lines as one batch. Returns false if connection failed. */
+bool read_client(IndexServer *server, Client *client) {
+    bool received = false;
+    while (true) {
+        if (client->input_capacity - client->input_length < READ_CHUNK) {
+            client->input_capacity = client->input_length + 2 * READ_CHUNK;
+            client->input = realloc(client->input, client->input_capacity);
+            if (!client->input) {
+                fprintf(stderr, "Error: Memory reallocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        const ssize_t count = read(client->fd, client->input + client->input_length, client->input_capacity - client->input_length - 1);
+        if (count > 0) {
+            client->input_length += count;
+            received = true;
+            continue;
+        }
+        if (count == 0) client->closing = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+        break;
+    }
+    if (!received && !client->closing) return true;
+
+    const double start = monotonic_time();
+    size_t pos = 0;
+    while (pos < client->input_length) {
+        char *line = client->input + pos;
+        char *end = memchr(line, '\n', client->input_length - pos);
+        if (!end) break;
+        size_t length = end - line;
+        if (length > 0 && line[length - 1] == '\r') length--;
+        line[length] = '\0';
+        handle_line(server, client, line, length);
+        pos = end - client->input + 1;
+    }
+    // Last line of client which closed its side may lack newline
+    if (client->closing && pos < client->input_length) {
+        size_t length = client->input_length - pos;
+        client->input[client->input_length] = '\0';
+        if (client->input[client->input_length - 1] == '\r') client->input[--length + pos] = '\0';
+        handle_line(server, client, client->input + pos, length);
+        pos = client->input_length;
+    }
+    memmove(client->input, client->input + pos, client->input_length - pos);
+    client->input_length -= pos;
+    if (pos > 0)
+        record_latency(&(server->batch_latency), monotonic_time() - start);
+    return true;
+}
+
+/* Writes as much of pending output as socket accepts. Returns false if connection failed. */
+bool write_client(Client *client) {
+    while (client->output_offset < client->output_length) {
+        const ssize_t count = send(client->fd, client->output + client->output_offset,
+                                   client->output_length - client->output_offset, MSG_NOSIGNAL);
+        if (count < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        client->output_offset += count;
+    }
+    client->output_offset = client->output_length = 0;
+    return true;
+}
+
+void handle_line(IndexServer *server, Client *client, char *line, size_t length) {
+    if (length == 0) return;
+    if (line[0] != '#') {
+        answer_query(server, client, line, length);
+    } else if (strcmp(line, "#stats") == 0) {
+        char histogram[1024];
+        format_histogram(&(server->query_latency), histogram, sizeof(histogram));
+        append_output(client, "stats graphs=%ld classes=%d queries=%ld seen=%ld censored=%ld errors=%ld "
+                              "p50_us=%.1f p90_us=%.1f p99_us=%.1f max_us=%.1f\nhistogram %s\n",
+                      server->index.graphs, server->index.count, server->queries, server->seen, server->censored,
+                      server->errors, histogram_percentile(&(server->query_latency), 50) * 1e6,
+                      histogram_percentile(&(server->query_latency), 90) * 1e6,
+                      histogram_percentile(&(server->query_latency), 99) * 1e6, server->query_latency.max * 1e6,
+                      histogram);
+    } else if (strcmp(line, "#shutdown") == 0) {
+        server->stop = true;
+        append_output(client, "ok\n");
+    } else {
+        append_output(client, "error unknown command\n");
+    }
+}
+
+/* Canonicalises graph of line with the same settings as warm start and looks it up in index */
+void answer_query(IndexServer *server, Client *client, char *line, size_t length) {
+    const double start = monotonic_time();
+    server->queries++;
+
+    if (!valid_graph_line(line, length, server->max_n)) {
+        server->errors++;
+        append_output(client, "error invalid graph6 or sparse6 line\n");
+        record_latency(&(server->query_latency), monotonic_time() - start);
+        return;
+    }
+
+    CanonicalEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    compute_certificate(decode_graph_line(line), graphsize(line), server->engine, &(server->settings), &entry, NULL);
+    if (entry.censored) {
+        server->censored++;
+        append_output(client, "censored\n");
+    } else {
+        bool seen;
+        const int id = index_certificate(&(server->index), &entry, &seen);
+        if (seen) server->seen++;
+        append_output(client, "%s %d\n", seen ? "seen" : "new", id);
+    }
+    free(entry.certificate);
+    record_latency(&(server->query_latency), monotonic_time() - start);
+}
+
+void append_output(Client *client, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    const int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (client->output_length + length + 1 > client->output_capacity) {
+        client->output_capacity = 2 * (client->output_length + length + 1);
+        client->output = realloc(client->output, client->output_capacity);
+        if (!client->output) {
+            fprintf(stderr, "Error: Memory reallocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    va_start(arguments, format);
+    vsnprintf(client->output + client->output_length, length + 1, format, arguments);
+    va_end(arguments);
+    client->output_length += length;
+}
+
+void close_client(IndexServer *server, const int i) {
+    Client *client = &(server->clients)[i];
+    close(client->fd);
+    free(client->input);
+    free(client->output);
+    (server->clients)[i] = (server->clients)[--server->client_count];
+}
+
+void set_nonblocking(const int fd) {
+    const int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void print_server_stats(const IndexServer *server, FILE *file) {
+    char histogram[1024];
+    fprintf(file, "Index: %ld graphs in %d classes. Queries: %ld (%ld seen, %ld censored, %ld invalid).\n",
+            server->index.graphs, server->index.count, server->queries, server->seen, server->censored, server->errors);
+    format_histogram(&(server->query_latency), histogram, sizeof(histogram));
+    fprintf(file, "Query latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us, histogram %s\n",
+            histogram_percentile(&(server->query_latency), 50) * 1e6, histogram_percentile(&(server->query_latency), 90) * 1e6,
+            histogram_percentile(&(server->query_latency), 99) * 1e6, server->query_latency.max * 1e6, histogram);
+    format_histogram(&(server->batch_latency), histogram, sizeof(histogram));
+    fprintf(file, "Batch latency: %ld batches, p50 %.1f us, p99 %.1f us, histogram %s\n", server->batch_latency.count,
+            histogram_percentile(&(server->batch_latency), 50) * 1e6,
+            histogram_percentile(&(server->batch_latency), 99) * 1e6, histogram);
+}
+
+void close_index_server(IndexServer *server) {
+    for (int i = server->client_count - 1; i >= 0; i--)
+        close_client(server, i);
+    free(server->clients);
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->socket_path);
+    }
+    free_certificate_index(&(server->index));
+}
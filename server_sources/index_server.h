@@ -0,0 +1,72 @@
+#ifndef INDEX_SERVER_H
+#define INDEX_SERVER_H
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "options.h"
+#include "graph_reader.h"
+#include "canonical_cache.h"
+#include "certificate_index.h"
+#include "classifier.h"
+#include "statistics.h"
+#include "timer.h"
+
+/* Protocol: clients send graph6 or sparse6 lines and receive one line per request, in order of requests.
+   Requests may be pipelined, all complete lines of one read form a batch, whose responses are written together.
+     <graph6|sparse6>   ->  "new <class>" | "seen <class>" | "censored" | "error <reason>"
+     #stats             ->  "stats ..." followed by "histogram <bound_us>:<count>,..."
+     #shutdown          ->  "ok", server stops after flushing responses */
+
+typedef struct {
+    int fd;
+    char *input;            // Received bytes which do not form a complete line yet
+    size_t input_length;
+    size_t input_capacity;
+    char *output;           // Responses not written yet, from output_offset
+    size_t output_length;
+    size_t output_offset;
+    size_t output_capacity;
+    bool closing;           // Client closed its side, connection is closed once output is written
+} Client;
+
+typedef struct {
+    int listen_fd;
+    const char *socket_path;
+    Client *clients;
+    int client_count;
+    int client_capacity;
+    CertificateIndex index;
+    Engine engine;
+    Budget budget;
+    LabellingSettings settings; // The same for warm start and queries, so their certificates are comparable
+    int max_n;                  // Larger graphs are rejected, dense form of a graph needs n^2 / 8 bytes
+    long queries;
+    long seen;
+    long censored;
+    long errors;
+    LatencyHistogram query_latency;     // Validation, canonicalisation and lookup of one graph
+    LatencyHistogram batch_latency;     // From receiving batch to queueing all its responses
+    bool stop;
+} IndexServer;
+
+void init_index_server(IndexServer*, const Options*, const int);
+void warm_start(IndexServer*, const char*, const Options*);
+void open_index_server(IndexServer*, const char*);
+void run_index_server(IndexServer*);
+void print_server_stats(const IndexServer*, FILE*);
+void close_index_server(IndexServer*);
+
+#endif
@@ -0,0 +1,119 @@
+#include <stdbool.h>
+#include <unistd.h>
+#include "options.h"
+#include "index_server.h"
+
+// Default limit of graph order accepted from clients
+#define DEFAULT_MAX_N 16384
+
+void process_arguments(const int, char**, Options*, const char**, int*);
+
+int main(const int argc, char *argv[]) {
+    Options options = {
+        .solvers = 0,
+        .engine = ENGINE_DENSE,
+        .threads = 1,
+        .warmup = 0,
+        .repetitions = 1,
+        .pin = false,
+        .prefetch = 0,
+        .relabel = 0,
+        .seed = 1,
+        .prefilter = false,
+        .invariant = INVARIANT_NONE,
+        .invar_level = 1,
+        .invar_arg = 0,
+        .instrument = false,
+        .budget = {0.0, 0},
+        .store = NULL,
+        .checkpoint = NULL,
+        .shard = NULL
+    };
+    const char *store_file = NULL;
+    int max_n = DEFAULT_MAX_N;
+    process_arguments(argc, argv, &options, &store_file, &max_n);
+
+    CertificateStore store;
+    if (store_file) {
+        open_certificate_store(store_file, &store);
+        options.store = &store;
+    }
+
+    // Warm start from directories given by --warm, in order of arguments
+    IndexServer server;
+    init_index_server(&server, &options, max_n);
+    const double start = monotonic_time();
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--warm") == 0 && i + 1 < argc)
+            warm_start(&server, argv[++i], &options);
+    }
+    if (server.index.graphs > 0)
+        printf("Warm start finished in %f s.\n", monotonic_time() - start);
+    if (options.store) {
+        printf("Certificate store: %ld certificates reused, %ld computed.\n", store.hits, store.misses);
+        close_certificate_store(&store);
+    }
+
+    open_index_server(&server, argv[1]);
+    printf("Listening on %s\n", argv[1]);
+    fflush(stdout);
+    run_index_server(&server);
+
+    print_server_stats(&server, stdout);
+    close_index_server(&server);
+    return EXIT_SUCCESS;
+}
+
+void process_arguments(const int argc, char **argv, Options *options, const char **store_file, int *max_n) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <socket_path> [--warm DIR]... [--engine dense|sparse|traces|auto] [--threads N]\n"
+                        "       [--store FILE] [--budget_time SECONDS] [--budget_nodes N] [--max_n N]\n"
+                        "       [--invariant none|cellquads|cellfano|distances|adjtriang] [--invarlev N] [--invararg N]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--warm") == 0 && i + 1 < argc) {
+            ++i;    // Directories are indexed after all options are known
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            options->engine = parse_engine(argv[++i]);
+            if (options->engine == ENGINE_VF2PP) {
+                fprintf(stderr, "Error: --engine vf2pp matches pairs of graphs, index needs canonical certificates\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // Threads only canonicalise warm start files, queries are answered by one thread
+            options->threads = atoi(argv[++i]);
+            if (options->threads <= 0)
+                options->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            *store_file = argv[++i];
+        } else if (strcmp(argv[i], "--budget_time") == 0 && i + 1 < argc) {
+            options->budget.time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--budget_nodes") == 0 && i + 1 < argc) {
+            options->budget.nodes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--max_n") == 0 && i + 1 < argc) {
+            *max_n = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--invariant") == 0 && i + 1 < argc) {
+            options->invariant = parse_invariant(argv[++i]);
+            if (options->invariant == INVARIANT_AUTO) {
+                fprintf(stderr, "Error: --invariant auto chooses invariant per set, index needs one for all graphs\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--invarlev") == 0 && i + 1 < argc) {
+            options->invar_level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--invararg") == 0 && i + 1 < argc) {
+            options->invar_arg = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+#ifndef USE_TLS
+    if (options->threads > 1) {
+        fprintf(stderr, "Error: --threads requires thread-safe nauty, configure with -DNAUTY_TLS=ON\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+}